@@ -0,0 +1,292 @@
+/*Copyright 2018 Cambricon*/
+// 异步 Compute 的临时 buffer 延迟释放. Compute 只负责下发任务, 不再
+// cnrtSyncQueue, 因此临时 buffer 不能在返回前 cnrtFree: 每次下发后在 queue
+// 上放置一个 notifier, 与该次的临时 buffer 一起挂入该 queue 的列表, 等
+// notifier 完成后再释放.
+//
+// 默认映射到 cnrt 的 notifier / cnrtFree; 定义 DEFERRED_RELEASE_CPU_BACKEND
+// 时改用 host 线程模拟的 queue, 无需 MLU 即可验证释放顺序, 见
+// deferred_release_test.cc.
+
+#ifndef TENSORFLOW_STREAM_EXECUTOR_MLU_MLU_API_OPS_DEFERRED_RELEASE_H_
+#define TENSORFLOW_STREAM_EXECUTOR_MLU_MLU_API_OPS_DEFERRED_RELEASE_H_
+
+#include <deque>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// 每个 queue 等待释放的批次上限, 超过后阻塞等待最早的一批完成
+#define MAX_PENDING_RELEASE 64
+
+#if DEFERRED_RELEASE_CPU_BACKEND
+
+#include <stdlib.h>
+
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
+namespace stream_executor {
+namespace mlu {
+namespace ops {
+
+// host 模拟的 queue: 单个工作线程按 FIFO 顺序执行任务, 与 cnrtQueue 一致
+struct HostQueue {
+  std::mutex mu;
+  std::condition_variable cv;
+  std::deque<std::function<void()> > tasks;
+  bool stop = false;
+  int running = 0;
+  std::thread worker;
+
+  HostQueue() { worker = std::thread([this] { Run(); }); }
+
+  ~HostQueue() {
+    {
+      std::lock_guard<std::mutex> lock(mu);
+      stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+  }
+
+  void Push(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mu);
+      tasks.push_back(std::move(task));
+    }
+    cv.notify_all();
+  }
+
+  // 等待已下发的任务全部执行完, 对应 cnrtSyncQueue
+  void Sync() {
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [this] { return tasks.empty() && running == 0; });
+  }
+
+  void Run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [this] { return stop || !tasks.empty(); });
+        if (tasks.empty()) return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        running = 1;
+      }
+      task();
+      {
+        std::lock_guard<std::mutex> lock(mu);
+        running = 0;
+      }
+      cv.notify_all();
+    }
+  }
+};
+
+// host 模拟的 notifier: queue 执行到该位置时置位
+struct HostNotifier {
+  std::mutex mu;
+  std::condition_variable cv;
+  bool done = true;
+};
+
+typedef HostQueue* ReleaseQueue;
+typedef HostNotifier* ReleaseNotifier;
+
+// 测试用: 置为 true 时创建 notifier 失败
+inline bool& releaseNotifierFails() {
+  static bool fails = false;
+  return fails;
+}
+
+// 测试用: 替换释放函数以检查释放时机
+inline std::function<void(void*)>& releaseFreeHook() {
+  static std::function<void(void*)> hook = [](void* ptr) { free(ptr); };
+  return hook;
+}
+
+inline bool releaseCreateNotifier(ReleaseNotifier* notifier) {
+  if (releaseNotifierFails()) return false;
+  *notifier = new HostNotifier();
+  return true;
+}
+
+inline void releaseDestroyNotifier(ReleaseNotifier notifier) { delete notifier; }
+
+inline bool releasePlaceNotifier(ReleaseNotifier notifier, ReleaseQueue queue) {
+  {
+    std::lock_guard<std::mutex> lock(notifier->mu);
+    notifier->done = false;
+  }
+  queue->Push([notifier] {
+    std::lock_guard<std::mutex> lock(notifier->mu);
+    notifier->done = true;
+    notifier->cv.notify_all();
+  });
+  return true;
+}
+
+inline bool releaseQueryNotifier(ReleaseNotifier notifier) {
+  std::lock_guard<std::mutex> lock(notifier->mu);
+  return notifier->done;
+}
+
+inline bool releaseWaitNotifier(ReleaseNotifier notifier) {
+  std::unique_lock<std::mutex> lock(notifier->mu);
+  notifier->cv.wait(lock, [notifier] { return notifier->done; });
+  return true;
+}
+
+inline bool releaseSyncQueue(ReleaseQueue queue) {
+  queue->Sync();
+  return true;
+}
+
+inline void releaseFree(void* ptr) { releaseFreeHook()(ptr); }
+
+#else  // DEFERRED_RELEASE_CPU_BACKEND
+
+#include "tensorflow/core/platform/mlu.h"
+
+namespace stream_executor {
+namespace mlu {
+namespace ops {
+
+typedef cnrtQueue_t ReleaseQueue;
+typedef cnrtNotifier_t ReleaseNotifier;
+
+inline bool releaseCreateNotifier(ReleaseNotifier* notifier) {
+  return cnrtCreateNotifier(notifier) == CNRT_RET_SUCCESS;
+}
+
+inline void releaseDestroyNotifier(ReleaseNotifier notifier) {
+  cnrtDestroyNotifier(&notifier);
+}
+
+inline bool releasePlaceNotifier(ReleaseNotifier notifier, ReleaseQueue queue) {
+  return cnrtPlaceNotifier(notifier, queue) == CNRT_RET_SUCCESS;
+}
+
+inline bool releaseQueryNotifier(ReleaseNotifier notifier) {
+  return cnrtQueryNotifier(notifier) == CNRT_RET_SUCCESS;
+}
+
+inline bool releaseWaitNotifier(ReleaseNotifier notifier) {
+  return cnrtWaitNotifier(notifier) == CNRT_RET_SUCCESS;
+}
+
+inline bool releaseSyncQueue(ReleaseQueue queue) {
+  return cnrtSyncQueue(queue) == CNRT_RET_SUCCESS;
+}
+
+inline void releaseFree(void* ptr) { cnrtFree(ptr); }
+
+#endif  // DEFERRED_RELEASE_CPU_BACKEND
+
+// 每个 queue 单独一个列表: 同一 queue 上的 notifier 按下发顺序完成, 遇到第
+// 一个未完成的即可停止, 但不同 queue 之间没有顺序. 等待 notifier 与释放都在
+// 锁外进行, 一个 queue 阻塞时不影响其他 queue 的 Compute.
+class DeferredRelease {
+ public:
+  explicit DeferredRelease(size_t max_pending = MAX_PENDING_RELEASE)
+      : max_pending_(max_pending) {}
+
+  // 挂入 buffers, 在 queue 执行到当前位置后释放. notifier 无法创建或放置时
+  // 退回同步: 等 queue 执行完再释放. 同步也失败时 buffers 可能仍在使用,
+  // 不释放并返回 false.
+  bool Push(ReleaseQueue queue, std::vector<void*> buffers) {
+    if (buffers.empty()) return true;
+    ReleaseNotifier notifier;
+    if (!releaseCreateNotifier(&notifier)) {
+      return ReleaseAfterSync(queue, &buffers);
+    }
+    if (!releasePlaceNotifier(notifier, queue)) {
+      releaseDestroyNotifier(notifier);
+      return ReleaseAfterSync(queue, &buffers);
+    }
+    std::deque<Pending> overflow;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      std::deque<Pending>& pending = pending_[queue];
+      pending.push_back({notifier, std::move(buffers)});
+      while (pending.size() > max_pending_) {
+        overflow.push_back(std::move(pending.front()));
+        pending.pop_front();
+      }
+    }
+    bool ok = true;
+    for (Pending& batch : overflow) {
+      if (releaseWaitNotifier(batch.notifier)) {
+        Release(&batch);
+      } else {
+        releaseDestroyNotifier(batch.notifier);
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+  // 释放所有 queue 上已完成的批次
+  void Reclaim() {
+    std::vector<Pending> done;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      for (auto it = pending_.begin(); it != pending_.end();) {
+        std::deque<Pending>& pending = it->second;
+        while (!pending.empty() &&
+               releaseQueryNotifier(pending.front().notifier)) {
+          done.push_back(std::move(pending.front()));
+          pending.pop_front();
+        }
+        it = pending.empty() ? pending_.erase(it) : std::next(it);
+      }
+    }
+    for (Pending& batch : done) {
+      Release(&batch);
+    }
+  }
+
+  // 尚未释放的批次数
+  size_t PendingCount() {
+    std::lock_guard<std::mutex> lock(mu_);
+    size_t count = 0;
+    for (auto& it : pending_) count += it.second.size();
+    return count;
+  }
+
+ private:
+  struct Pending {
+    ReleaseNotifier notifier;
+    std::vector<void*> buffers;
+  };
+
+  bool ReleaseAfterSync(ReleaseQueue queue, std::vector<void*>* buffers) {
+    if (!releaseSyncQueue(queue)) return false;
+    for (void* buffer : *buffers) {
+      releaseFree(buffer);
+    }
+    return true;
+  }
+
+  void Release(Pending* batch) {
+    for (void* buffer : batch->buffers) {
+      releaseFree(buffer);
+    }
+    releaseDestroyNotifier(batch->notifier);
+  }
+
+  const size_t max_pending_;
+  std::mutex mu_;
+  std::map<ReleaseQueue, std::deque<Pending> > pending_;
+};
+
+}  // namespace ops
+}  // namespace mlu
+}  // namespace stream_executor
+
+#endif  // TENSORFLOW_STREAM_EXECUTOR_MLU_MLU_API_OPS_DEFERRED_RELEASE_H_
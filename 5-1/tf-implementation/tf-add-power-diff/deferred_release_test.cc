@@ -0,0 +1,193 @@
+/*Copyright 2018 Cambricon*/
+// DeferredRelease 在 host 模拟 queue 上的测试, 不依赖 MLU 与 TensorFlow:
+//   1. 释放顺序: 每个 buffer 都在使用它的任务执行完之后才释放;
+//   2. 每个 queue 的上限: 超过 max_pending 后 Push 阻塞到最早一批完成;
+//   3. 多个 queue: 一个 queue 阻塞时, 其他 queue 已完成的批次照常释放;
+//   4. 阻塞的 Push 在锁外等待, 不影响其他 queue 的 Push 与 Reclaim;
+//   5. notifier 创建失败时退回同步释放.
+//
+// 编译运行:
+//   g++ -std=c++11 -O2 -DDEFERRED_RELEASE_CPU_BACKEND=1 -I . -o deferred_release_test
+//       deferred_release_test.cc -lpthread
+//   ./deferred_release_test
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <random>
+#include <set>
+
+#include "deferred_release.h"
+
+using stream_executor::mlu::ops::DeferredRelease;
+using stream_executor::mlu::ops::HostQueue;
+using stream_executor::mlu::ops::releaseFreeHook;
+using stream_executor::mlu::ops::releaseNotifierFails;
+
+// 每个 buffer 记录使用它的任务是否已执行完
+struct Buffer {
+  std::atomic<bool> used{false};
+};
+
+static std::mutex g_mu;
+static std::set<void*> g_live;
+static int g_early = 0;
+static int g_freed = 0;
+
+static void* NewBuffer() {
+  Buffer* buffer = new Buffer;
+  std::lock_guard<std::mutex> lock(g_mu);
+  g_live.insert(buffer);
+  return buffer;
+}
+
+// 模拟 kernel: 在 queue 上使用 buffer
+static void Use(HostQueue* queue, void* ptr, int us) {
+  queue->Push([ptr, us] {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+    static_cast<Buffer*>(ptr)->used = true;
+  });
+}
+
+// 阻塞 queue 直到 gate 打开
+static void Block(HostQueue* queue, std::shared_future<void> gate) {
+  queue->Push([gate] { gate.wait(); });
+}
+
+static int Check(const char* name, bool ok) {
+  printf("%-40s %s\n", name, ok ? "ok" : "FAIL");
+  return !ok;
+}
+
+int main() {
+  releaseFreeHook() = [](void* ptr) {
+    std::lock_guard<std::mutex> lock(g_mu);
+    Buffer* buffer = static_cast<Buffer*>(ptr);
+    g_early += !buffer->used;
+    g_live.erase(buffer);
+    g_freed++;
+    delete buffer;
+  };
+  int bad = 0;
+
+  {
+    HostQueue queue;
+    DeferredRelease release(8);
+    std::mt19937 g(1);
+    std::uniform_int_distribution<int> us(0, 200);
+    for (int i = 0; i < 500; i++) {
+      release.Reclaim();
+      void* a = NewBuffer();
+      void* b = NewBuffer();
+      Use(&queue, a, us(g));
+      Use(&queue, b, us(g));
+      release.Push(&queue, {a, b});
+    }
+    queue.Sync();
+    release.Reclaim();
+    bad += Check("free after use", g_early == 0 && g_live.empty() &&
+                                       release.PendingCount() == 0);
+  }
+
+  {
+    HostQueue queue;
+    DeferredRelease release(4);
+    std::promise<void> open;
+    Block(&queue, open.get_future().share());
+    for (int i = 0; i < 4; i++) {
+      void* a = NewBuffer();
+      Use(&queue, a, 0);
+      release.Push(&queue, {a});
+    }
+    void* a = NewBuffer();
+    Use(&queue, a, 0);
+    auto push = std::async(std::launch::async, [&] { return release.Push(&queue, {a}); });
+    bool blocked = push.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout;
+    open.set_value();
+    bool pushed = push.get();
+    queue.Sync();
+    release.Reclaim();
+    bad += Check("per-queue limit blocks Push", blocked && pushed && g_early == 0 &&
+                                                    g_live.empty());
+  }
+
+  {
+    HostQueue qa, qb;
+    DeferredRelease release;
+    std::promise<void> open;
+    Block(&qa, open.get_future().share());
+    void* a = NewBuffer();
+    Use(&qa, a, 0);
+    release.Push(&qa, {a});
+    void* b = NewBuffer();
+    Use(&qb, b, 0);
+    release.Push(&qb, {b});
+    qb.Sync();
+    release.Reclaim();
+    bool freed = false;
+    {
+      std::lock_guard<std::mutex> lock(g_mu);
+      freed = g_live.count(b) == 0 && g_live.count(a) == 1;
+    }
+    open.set_value();
+    qa.Sync();
+    release.Reclaim();
+    bad += Check("other queue reclaimed while one blocks", freed && g_early == 0 &&
+                                                               g_live.empty());
+  }
+
+  {
+    HostQueue qa, qb;
+    DeferredRelease release(1);
+    std::promise<void> open;
+    Block(&qa, open.get_future().share());
+    void* a1 = NewBuffer();
+    void* a2 = NewBuffer();
+    Use(&qa, a1, 0);
+    release.Push(&qa, {a1});
+    Use(&qa, a2, 0);
+    auto blocked = std::async(std::launch::async, [&] { return release.Push(&qa, {a2}); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto other = std::async(std::launch::async, [&] {
+      for (int i = 0; i < 10; i++) {
+        void* b = NewBuffer();
+        Use(&qb, b, 0);
+        release.Push(&qb, {b});
+        release.Reclaim();
+      }
+    });
+    bool free_running =
+        other.wait_for(std::chrono::seconds(2)) == std::future_status::ready;
+    open.set_value();
+    blocked.get();
+    other.get();
+    qa.Sync();
+    qb.Sync();
+    release.Reclaim();
+    bad += Check("blocked Push waits outside the lock", free_running && g_early == 0 &&
+                                                            g_live.empty());
+  }
+
+  {
+    HostQueue queue;
+    DeferredRelease release;
+    releaseNotifierFails() = true;
+    void* a = NewBuffer();
+    Use(&queue, a, 20000);
+    bool ok = release.Push(&queue, {a});
+    bool freed = false;
+    {
+      std::lock_guard<std::mutex> lock(g_mu);
+      freed = g_live.empty();
+    }
+    releaseNotifierFails() = false;
+    bad += Check("notifier failure falls back to sync", ok && freed && g_early == 0 &&
+                                                            release.PendingCount() == 0);
+  }
+
+  printf("freed %d buffers, %d before use\n", g_freed, g_early);
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
@@ -4,6 +4,7 @@
 #include "tensorflow/stream_executor/mlu/mlu_api/lib_ops/mlu_lib_ops.h"
 #include "tensorflow/stream_executor/mlu/mlu_api/ops/mlu_ops.h"
 #include "tensorflow/stream_executor/mlu/mlu_api/tf_mlu_intf.h"
+#include "tensorflow/stream_executor/mlu/mlu_api/ops/deferred_release.h"
 
 #define INVALID_INDEX -1
 
@@ -11,6 +12,11 @@ namespace stream_executor {
 namespace mlu {
 namespace ops {
 
+static DeferredRelease* GetDeferredRelease() {
+  static DeferredRelease* release = new DeferredRelease;
+  return release;
+}
+
 
 struct OpIndex {
   int broadcast_1_index = INVALID_INDEX;
@@ -117,6 +123,8 @@ Status MLUPowerDifference::Compute(const std::vector<void *> &inputs,
   void* broadcast_2_addr;
 
   struct OpIndex* op_index = static_cast<struct OpIndex*>(extra_);
+  GetDeferredRelease()->Reclaim();
+  std::vector<void*> temp_buffers;
 
   if (op_index->broadcast_1_index != INVALID_INDEX) {
     MLUBaseOp* broadcast_op_ptr_1 = base_ops_.at(op_index->broadcast_1_index);
@@ -124,6 +132,7 @@ Status MLUPowerDifference::Compute(const std::vector<void *> &inputs,
     cnmlGetTensorSize_V2(intmd_tensors_.at(op_index->broadcast_1_index),
                         &broadcast_1_size);
     cnrtMalloc(&broadcast_1_addr, broadcast_1_size);
+    temp_buffers.push_back(broadcast_1_addr);
 
     lib::ComputeBroadcastOp(broadcast_op_ptr_1, queue, input1,
                       broadcast_1_addr);
@@ -137,6 +146,7 @@ Status MLUPowerDifference::Compute(const std::vector<void *> &inputs,
     cnmlGetTensorSize_V2(intmd_tensors_.at(op_index->broadcast_2_index),
                         &broadcast_2_size);
     cnrtMalloc(&broadcast_2_addr, broadcast_2_size);
+    temp_buffers.push_back(broadcast_2_addr);
 
     lib::ComputeBroadcastOp(broadcast_op_ptr_2, queue, input2,
                       broadcast_2_addr);
@@ -146,15 +156,15 @@ Status MLUPowerDifference::Compute(const std::vector<void *> &inputs,
 
   MLUBaseOp *power_difference_op = base_ops_.at(base_ops_.size() - 1);
   
-  TF_STATUS_CHECK(lib::ComputePowerDifferenceOp(power_difference_op, queue, broadcast_1_addr, broadcast_2_addr, output));
-
-  TF_CNRT_CHECK(cnrtSyncQueue(queue));
-
-  if (op_index->broadcast_1_index != INVALID_INDEX) {
-    cnrtFree(broadcast_1_addr);
-  }
-  if (op_index->broadcast_2_index != INVALID_INDEX) {
-    cnrtFree(broadcast_2_addr);
+  Status status = lib::ComputePowerDifferenceOp(power_difference_op, queue, broadcast_1_addr, broadcast_2_addr, output);
+
+  // 临时 buffer 在 queue 执行到此处之后才释放. 下发失败时已下发的 broadcast
+  // 仍可能在使用它们, 同样挂入, 之后再返回错误
+  bool released = GetDeferredRelease()->Push(queue, std::move(temp_buffers));
+  TF_STATUS_CHECK(status);
+  if (!released) {
+    return tensorflow::errors::Internal(
+        "PowerDifference failed to release broadcast buffers");
   }
 
   return Status::OK();
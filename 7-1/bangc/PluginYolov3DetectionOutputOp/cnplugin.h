@@ -33,6 +33,7 @@
 #include <memory.h>
 #include <algorithm>
 #include <cmath>
+#include "yolov3_profile_layout.h"
 
 #ifndef CNPLUGIN_H_
 #define CNPLUGIN_H_
@@ -204,6 +205,20 @@ typedef cnmlPluginResizeAndColorCvtParam *cnmlPluginResizeAndColorCvtParam_t;
 /* =============================================== */
 /* cnmlPluginYolov3DetectionOutout operation start */
 /* =============================================== */
+/*! Layout of the MLU output of PluginYolov3DetectionOutputOp. */
+typedef enum {
+  CNML_YOLOV3_OUTPUT_SLAB = 0,     /*!< 7 numbers per box, see cnmlCreatePluginYolov3DetectionOutputOp */
+  CNML_YOLOV3_OUTPUT_COMPACT = 1,  /*!< 6 numbers per box, see yolov3_detections.h */
+} cnmlYolov3OutputFormat_t;
+
+/*! Suppression used by the NMS of PluginYolov3DetectionOutputOp. */
+typedef enum {
+  CNML_YOLOV3_NMS_HARD = 0,           /*!< drop boxes with IoU >= nms_thresh */
+  CNML_YOLOV3_NMS_SOFT_LINEAR = 1,    /*!< score *= 1 - IoU when IoU > nms_thresh */
+  CNML_YOLOV3_NMS_SOFT_GAUSSIAN = 2,  /*!< score *= exp(-IoU^2 / sigma) */
+  CNML_YOLOV3_NMS_DIOU = 3,           /*!< drop boxes with IoU - d^2 / c^2 >= nms_thresh */
+} cnmlYolov3NmsMode_t;
+
 /*!
  *  @struct cnmlPluginYolov3DetectionOutputOpParam
  *  @brief A struct.
@@ -231,8 +246,20 @@ struct cnmlPluginYolov3DetectionOutputOpParam
     cnmlCoreVersion_t core_version;
     int *inputWs;
     int *inputHs;
+    int *anchorNums;
+    int *desc;
     float *biases;
-    vector<void*> cast_data;
+    void *const_data;
+    int cpuThreadNum;
+    int tempDstStride;
+    int outputBufferSize;
+    int outputFormat;
+    int sortOutput;
+    int runtimeThresholds;
+    int profile;
+    int nmsMode;
+    float nmsSigma;
+    int floatIou;
 };
 /*! ``cnmlPluginYolov3DetectionOutputOpParam_t`` is a pointer to a
     structure (cnmlPluginYolov3DetectionOutputOpParam) holding the description of a Yolov3DetectionOutput operation param.
@@ -246,6 +273,12 @@ typedef cnmlPluginYolov3DetectionOutputOpParam
  *  This function creates a PluginYolov3DetectionOutputOp param object with
  *  the pointer and parameters provided by user.
  *
+ *  The const tensors holding the head shapes and anchors are shared by all
+ *  params created with the same inputWs, inputHs, biases and core_version, and
+ *  destroyed together with the last of them. Creating a param for a model
+ *  that is already loaded therefore does not create or bind new tensors.
+ *  The function is thread-safe.
+ *
  *  **Supports MLU220/MLU270**
  *
  *  @param[out] param
@@ -261,7 +294,10 @@ typedef cnmlPluginYolov3DetectionOutputOpParam
  *           No default value, a valid classNum must be in the range of [1, 4096].
  *  @param[in] maskGroupNum
  *    Input. The number of anchors used by every input tensors.
- *           No default value, a valid maskGroupNum must be in the range of [1, inf].
+ *           No default value, a valid maskGroupNum must be in the range of [1, inf],
+ *           and 2 x inputNum x maskGroupNum must not exceed 64.
+ *           Heads with different numbers of anchors are set up afterwards with
+ *           cnmlSetPluginYolov3DetectionOutputOpAnchors().
  *  @param[in] maxBoxNum
  *    Input. The largest possible number of output boxes.
  *           Default value is 1024, a valid maxBoxNum must be in the range of [1, inf].
@@ -306,7 +342,8 @@ typedef cnmlPluginYolov3DetectionOutputOpParam
  *  @retval CNML_STATUS_SUCCESS
  *    The object was set successfully.
  *  @retval CNML_STATUS_INVALIDPARAM
- *    The inputH/Ws ptr is nullptr or input param is invalid.
+ *    The inputH/Ws ptr is nullptr or input param is invalid. *param is set
+ *    to nullptr then.
  */
 cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOpParam(
     cnmlPluginYolov3DetectionOutputOpParam_t *param,
@@ -324,6 +361,37 @@ cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOpParam(
     int *inputHs,
     float *biases);
 
+/*!
+ *  @brief A function.
+ *
+ *  This function sets a different number of anchors for every input tensor,
+ *  e.g. for YOLOv3-tiny (2 heads) or YOLOv4/v5 style models. It must be called
+ *  before cnmlCreatePluginYolov3DetectionOutputOp.
+ *
+ *  Input tensor i then has a shape of [batchNum, (5 + classNum) x anchorNums[i],
+ *  inputHs[i], inputWs[i]]. Shapes, anchor numbers and bias offsets of all
+ *  heads are passed to the kernel as one descriptor table.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  anchorNums
+ *    Input. Number of anchors of every input tensor, inputNum elements.
+ *  @param[in]  biases
+ *    Input. Anchors of every input tensor, 2 x sum(anchorNums) elements
+ *           ordered as in cnmlCreatePluginYolov3DetectionOutputOpParam().
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param or a pointer is nullptr, an anchor number is not positive or
+ *    2 x sum(anchorNums) exceeds 64.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpAnchors(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int *anchorNums,
+    float *biases);
+
 /*!
  *  @brief A function.
  *
@@ -351,6 +419,10 @@ cnmlStatus_t cnmlDestroyPluginYolov3DetectionOutputOpParam(
  *  This function creates PluginYolov3DetectionOutputOp with proper param,
  *  input, and output tensors.
  *
+ *  YOLOv3 with 80 classes at 416x416 or 608x608 (3 heads of net/32, net/16
+ *  and net/8 with 3 anchors each, in this order) runs a kernel compiled for
+ *  these shapes. Other configurations use the generic kernel.
+ *
  *  PluginYolov3DetectionOutputOp takes in feature maps and network
  *  parameters and computes valid bounding boxes based on two thresholds
  *  you have chosen.
@@ -441,7 +513,9 @@ cnmlStatus_t cnmlDestroyPluginYolov3DetectionOutputOpParam(
  *           [batchNum, 64 + 7 * numMaxBox, 1, 1](NCHW).
  *           Support only FLOAT16 dataType currently.
  *           The first two numbers of each batch store the number of
- *           detected boxes. The data for each box starts from the 65th number,
+ *           detected boxes. The third number is 1 if decoded candidates
+ *           overflowed the scratch buffer and some were dropped, see
+ *           cnmlSetPluginYolov3DetectionOutputOpBufferSize(). The data for each box starts from the 65th number,
  *           with an order of [batchId, classId, score, x1, y1, x2, y2], where
  *           (x1, y1) and (x2, y2) are the coordinates of top-left and bottom-
  *           -right points accordingly.
@@ -509,7 +583,9 @@ cnmlStatus_t cnmlComputePluginYolov3DetectionOutputOpForward(
  *  @param[in]  inputs
  *    Input. An array stores the address of all cpu input data
  *  @param[out]  outputs
- *    Output. An array stores the address of all cpu output data
+ *    Output. An array stores the address of all cpu output data. Only the
+ *           detections are computed, the buffer and profile outputs of the
+ *           MLU op have no CPU counterpart.
  *  @retval CNML_STATUS_SUCCESS
  *    The function ends normally
  *  @retval CNML_STATUS_INVALIDPARAM
@@ -521,10 +597,457 @@ cnmlStatus_t cnmlCpuComputePluginYolov3DetectionOutputOpForward(
     cnmlPluginYolov3DetectionOutputOpParam_t param,
     void *input[],
     void *output);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function sets the number of threads used by
+ *  cnmlCpuComputePluginYolov3DetectionOutputOpForward.
+ *
+ *  When batchNum is not smaller than the thread number, batches are processed
+ *  in parallel. Otherwise batches are processed one by one and the NMS of
+ *  different classes runs in parallel. Either way every batch writes only its
+ *  own output region and the result does not depend on the thread number.
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  threadNum
+ *    Input. Number of CPU threads. 0 means all hardware threads.
+ *           Default value is 1.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr or threadNum is negative.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpCpuThreadNum(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int threadNum);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function sets the scratch sizes used by the MLU kernel. It must be
+ *  called before cnmlCreatePluginYolov3DetectionOutputOp.
+ *
+ *  Every core keeps at most tempDstStride boxes that pass confidence_thresh,
+ *  and the cores of a cluster keep at most as many NMS results as they have
+ *  candidates together. The scratch is placed in SRAM when it fits and in the
+ *  buffer tensor otherwise, which then needs at least
+ *  (classNum + 5 + 7 x min(taskDim, 4)) x tempDstStride x taskDim numbers.
+ *  Boxes beyond the limits are dropped and the overflow flag of the batch is
+ *  set, so low confidence thresholds need a larger tempDstStride.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  tempDstStride
+ *    Input. Max number of candidate boxes per core, must be 64-aligned
+ *           and at least 128.
+ *           Default value is 2048.
+ *  @param[in]  outputBufferSize
+ *    Input. Number of NMS results reserved in NRAM.
+ *           Default value is 256.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr or a size is not positive or not aligned.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpBufferSize(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int tempDstStride,
+    int outputBufferSize);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function selects the layout of the MLU output. It must be called
+ *  before cnmlCreatePluginYolov3DetectionOutputOp.
+ *
+ *  With CNML_YOLOV3_OUTPUT_COMPACT every batch still starts at
+ *  batchId x (64 + 7 x maxBoxNum) with the same header, but boxes are packed
+ *  as 6 numbers [classId(int16), score, x1, y1, x2, y2] and the 4th header
+ *  number holds maxBoxNum as int16. Only 64 + 6 x count numbers of a batch
+ *  need to be copied back, use yolov3::view in yolov3_detections.h to
+ *  read them. cnmlCpuComputePluginYolov3DetectionOutputOpForward writes the
+ *  same layout in float: the classId, maxBoxNum and the box numbers are all
+ *  floats at the same positions, so yolov3::view does not apply to it.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  format
+ *    Input. Output layout. Default value is CNML_YOLOV3_OUTPUT_SLAB.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr or format is invalid.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpOutputFormat(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    cnmlYolov3OutputFormat_t format);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function enables a final global sort of each image. The boxes of an
+ *  image are then written in descending score order across classes, and when
+ *  more than maxBoxNum boxes survive NMS the ones with the highest scores are
+ *  kept on both MLU and CPU. By default boxes are written in class order, and
+ *  the CPU forward keeps the first maxBoxNum in that order. It must be called
+ *  before cnmlCreatePluginYolov3DetectionOutputOp.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  sortOutput
+ *    Input. Non-zero to sort the output by score. Default value is 0.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpSortOutput(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int sortOutput);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function makes the thresholds an input of the op instead of values
+ *  fixed at op creation, so a compiled op can be run with any thresholds.
+ *  It must be called before cnmlCreatePluginYolov3DetectionOutputOp.
+ *
+ *  The op then takes inputNum + 1 input tensors. The last one has a shape of
+ *  [1, 2, 1, 1] and holds [confidence_thresh, nms_thresh], FLOAT16 on MLU and
+ *  FLOAT32 for cnmlCpuComputePluginYolov3DetectionOutputOpForward. The
+ *  thresholds given to cnmlCreatePluginYolov3DetectionOutputOpParam are
+ *  ignored.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  runtimeThresholds
+ *    Input. Non-zero to read the thresholds from the extra input.
+ *           Default value is 0.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpRuntimeThresholds(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int runtimeThresholds);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function adds a third output with per-stage hardware timing. It
+ *  must be called before cnmlCreatePluginYolov3DetectionOutputOp.
+ *
+ *  The profile output is an INT32 tensor of shape [batchNum,
+ *  CNML_YOLOV3_PROFILE_CORE_NUM x CNML_YOLOV3_PROFILE_RECORD_SIZE, 1, 1].
+ *  Every core working on a batch writes one record:
+ *    [0..3] decode, gather, NMS and store time in us,
+ *    [4] decoded boxes, [5] boxes left by NMS, [6] classes run through NMS,
+ *    [7] number of valid records of the batch (only read from record 0).
+ *  Use yolov3_profile.h to summarize it. The profile output is written by
+ *  the MLU kernel only, cnmlCpuComputePluginYolov3DetectionOutputOpForward
+ *  produces the detections alone.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  profile
+ *    Input. Non-zero to add the profile output. Default value is 0.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpProfile(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int profile);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function selects how NMS treats boxes overlapping a kept box. It
+ *  must be called before cnmlCreatePluginYolov3DetectionOutputOp.
+ *
+ *  With Soft-NMS the overlapping boxes are not dropped, their scores are
+ *  decayed instead and the decayed scores are written to the output. Boxes
+ *  whose score falls below confidence_thresh are dropped. Since the
+ *  order of the scores changes while suppressing, Soft-NMS always runs the
+ *  per-class repeated-max NMS on MLU. DIoU-NMS additionally subtracts
+ *  d^2 / c^2 from the IoU, d being the distance of the box centers and c the
+ *  diagonal of their smallest enclosing box, so that neighbouring objects
+ *  with distinct centers survive lower nms_thresh values.
+ *  cnmlCpuComputePluginYolov3DetectionOutputOpForward implements the same
+ *  modes.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  mode
+ *    Input. Suppression mode. Default value is CNML_YOLOV3_NMS_HARD.
+ *  @param[in]  sigma
+ *    Input. Sigma of CNML_YOLOV3_NMS_SOFT_GAUSSIAN, ignored by the other
+ *           modes. Default value is 0.5.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr, mode is invalid or sigma is not positive.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpNmsMode(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    cnmlYolov3NmsMode_t mode,
+    float sigma);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function selects the precision of the IoU computed in NMS.
+ *
+ *  The MLU kernel runs in half. By default NMS computes box areas,
+ *  intersections and unions in half on normalized coordinates, where the
+ *  10-bit mantissa leaves small boxes with a large relative error, so that
+ *  boxes near nms_thresh may be kept or suppressed differently from
+ *  cnmlCpuComputePluginYolov3DetectionOutputOpForward. With floatIou set,
+ *  coordinates stay in half but NMS converts them to float on chip and
+ *  accumulates areas, intersections and unions in float, with box sizes
+ *  x2 - x1 + 1 / netw and y2 - y1 + 1 / neth as the CPU reference does.
+ *  This costs extra on-chip computation and reduces the number of boxes one
+ *  NMS pass can hold.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  param
+ *    Input. A PluginYolov3DetectionOutput parameter struct pointer.
+ *  @param[in]  floatIou
+ *    Input. Non-zero to compute IoU in float. Default value is 0.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr.
+ */
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpFloatIou(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int floatIou);
 /* --------------------------------------------- */
 /* cnmlPluginYolov3DetectionOutout operation end */
 /* --------------------------------------------- */
 
+/* =============================================== */
+/* cnmlPluginNms operation start */
+/* =============================================== */
+/*! Largest maxOutputSize of PluginNmsOp, kept boxes are staged on chip. */
+#define CNML_NMS_MAX_OUTPUT_SIZE 2048
+
+/*!
+ *  @struct cnmlPluginNmsOpParam
+ *  @brief A struct.
+ *
+ *  cnmlPluginNmsOpParam is a structure describing the "param" parameter of
+ *  Nms operation.
+ *  cnmlCreatePluginNmsOpParam() is used to create an instance of
+ *  cnmlPluginNmsOpParam_t.
+ *  cnmlDestroyPluginNmsOpParam() is used to destroy an instance of
+ *  cnmlPluginNmsOpParam_t.
+ */
+struct cnmlPluginNmsOpParam
+{
+    int batchNum;
+    int boxNum;
+    int maxOutputSize;
+    float iouThreshold;
+    float scoreThreshold;
+    cnmlCoreVersion_t core_version;
+};
+/*! ``cnmlPluginNmsOpParam_t`` is a pointer to a structure
+    (cnmlPluginNmsOpParam) holding the description of a Nms operation param.
+*/
+typedef cnmlPluginNmsOpParam *cnmlPluginNmsOpParam_t;
+
+/*!
+ *  @brief A function.
+ *
+ *  This function creates a PluginNmsOp param object with a pointer and
+ *  "user params" provided.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[out] param
+ *    Output. The returning param descriptor.
+ *  @param[in] batchNum
+ *    Input. Number of images, every image is suppressed on its own.
+ *  @param[in] boxNum
+ *    Input. Number of input boxes of every image.
+ *  @param[in] maxOutputSize
+ *    Input. Largest number of kept boxes of every image, in the range of
+ *           [1, CNML_NMS_MAX_OUTPUT_SIZE].
+ *  @param[in] iouThreshold
+ *    Input. Boxes overlapping a kept box with IoU > iouThreshold are dropped,
+ *           as in NonMaxSuppressionV3; with 0 only overlapping boxes are.
+ *  @param[in] scoreThreshold
+ *    Input. Only boxes with score > scoreThreshold are kept.
+ *  @param[in] core_version
+ *    Input. Supported core version, MLU220 or MLU270.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The object was set successfully.
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is nullptr or a size is out of range.
+ */
+cnmlStatus_t cnmlCreatePluginNmsOpParam(
+    cnmlPluginNmsOpParam_t *param,
+    int batchNum,
+    int boxNum,
+    int maxOutputSize,
+    float iouThreshold,
+    float scoreThreshold,
+    cnmlCoreVersion_t core_version);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function frees the PluginNmsOpParam struct, pointed by the pointer
+ *  provided by user.
+ *
+ *  @param[in]  param
+ *    Input. A pointer to the address of the struct of computation parameters
+ *    for PluginNms operator.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param is a null pointer.
+ */
+cnmlStatus_t cnmlDestroyPluginNmsOpParam(
+    cnmlPluginNmsOpParam_t *param);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function creates PluginNmsOp with proper param, input, and output
+ *  tensors.
+ *
+ *  PluginNmsOp runs the nms_detection kernel of PluginYolov3DetectionOutputOp
+ *  on plain boxes and scores, e.g. for the post-processing of SSD or EAST.
+ *  Every image is processed by one core when batchNum is not smaller than the
+ *  number of cores, otherwise by the 4 cores of a cluster together.
+ *
+ *  **Formula:**
+ *
+ *    Boxes are selected greedily in descending score order among boxes with
+ *    score > scoreThreshold. A box is dropped if its IoU with an already
+ *    selected box is >= iouThreshold. At most maxOutputSize boxes are kept.
+ *    The order among boxes of equal score is unspecified.
+ *
+ *    Boxes are given by two corners, [y1, x1, y2, x2] as in TensorFlow or
+ *    [x1, y1, x2, y2], with y1 <= y2 and x1 <= x2. Coordinates are copied to
+ *    the output in their input order.
+ *
+ *  **DataType:**
+ *
+ *    Support only half(float16) type for boxes, scores and detections.
+ *
+ *  @param[out]  op
+ *    Output. A pointer to the base operator address.
+ *  @param[in]  param
+ *    Input. A PluginNms parameter struct pointer.
+ *  @param[in]  nms_input_tensors
+ *    Input. Two cnmlTensors:
+ *           [0] boxes, batchNum x boxNum x 4 numbers.
+ *           [1] scores, batchNum x boxNum numbers.
+ *  @param[in]  nms_output_tensors
+ *    Input. Three cnmlTensors:
+ *           [0] detections, batchNum x maxOutputSize x 5 numbers, [score,
+ *               4 coordinates] of every kept box in descending score order,
+ *               zero after the valid ones.
+ *           [1] valid_outputs, batchNum INT32 numbers, the number of kept
+ *               boxes of every image.
+ *           [2] buffer, batchNum x 5 x boxStride numbers of scratch, boxStride
+ *               being boxNum padded up to 64.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param or a tensor pointer is nullptr.
+ */
+cnmlStatus_t cnmlCreatePluginNmsOp(
+    cnmlBaseOp_t *op,
+    cnmlPluginNmsOpParam_t param,
+    cnmlTensor_t *nms_input_tensors,
+    cnmlTensor_t *nms_output_tensors);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function forwards PluginNmsOp on MLU.
+ *
+ *  **Supports MLU220/MLU270**
+ *
+ *  @param[in]  op
+ *    Input. A pointer to the base operator address.
+ *  @param[in]  inputs
+ *    Input. Addresses of boxes and scores.
+ *  @param[in]  num_inputs
+ *    Input. Number of input tensors, 2.
+ *  @param[out]  outputs
+ *    Output. Addresses of detections, valid_outputs and buffer.
+ *  @param[in]  num_outputs
+ *    Input. Number of output tensors, 3.
+ *  @param[in]  compute_forw_param
+ *    Input. A pointer to the struct address, which records runtime degree of
+ *    data parallelism and equipment affinity.
+ *  @param[in]  queue
+ *    Input. A computation queue pointer.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ */
+cnmlStatus_t cnmlComputePluginNmsOpForward(
+    cnmlBaseOp_t op,
+    void *inputs[],
+    int num_inputs,
+    void *outputs[],
+    int num_outputs,
+    cnrtInvokeFuncParam_t *compute_forw_param,
+    cnrtQueue_t queue);
+
+/*!
+ *  @brief A function.
+ *
+ *  This function forwards PluginNmsOp on CPU, with the same selection as the
+ *  MLU kernel computed in float.
+ *
+ *  @param[in]  param
+ *    Input. A PluginNms parameter struct pointer.
+ *  @param[in]  boxes
+ *    Input. batchNum x boxNum x 4 numbers.
+ *  @param[in]  scores
+ *    Input. batchNum x boxNum numbers.
+ *  @param[out]  detections
+ *    Output. batchNum x maxOutputSize x 5 numbers.
+ *  @param[out]  valid_outputs
+ *    Output. batchNum numbers.
+ *  @retval CNML_STATUS_SUCCESS
+ *    The function ends normally
+ *  @retval CNML_STATUS_INVALIDPARAM
+ *    Param or a pointer is nullptr.
+ */
+cnmlStatus_t cnmlCpuComputePluginNmsOpForward(
+    cnmlPluginNmsOpParam_t param,
+    const float *boxes,
+    const float *scores,
+    float *detections,
+    int *valid_outputs);
+/* ------------------------------- */
+/* cnmlPluginNms operation end */
+/* ------------------------------- */
+
 /* =============================================== */
 /* cnmlPluginOneHot operation start */
 /* =============================================== */
@@ -642,7 +1165,9 @@ cnmlStatus_t cnmlDestroyPluginOneHotOpParam(
  *           [batchNum, 64 + 7 * numMaxBox, 1, 1](NCHW).
  *           Support only FLOAT16 dataType currently.
  *           The first two numbers of each batch store the number of
- *           detected boxes. The data for each box starts from the 65th number,
+ *           detected boxes. The third number is 1 if decoded candidates
+ *           overflowed the scratch buffer and some were dropped, see
+ *           cnmlSetPluginYolov3DetectionOutputOpBufferSize(). The data for each box starts from the 65th number,
  *           with an order of [batchId, classId, score, x1, y1, x2, y2], where
  *           (x1, y1) and (x2, y2) are the coordinates of top-left and bottom-
  *           -right points accordingly.
@@ -0,0 +1,257 @@
+// 在 host 上模拟 nms_detection.h 与 plugin_yolov3_detection_helper.h 用到的 BANG 内建函数,
+// 用于 CPU 上的测试与基准.
+// 每个线程模拟一个核: coreId/taskId 等为 thread_local, __sync_cluster/__sync_all
+// 为所有线程共用的屏障 (emuBarrier().n 设为核数). 统计向量运算与 DMA 的次数和数据量,
+// 作为 MLU 上耗时的近似.
+#ifndef HOST_TEST_BANG_EMU_H_
+#define HOST_TEST_BANG_EMU_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define __mlu_func__ inline
+#define __mlu_entry__
+#define __nram__
+// SRAM 为一个 cluster 内所有核共享, 模拟为进程内唯一的静态变量
+#define __mlu_shared__ static
+
+typedef _Float16 half;
+
+// BANG C 中 min/max 为内建函数
+using std::max;
+using std::min;
+
+enum mluMemcpyDirection_t {
+  GDRAM2GDRAM, GDRAM2NRAM, NRAM2GDRAM, NRAM2NRAM,
+  SRAM2NRAM, NRAM2SRAM, GDRAM2SRAM, SRAM2GDRAM
+};
+
+inline thread_local int coreId = 0, coreDim = 1, clusterId = 0, clusterDim = 1;
+inline thread_local int taskId = 0, taskDim = 1;
+
+// 每个核的计数
+inline thread_local long g_vec_ops = 0, g_vec_elems = 0, g_dma = 0, g_dma_bytes = 0;
+inline thread_local long g_sync_cluster = 0, g_sync_all = 0;
+
+inline void emuResetCounters() {
+  g_vec_ops = g_vec_elems = g_dma = g_dma_bytes = 0;
+  g_sync_cluster = g_sync_all = 0;
+}
+
+inline void vcount(int n) {
+  g_vec_ops++;
+  g_vec_elems += n;
+}
+
+// 所有模拟核共用的屏障
+struct EmuBarrier {
+  std::mutex m;
+  std::condition_variable cv;
+  int n = 1, waiting = 0;
+  long gen = 0;
+  void wait() {
+    std::unique_lock<std::mutex> l(m);
+    long g = gen;
+    if (++waiting == n) {
+      waiting = 0;
+      gen++;
+      cv.notify_all();
+    } else {
+      cv.wait(l, [&] { return gen != g; });
+    }
+  }
+};
+
+inline EmuBarrier& emuBarrier() {
+  static EmuBarrier b;
+  return b;
+}
+
+inline void __sync_cluster() {
+  g_sync_cluster++;
+  emuBarrier().wait();
+}
+
+inline void __sync_all() {
+  g_sync_all++;
+  emuBarrier().wait();
+}
+
+// 以 cores 个线程运行 f(t), 每 4 个核为一个 cluster
+inline void emuLaunch(int cores, const std::function<void(int)>& f) {
+  emuBarrier().n = cores;
+  std::vector<std::thread> th;
+  for (int t = 0; t < cores; t++) {
+    th.emplace_back([&f, t, cores] {
+      coreDim = std::min(cores, 4);
+      coreId = t % coreDim;
+      clusterId = t / coreDim;
+      clusterDim = (cores + coreDim - 1) / coreDim;
+      taskId = t;
+      taskDim = cores;
+      emuResetCounters();
+      f(t);
+    });
+  }
+  for (auto& x : th) x.join();
+  emuBarrier().n = 1;
+}
+
+inline void __memcpy(void* d, const void* s, int size, mluMemcpyDirection_t) {
+  g_dma++;
+  g_dma_bytes += size;
+  memmove(d, s, size);
+}
+
+inline void __memcpy(void* d, const void* s, int size, mluMemcpyDirection_t,
+                     int dst_stride, int src_stride, int segnum) {
+  g_dma++;
+  for (int i = 0; i <= segnum; i++) {
+    g_dma_bytes += size;
+    memmove(static_cast<char*>(d) + static_cast<long>(i) * dst_stride,
+            static_cast<const char*>(s) + static_cast<long>(i) * src_stride, size);
+  }
+}
+
+template <typename T, typename V>
+inline void __nramset(T* p, int n, V v) {
+  vcount(n);
+  for (int i = 0; i < n; i++) p[i] = static_cast<T>(v);
+}
+
+#define EMU_BINARY(name, expr)                                   \
+  template <typename T>                                          \
+  inline void name(T* d, T* a, T* b, int n) {                    \
+    vcount(n);                                                   \
+    for (int i = 0; i < n; i++) d[i] = (expr);                   \
+  }
+EMU_BINARY(__bang_add, a[i] + b[i])
+EMU_BINARY(__bang_sub, a[i] - b[i])
+EMU_BINARY(__bang_mul, a[i] * b[i])
+EMU_BINARY(__bang_gt, static_cast<T>(a[i] > b[i] ? 1 : 0))
+#undef EMU_BINARY
+
+// cycle 运算: b 为长度 m 的向量, 沿 a 循环使用
+#define EMU_CYCLE(name, expr)                                    \
+  template <typename T>                                          \
+  inline void name(T* d, T* a, T* b, int n, int m) {             \
+    vcount(n);                                                   \
+    for (int i = 0; i < n; i++) d[i] = (expr);                   \
+  }
+EMU_CYCLE(__bang_cycle_add, a[i] + b[i % m])
+EMU_CYCLE(__bang_cycle_sub, a[i] - b[i % m])
+EMU_CYCLE(__bang_cycle_mul, a[i] * b[i % m])
+EMU_CYCLE(__bang_cycle_gt, static_cast<T>(a[i] > b[i % m] ? 1 : 0))
+#undef EMU_CYCLE
+
+template <typename T>
+inline void __bang_write_zero(T* d, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) d[i] = 0;
+}
+
+template <typename V>
+inline void __nramset_half(half* p, int n, V v) {
+  __nramset(p, n, v);
+}
+
+template <typename V>
+inline void __nramset_float(float* p, int n, V v) {
+  __nramset(p, n, v);
+}
+
+// a 为 h 行 w 列, d 为 w 行 h 列
+template <typename T>
+inline void __bang_transpose(T* d, T* a, int h, int w) {
+  vcount(h * w);
+  for (int i = 0; i < h; i++) {
+    for (int j = 0; j < w; j++) d[j * h + i] = a[i * w + j];
+  }
+}
+
+template <typename T, typename V>
+inline void __bang_mul_const(T* d, T* a, V c, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) d[i] = a[i] * static_cast<T>(c);
+}
+
+template <typename T>
+inline void __bang_active_relu(T* d, T* a, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) d[i] = a[i] > 0 ? a[i] : static_cast<T>(0);
+}
+
+template <typename T>
+inline void __bang_active_reciphp(T* d, T* a, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) d[i] = static_cast<T>(1) / a[i];
+}
+
+template <typename T>
+inline void __bang_active_exp(T* d, T* a, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) d[i] = static_cast<T>(exp(static_cast<float>(a[i])));
+}
+
+template <typename T>
+inline void __bang_active_sigmoid(T* d, T* a, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) {
+    d[i] = static_cast<T>(1.0f / (1.0f + expf(-static_cast<float>(a[i]))));
+  }
+}
+
+// 最大值存于 d[0], 序号存于 d[1] 的位置: half 为 uint16, float 为 uint32
+template <typename T>
+inline void __bang_max(T* d, T* a, int n) {
+  vcount(n);
+  int m = 0;
+  for (int i = 1; i < n; i++) {
+    if (a[i] > a[m]) m = i;
+  }
+  T v = a[m];
+  d[0] = v;
+  if (sizeof(T) == 2) {
+    reinterpret_cast<uint16_t*>(d)[1] = m;
+  } else {
+    reinterpret_cast<uint32_t*>(d)[1] = m;
+  }
+}
+
+template <typename T>
+inline void __bang_count(uint32_t* d, T* a, int n) {
+  vcount(n);
+  uint32_t c = 0;
+  for (int i = 0; i < n; i++) c += a[i] != 0;
+  d[0] = c;
+}
+
+template <typename T>
+inline void __bang_collect(T* d, T* a, T* m, int n) {
+  vcount(n);
+  int k = 0;
+  for (int i = 0; i < n; i++) {
+    if (m[i] != 0) d[k++] = a[i];
+  }
+}
+
+inline void __bang_half2float(float* d, half* a, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) d[i] = static_cast<float>(a[i]);
+}
+
+inline void __bang_float2half_rn(half* d, float* a, int n) {
+  vcount(n);
+  for (int i = 0; i < n; i++) d[i] = static_cast<half>(a[i]);
+}
+
+#endif  // HOST_TEST_BANG_EMU_H_
@@ -0,0 +1,22 @@
+// host 上编译 plugin_yolov3_detection_output_kernel_v2.mlu (及 416c80/608c80 特化版本)
+// 时代替 SDK 的 mlu.h: 在 bang_emu.h 之外补上 kernel 额外用到的内建函数,
+// 并把 cluster 内的 barrier.sync.local 汇编映射为 __sync_cluster.
+// 必须在所有系统头文件之后包含, __asm__/__volatile__ 宏只对 kernel 源文件生效.
+#ifndef HOST_TEST_MLU_H_
+#define HOST_TEST_MLU_H_
+
+#include "bang_emu.h"
+
+// half 按 2^scale 缩放后向下取整
+inline void __bang_half2int16_rd(int16_t* d, half* a, int n, int scale) {
+  vcount(n);
+  for (int i = 0; i < n; i++) {
+    d[i] = static_cast<int16_t>(floorf(ldexpf(static_cast<float>(a[i]), scale)));
+  }
+}
+
+// __asm__ __volatile__("barrier.sync.local ...") -> __sync_cluster()
+#define __asm__
+#define __volatile__(...) __sync_cluster()
+
+#endif  // HOST_TEST_MLU_H_
@@ -0,0 +1,151 @@
+// half 输入的 float_iou 模式测试:
+//   1. 精度: 416 网格上聚集的小框, 与 double 的贪心 NMS 参考实现比较保留框集合,
+//      float_iou 的差异应少于 half 计算 IoU;
+//   2. 空间: MODE 0 (输入不在 NRAM) 下 buffer 从 4KB 扫到 64KB, buffer 之后的保护区
+//      不得被写; float 临时空间放不下时应退回 half 计算, 结果与 float_iou = 0 相同.
+//
+// 用法: ./nms_float_iou_test
+
+#include <random>
+#include <vector>
+
+#include "bang_emu.h"
+#include "nms_detection.h"
+
+using std::vector;
+
+static int accuracyTest() {
+  const int net = 416;
+  const double pad = 1.0 / net;
+  const int n = 512;
+  int fail = 0;
+  for (int mode : {NMS_HARD, NMS_DIOU}) {
+    long diff_half = 0, diff_float = 0, total = 0;
+    for (int trial = 0; trial < 200; trial++) {
+      std::mt19937 g(trial);
+      std::uniform_real_distribution<float> u(0, 1), wh(2.0f / net, 24.0f / net);
+      vector<half> score(n), box(4 * n);
+      for (int i = 0; i < n; i++) {
+        float cx = 0.3f + 0.05f * u(g), cy = 0.3f + 0.05f * u(g), w = wh(g), h = wh(g);
+        box[i] = (half)(cx - w / 2);
+        box[n + i] = (half)(cy - h / 2);
+        box[2 * n + i] = (half)(cx + w / 2);
+        box[3 * n + i] = (half)(cy + h / 2);
+        score[i] = (half)(0.3f + 0.7f * u(g));
+      }
+
+      // 参考实现: 同一组 half 坐标上用 double 计算 IoU / DIoU 的贪心 NMS
+      vector<int> order(n);
+      for (int i = 0; i < n; i++) order[i] = i;
+      std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return (float)score[a] > (float)score[b];
+      });
+      auto c = [&](int k, int i) { return (double)(float)box[k * n + i]; };
+      vector<char> dead(n, 0);
+      vector<int> ref;
+      for (int a : order) {
+        if (dead[a]) continue;
+        ref.push_back(a);
+        for (int b : order) {
+          if (dead[b] || b == a) continue;
+          double iw = std::min(c(2, a), c(2, b)) - std::max(c(0, a), c(0, b));
+          double ih = std::min(c(3, a), c(3, b)) - std::max(c(1, a), c(1, b));
+          iw = iw > 0 ? iw + pad : 0;
+          ih = ih > 0 ? ih + pad : 0;
+          double inter = iw * ih;
+          double uni = (c(2, a) - c(0, a) + pad) * (c(3, a) - c(1, a) + pad) +
+                       (c(2, b) - c(0, b) + pad) * (c(3, b) - c(1, b) + pad) - inter;
+          double iou = inter / uni;
+          if (mode == NMS_DIOU) {
+            double dx = (c(0, a) + c(2, a) - c(0, b) - c(2, b)) / 2;
+            double dy = (c(1, a) + c(3, a) - c(1, b) - c(3, b)) / 2;
+            double ex = std::max(c(2, a), c(2, b)) - std::min(c(0, a), c(0, b));
+            double ey = std::max(c(3, a), c(3, b)) - std::min(c(1, a), c(1, b));
+            iou -= (dx * dx + dy * dy) / (ex * ex + ey * ey);
+          }
+          if (iou >= 0.45) dead[b] = 1;
+        }
+      }
+      std::sort(ref.begin(), ref.end());
+
+      auto run = [&](int float_iou) {
+        vector<half> s = score, out(5 * n, (half)-1), buf(200 * 1024), sram(64);
+        int cnt = 0;
+        nms_detection(cnt, out.data(), NRAM, s.data(), box.data(), NRAM, buf.data(),
+                      (int)(buf.size() * sizeof(half)), sram.data(), NMS_BLOCK, n, n, n, n,
+                      (half)0.45f, (half)0.0f, 1, (NmsMode)mode, (half)0.5f, float_iou,
+                      (float)pad, (float)pad);
+        vector<int> idx;
+        for (int k = 0; k < cnt; k++) {
+          for (int i = 0; i < n; i++) {
+            if (box[i] == out[n + k] && box[n + i] == out[2 * n + k] &&
+                box[2 * n + i] == out[3 * n + k] && box[3 * n + i] == out[4 * n + k]) {
+              idx.push_back(i);
+              break;
+            }
+          }
+        }
+        std::sort(idx.begin(), idx.end());
+        vector<int> d;
+        std::set_symmetric_difference(idx.begin(), idx.end(), ref.begin(), ref.end(),
+                                      std::back_inserter(d));
+        return (long)d.size();
+      };
+      diff_half += run(0);
+      diff_float += run(1);
+      total += ref.size();
+    }
+    bool ok = diff_float < diff_half;
+    fail += !ok;
+    printf("accuracy mode %d: ref kept %ld, keep-set differences: half %ld, float_iou %ld %s\n",
+           mode, total, diff_half, diff_float, ok ? "ok" : "FAIL");
+  }
+  return fail;
+}
+
+static int bufferTest() {
+  const int n = 700, keep = 100, guard = 64 * 1024;
+  std::mt19937 g(1);
+  std::uniform_real_distribution<float> u(0, 1), wh(0.01f, 0.2f);
+  vector<half> score(n), box(4 * n);
+  for (int i = 0; i < n; i++) {
+    float x = u(g), y = u(g);
+    box[i] = (half)x;
+    box[n + i] = (half)y;
+    box[2 * n + i] = (half)(x + wh(g));
+    box[3 * n + i] = (half)(y + wh(g));
+    score[i] = (half)u(g);
+  }
+  int runs = 0, overrun = 0, mismatch = 0;
+  for (int bytes = 4096; bytes <= 64 * 1024; bytes += 1024) {
+    for (Addr dst : {NRAM, GDRAM}) {
+      vector<half> out[2];
+      int cnt[2];
+      for (int float_iou = 0; float_iou < 2; float_iou++) {
+        vector<half> buf((bytes + guard) / sizeof(half), (half)7), s = score, sram(64);
+        out[float_iou].assign(5 * n, (half)0);
+        cnt[float_iou] = 0;
+        nms_detection(cnt[float_iou], out[float_iou].data(), dst, s.data(), box.data(), GDRAM,
+                      buf.data(), bytes, sram.data(), NMS_BLOCK, n, n, n, keep, (half)0.5f,
+                      (half)0.3f, 1, NMS_HARD, (half)0.5f, float_iou);
+        for (size_t i = bytes / sizeof(half); i < buf.size(); i++) {
+          if (buf[i] != (half)7) {
+            overrun++;
+            break;
+          }
+        }
+        runs++;
+      }
+      // 随机框之间的 IoU 离阈值较远, half 与 float 计算的结果应一致
+      mismatch += cnt[0] != cnt[1] || out[0] != out[1];
+    }
+  }
+  printf("buffer: %d runs, %d overruns, %d half/float_iou mismatches %s\n", runs, overrun,
+         mismatch, overrun + mismatch == 0 ? "ok" : "FAIL");
+  return overrun + mismatch;
+}
+
+int main() {
+  int fail = accuracyTest() + bufferTest();
+  return fail != 0;
+}
@@ -0,0 +1,87 @@
+// 多类别批量 nms_detection_multiclass 与逐类调用 nms_detection 的对比:
+// 统计向量运算次数与元素数, 并检查两者输出相同 (score 各不相同).
+// 约 70% 的类别没有超过阈值的框, 与 YOLOv3 80 类的实际分布接近.
+//
+// 用法: ./nms_multiclass_bench [超过阈值的比例=0.05]
+
+#include <random>
+#include <vector>
+
+#include "bang_emu.h"
+#include "nms_detection.h"
+
+using std::vector;
+
+template <typename T>
+static int run(const char* name, float frac) {
+  const int keep = 50, out_stride = 4096, class_start = 7;
+  const int buffer_size = 224 * 1024;
+  int bad = 0;
+  for (int n : {512, 1024, 3072}) {
+    for (int C : {20, 80}) {
+      std::mt19937 g(n + C);
+      std::uniform_real_distribution<float> u(0, 1);
+      vector<T> score(C * n), box(4 * n);
+      for (int i = 0; i < n; i++) {
+        float cx = u(g), cy = u(g), w = 0.02f + 0.2f * u(g), h = 0.02f + 0.2f * u(g);
+        box[i] = (T)(cx - w / 2);
+        box[n + i] = (T)(cy - h / 2);
+        box[2 * n + i] = (T)(cx + w / 2);
+        box[3 * n + i] = (T)(cy + h / 2);
+      }
+      for (int c = 0; c < C; c++) {
+        bool empty = u(g) < 0.7f;
+        // 超过阈值的框 score 取 [0.5, 1) 中互不相同的值, 步长大于 half 的精度
+        vector<int> cand;
+        for (int i = 0; i < n; i++) {
+          if (!empty && u(g) < frac) {
+            cand.push_back(i);
+          } else {
+            score[c * n + i] = (T)(0.2f * u(g));
+          }
+        }
+        std::shuffle(cand.begin(), cand.end(), g);
+        for (size_t j = 0; j < cand.size(); j++) {
+          score[c * n + cand[j]] = (T)(0.5f + 0.49f * (j + 1) / (cand.size() + 1));
+        }
+      }
+
+      vector<T> buf(buffer_size / sizeof(T)), sram(64);
+      vector<T> ref(6 * out_stride, (T)0), out(6 * out_stride, (T)0);
+      int ref_num = 0;
+      emuResetCounters();
+      for (int c = 0; c < C; c++) {
+        vector<T> s(score.begin() + c * n, score.begin() + (c + 1) * n), tmp(5 * n, (T)0);
+        int cnt = 0;
+        nms_detection(cnt, tmp.data(), NRAM, s.data(), box.data(), NRAM, buf.data(),
+                      buffer_size, sram.data(), NMS_BLOCK, n, n, n, keep, (T)0.45f,
+                      (T)0.25f, 1);
+        for (int k = 0; k < cnt; k++) {
+          ref[ref_num + k] = (T)(class_start + c);
+          for (int r = 0; r < 5; r++) ref[(r + 1) * out_stride + ref_num + k] = tmp[r * n + k];
+        }
+        ref_num += cnt;
+      }
+      long ops1 = g_vec_ops, elems1 = g_vec_elems;
+
+      emuResetCounters();
+      int out_num = 0;
+      bool ok = nms_detection_multiclass(out_num, out.data(), NRAM, score.data(), box.data(),
+                                         buf.data(), buffer_size, C, class_start, n, n,
+                                         out_stride, keep, (T)0.45f, (T)0.25f);
+      bool same = !ok || (out_num == ref_num && out == ref);
+      bad += !same;
+      printf("%s n %4d C %2d | per-class kept %4d: %6ld ops %9ld elems | multiclass(%s) "
+             "kept %4d: %6ld ops %9ld elems %s\n",
+             name, n, C, ref_num, ops1, elems1, ok ? "used" : "fallback", out_num, g_vec_ops,
+             g_vec_elems, same ? "ok" : "MISMATCH");
+    }
+  }
+  return bad;
+}
+
+int main(int argc, char** argv) {
+  float frac = argc > 1 ? atof(argv[1]) : 0.05f;
+  int bad = run<float>("float", frac) + run<half>("half ", frac);
+  return bad != 0;
+}
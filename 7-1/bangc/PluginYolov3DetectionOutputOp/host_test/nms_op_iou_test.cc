@@ -0,0 +1,66 @@
+// NMS 插件 kernel (plugin_nms_kernel.mlu) 的抑制条件测试: 与 NonMaxSuppressionV3 及
+// CPU forward (plugin_nms_op.cc 的 nmsCpuKeep) 相同, 只有 IoU > iouThreshold 的框被抑制.
+//   1. iouThreshold 为 0: 不相交的框全部保留, 只有重叠的框被抑制;
+//   2. IoU 恰好等于 iouThreshold 的框保留 (坐标取 half 可精确表示的值).
+// 1 个核 (BLOCK) 与 4 个核 (UNION1) 保留的框应与预期相同, 按 score 降序输出.
+//
+// 用法: ./nms_op_iou_test
+
+#include <vector>
+
+#include "mlu.h"
+
+using std::vector;
+
+void NmsOpKernel(half* boxes, half* scores, half* detections, int* valid_outputs,
+                 half* buffer, int batch_num, int box_num, int box_stride,
+                 int max_output_size, half iou_threshold, half score_threshold);
+
+struct Case {
+  const char* name;
+  float iouThreshold;
+  vector<float> boxes, scores;
+  vector<int> expect;  // 保留框的下标
+};
+
+int main() {
+  const Case cases[] = {
+      {"iou 0, disjoint boxes kept", 0.0f,
+       {0, 0, 1, 1, 2, 2, 3, 3, 0.5f, 0.5f, 1.5f, 1.5f, 4, 4, 5, 5},
+       {0.9f, 0.8f, 0.7f, 0.6f}, {0, 1, 3}},
+      // 第 2 个框在第 1 个框内, 面积为其一半, IoU = 0.5; 第 3 个框 IoU = 0.875
+      {"IoU == iouThreshold kept", 0.5f,
+       {0, 0, 2, 1, 0, 0, 1, 1, 0, 0, 2, 0.875f},
+       {0.9f, 0.8f, 0.7f}, {0, 1}},
+  };
+  int bad = 0;
+  for (const Case& c : cases) {
+    int boxNum = c.scores.size();
+    int expectNum = c.expect.size();
+    bool ok = true;
+    printf("%s:", c.name);
+    for (int cores : {1, 4}) {
+      vector<half> boxes(c.boxes.begin(), c.boxes.end());
+      vector<half> scores(c.scores.begin(), c.scores.end());
+      vector<half> det(boxNum * 5), buffer(5 * 64);
+      int valid = 0;
+      emuLaunch(cores, [&](int) {
+        NmsOpKernel(boxes.data(), scores.data(), det.data(), &valid, buffer.data(), 1, boxNum,
+                    64, boxNum, (half)c.iouThreshold, (half)0.0f);
+      });
+      bool same = valid == expectNum;
+      for (int k = 0; k < expectNum && same; k++) {
+        same = det[k * 5] == scores[c.expect[k]];
+        for (int i = 0; i < 4; i++) {
+          same = same && det[k * 5 + 1 + i] == boxes[c.expect[k] * 4 + i];
+        }
+      }
+      ok = ok && same;
+      printf(" %d cores kept %d%s,", cores, valid, same ? "" : " (wrong boxes)");
+    }
+    printf(" expect %d %s\n", expectNum, ok ? "ok" : "FAIL");
+    bad += !ok;
+  }
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
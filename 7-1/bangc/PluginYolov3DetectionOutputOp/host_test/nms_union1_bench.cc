@@ -0,0 +1,73 @@
+// UNION1 模式下 nms_detection 每保留一个框的开销: 4 个核各一个线程, 通过 SRAM
+// 交换各核的最大值记录. 统计每个核的 DMA 次数、__sync_cluster 次数、向量运算次数,
+// 以及每保留一个框的 host 耗时 (含线程屏障的真实等待), 并检查结果与 NMS_BLOCK 相同.
+//
+// 用法: ./nms_union1_bench [重复次数=3]
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "bang_emu.h"
+#include "nms_detection.h"
+
+using std::vector;
+
+int main(int argc, char** argv) {
+  int repeat = argc > 1 ? atoi(argv[1]) : 3;
+  const int keep = 200, cores = 4, buffer_size = 64 * 1024;
+  int bad = 0;
+  for (int n : {1000, 20000}) {
+    for (Addr src : {GDRAM, SRAM}) {
+      std::mt19937 g(n);
+      std::uniform_real_distribution<float> u(0, 1), wh(0.01f, 0.2f);
+      vector<float> score(n), box(4 * n);
+      for (int i = 0; i < n; i++) {
+        score[i] = floorf(u(g) * 50) / 50;
+        float x = u(g), y = u(g), w = wh(g), h = wh(g);
+        box[i] = x;
+        box[n + i] = y;
+        box[2 * n + i] = x + w;
+        box[3 * n + i] = y + h;
+      }
+      vector<float> ref(5 * keep, -1);
+      int ref_num = 0;
+      {
+        vector<float> s = score, buf(buffer_size / sizeof(float)), sram(64);
+        nms_detection(ref_num, ref.data(), GDRAM, s.data(), box.data(), GDRAM, buf.data(),
+                      buffer_size, sram.data(), NMS_BLOCK, n, n, keep, keep, 0.5f, 0.3f, 1);
+      }
+
+      double best_ms = 1e30;
+      vector<long> dma(cores), syncs(cores), vec(cores);
+      vector<int> out_num(cores);
+      vector<float> out;
+      for (int r = 0; r < repeat; r++) {
+        vector<float> s = score, sram(cores * NMS_RECORD_SIZE * 2);
+        out.assign(5 * keep, -1);
+        std::fill(out_num.begin(), out_num.end(), 0);
+        auto t0 = std::chrono::steady_clock::now();
+        emuLaunch(cores, [&](int t) {
+          vector<float> buf(buffer_size / sizeof(float));
+          nms_detection(out_num[t], out.data(), GDRAM, s.data(), box.data(), src, buf.data(),
+                        buffer_size, sram.data(), NMS_U1, n, n, keep, keep, 0.5f, 0.3f, 1);
+          dma[t] = g_dma;
+          syncs[t] = g_sync_cluster;
+          vec[t] = g_vec_ops;
+        });
+        auto t1 = std::chrono::steady_clock::now();
+        best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(t1 - t0).count());
+      }
+      bool same = out == ref;
+      for (int t = 0; t < cores; t++) same = same && out_num[t] == ref_num;
+      bad += !same;
+      int kept = std::max(ref_num, 1);
+      printf("n %5d src %s kept %d: per core %ld DMAs (%.1f/box), %ld barriers (%.1f/box), "
+             "%ld vector ops, %.1f ms (%.1f us/box) %s\n",
+             n, src == GDRAM ? "GDRAM" : "SRAM ", ref_num, dma[0], (double)dma[0] / kept,
+             syncs[0], (double)syncs[0] / kept, vec[0], best_ms, best_ms * 1000 / kept,
+             same ? "ok" : "MISMATCH");
+    }
+  }
+  return bad != 0;
+}
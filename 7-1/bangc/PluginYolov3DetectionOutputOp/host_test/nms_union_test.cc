@@ -0,0 +1,77 @@
+// UNION2/4/8 模式下 nms_detection 跨 cluster 求最大值的测试: 每个核一个线程,
+// 通过 GDRAM 上的交换区与 __sync_all 归约, 结果应与单核 NMS_BLOCK 逐字节相同.
+// score 量化到 50 档, 跨核的相等 score 很多, 检查取序号最小者的规则.
+// float 与 half 各测一遍, half 下交换记录中 int32 的序号须 4 字节对齐
+// (可加 -fsanitize=alignment 检查).
+// buffer 除 64KB 外还取一个小值, 使 UNION8 时每段的框数 max_seg_pad (128) 小于
+// 32 个核的交换记录 (256 个元素), 检查交换空间不与分段的临时空间重叠.
+//
+// 用法: ./nms_union_test
+
+#include <random>
+#include <vector>
+
+#include "bang_emu.h"
+#include "nms_detection.h"
+
+using std::vector;
+
+template <typename DT>
+static int unionTest(const char* type) {
+  const int keep = 400;
+  int bad = 0;
+  for (int buffer_size : {64 * 1024, sizeof(DT) == 4 ? 12 * 1024 : 6 * 1024})
+  for (int n : {100, 1000, 5003, 20000}) {
+    if (buffer_size < 64 * 1024 && n > 5003) {
+      continue;  // 小 buffer 下分段很多, 大输入只增加耗时
+    }
+    std::mt19937 g(n);
+    std::uniform_real_distribution<float> u(0, 1), wh(0.01f, 0.2f);
+    vector<DT> score(n), box(4 * n);
+    for (int i = 0; i < n; i++) {
+      score[i] = floorf(u(g) * 50) / 50;
+      float x = u(g), y = u(g), w = wh(g), h = wh(g);
+      box[i] = x;
+      box[n + i] = y;
+      box[2 * n + i] = x + w;
+      box[3 * n + i] = y + h;
+    }
+    for (int mode : {NMS_HARD, NMS_SOFT_LINEAR, NMS_SOFT_GAUSSIAN, NMS_DIOU}) {
+      vector<DT> ref(5 * keep, -1);
+      int ref_num = 0;
+      {
+        vector<DT> s = score, buf(buffer_size / sizeof(DT)), sram(64);
+        nms_detection(ref_num, ref.data(), GDRAM, s.data(), box.data(), GDRAM, buf.data(),
+                      buffer_size, sram.data(), NMS_BLOCK, n, n, keep, keep, (DT)0.5f, (DT)0.3f, 1,
+                      (NmsMode)mode);
+      }
+      for (SplitMode split : {NMS_U2, NMS_U4, NMS_U8}) {
+        int cores = split;
+        vector<DT> s = score, out(5 * keep, -1), exchange(2 * cores * NMS_RECORD_SIZE);
+        vector<int> out_num(cores, 0);
+        vector<long> syncs(cores);
+        emuLaunch(cores, [&](int t) {
+          vector<DT> buf(buffer_size / sizeof(DT));
+          nms_detection(out_num[t], out.data(), GDRAM, s.data(), box.data(), GDRAM, buf.data(),
+                        buffer_size, exchange.data(), split, n, n, keep, keep, (DT)0.5f, (DT)0.3f,
+                        1,
+                        (NmsMode)mode);
+          syncs[t] = g_sync_all;
+        });
+        bool same = out == ref;
+        for (int t = 0; t < cores; t++) same = same && out_num[t] == ref_num;
+        bad += !same;
+        printf("%s buffer %2dKB n %5d mode %d cores %d: kept %d (BLOCK %d), %ld __sync_all per "
+               "core %s\n", type, buffer_size / 1024, n, mode, cores, out_num[0], ref_num,
+               syncs[0], same ? "ok" : "MISMATCH");
+      }
+    }
+  }
+  return bad;
+}
+
+int main() {
+  int bad = unionTest<float>("float") + unionTest<half>("half");
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
@@ -0,0 +1,34 @@
+// 仅用于 host 测试: CNML 的最小替身, 说明见 cnrt.h.
+#ifndef HOST_TEST_SDK_STUB_CNML_H_
+#define HOST_TEST_SDK_STUB_CNML_H_
+
+#include "cnrt.h"
+
+typedef struct cnmlTensor *cnmlTensor_t;
+typedef struct cnmlCpuTensor *cnmlCpuTensor_t;
+typedef struct cnmlBaseOp *cnmlBaseOp_t;
+typedef struct cnmlQuantizedParam *cnmlQuantizedParam_t;
+
+enum cnmlStatus_t { CNML_STATUS_SUCCESS, CNML_STATUS_INVALIDPARAM };
+enum cnmlCoreVersion_t {
+  CNML_1H8, CNML_1H16, CNML_MLU100, CNML_MLU270, CNML_MLU220
+};
+enum cnmlTensorType_t { CNML_TENSOR, CNML_CONST };
+enum cnmlDataType_t {
+  CNML_DATA_INT32, CNML_DATA_FLOAT16, CNML_DATA_FLOAT32, CNML_DATA_INT16,
+  CNML_DATA_UINT8, CNML_DATA_INT8
+};
+enum cnmlDataOrder_t { CNML_NHWC, CNML_NCHW };
+enum cnmlDimension_t { CNML_DIM_N, CNML_DIM_H, CNML_DIM_W, CNML_DIM_C };
+
+HOST_TEST_STUB(cnmlCreateTensor)
+HOST_TEST_STUB(cnmlDestroyTensor)
+HOST_TEST_STUB(cnmlCreateCpuTensor)
+HOST_TEST_STUB(cnmlDestroyCpuTensor)
+HOST_TEST_STUB(cnmlBindConstData_V2)
+HOST_TEST_STUB(cnmlCreatePluginOp)
+HOST_TEST_STUB(cnmlComputePluginOpForward_V3)
+HOST_TEST_STUB(cnmlComputePluginOpForward_V4)
+HOST_TEST_STUB(cnmlPluginOpParamsBufferMarkTensorDimension)
+
+#endif  // HOST_TEST_SDK_STUB_CNML_H_
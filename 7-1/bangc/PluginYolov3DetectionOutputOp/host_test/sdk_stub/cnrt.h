@@ -0,0 +1,34 @@
+// 仅用于 host 测试: CNRT 的最小替身, 使插件的 .cc 不依赖 Neuware SDK 即可在 CPU 上编译.
+// 只声明 cnplugin.h 与插件源文件用到的类型; 函数一律实现为接受任意参数并返回成功的
+// 空操作, 只在创建 MLU 算子时被调用, CPU forward 不会用到.
+#ifndef HOST_TEST_SDK_STUB_CNRT_H_
+#define HOST_TEST_SDK_STUB_CNRT_H_
+
+#include <stdint.h>
+
+typedef struct cnrtQueue *cnrtQueue_t;
+typedef struct cnrtKernelParamsBuffer *cnrtKernelParamsBuffer_t;
+typedef struct cnrtQuantizedParam *cnrtQuantizedParam_t;
+typedef int cnrtRet_t;
+typedef int cnrtFunctionType_t;
+typedef struct { int x, y, z; } cnrtDim3_t;
+typedef struct { int data_parallelism; } cnrtInvokeFuncParam_t;
+
+enum cnrtDataType_t {
+  CNRT_FLOAT32, CNRT_FLOAT16, CNRT_INT32, CNRT_INT16, CNRT_UINT8, CNRT_INT8
+};
+
+#define HOST_TEST_STUB(name) \
+  template <typename... Args> inline int name(Args...) { return 0; }
+
+HOST_TEST_STUB(cnrtCastDataType)
+HOST_TEST_STUB(cnrtConvertFloatToHalf)
+HOST_TEST_STUB(cnrtGetKernelParamsBuffer)
+HOST_TEST_STUB(cnrtKernelParamsBufferAddParam)
+HOST_TEST_STUB(cnrtKernelParamsBufferMarkInput)
+HOST_TEST_STUB(cnrtKernelParamsBufferMarkOutput)
+HOST_TEST_STUB(cnrtKernelParamsBufferMarkStatic)
+HOST_TEST_STUB(cnrtDestroyKernelParamsBuffer)
+HOST_TEST_STUB(cnrtInvokeKernel_V2)
+
+#endif  // HOST_TEST_SDK_STUB_CNRT_H_
@@ -0,0 +1,88 @@
+// cnmlCpuComputePluginYolov3DetectionOutputOpForward 的线程扩展性测试: 608x608 输入
+// (19/38/76 三个 head, 每个 3 个 anchor), 80 类, batch 1/4/16, 线程数从 1 到 N.
+// batch 不少于线程数时按 batch 并行, 否则按类别并行 NMS. 每种线程数给出耗时、
+// 相对单线程的加速比, 并检查输出与单线程逐字节相同.
+// 插件源文件经 sdk_stub 中的 CNML/CNRT 替身在 host 上编译, 只调用公开接口.
+//
+// 用法: ./yolov3_cpu_scaling_bench [最大线程数=hardware_concurrency] [confidence_thresh=0.01]
+
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "cnplugin.h"
+#include "plugin_yolov3_detection_output_kernel_v1.h"
+
+// 只用 CPU forward, MLU kernel 不会被调用
+extern "C" {
+YOLOV3_KERNEL_DECL(yolov3Kernel_MLU270) {}
+YOLOV3_KERNEL_DECL(yolov3Kernel_MLU220) {}
+YOLOV3_KERNEL_DECL(yolov3Kernel_416c80_MLU270) {}
+YOLOV3_KERNEL_DECL(yolov3Kernel_416c80_MLU220) {}
+YOLOV3_KERNEL_DECL(yolov3Kernel_608c80_MLU270) {}
+YOLOV3_KERNEL_DECL(yolov3Kernel_608c80_MLU220) {}
+}
+
+using std::vector;
+
+int main(int argc, char** argv) {
+  int maxThreads = argc > 1 ? atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+  maxThreads = std::max(maxThreads, 1);
+  float conf = argc > 2 ? atof(argv[2]) : 0.01f;
+  vector<int> threadNums;
+  for (int t = 1; t < maxThreads; t *= 2) threadNums.push_back(t);
+  threadNums.push_back(maxThreads);
+
+  int inputWs[3] = {19, 38, 76}, inputHs[3] = {19, 38, 76};
+  float biases[18] = {116, 90, 156, 198, 373, 326, 30, 61, 62,
+                      45,  59, 119, 10,  13,  16,  30,  33, 23};
+  const int classNum = 80, anchorNum = 3, maxBoxNum = 1024;
+  int bad = 0;
+  // 线程数超过 CPU 核数时各线程分时运行, 加速比不反映扩展性
+  printf("608x608 c80, confidence_thresh %.3f, up to %d threads, %u cores\n", conf, maxThreads,
+         std::thread::hardware_concurrency());
+  for (int batchNum : {1, 4, 16}) {
+    cnmlPluginYolov3DetectionOutputOpParam_t param;
+    cnmlCreatePluginYolov3DetectionOutputOpParam(&param, batchNum, 3, classNum, anchorNum,
+                                                 maxBoxNum, 608, 608, conf, 0.45f,
+                                                 CNML_MLU270, inputWs, inputHs, biases);
+    // logit 偏负, 与真实网络一样只有少数框超过阈值
+    std::mt19937 g(batchNum);
+    std::normal_distribution<float> logit(-7, 2);
+    vector<vector<float>> inputs(3);
+    void* inputPtrs[3];
+    for (int i = 0; i < 3; i++) {
+      inputs[i].resize((size_t)batchNum * anchorNum * (classNum + 5) * inputWs[i] * inputHs[i]);
+      for (float& v : inputs[i]) v = logit(g);
+      inputPtrs[i] = inputs[i].data();
+    }
+    size_t outSize = (size_t)(maxBoxNum * 7 + 64) * batchNum;
+    vector<float> base;
+    double baseMs = 0;
+    for (int threadNum : threadNums) {
+      cnmlSetPluginYolov3DetectionOutputOpCpuThreadNum(param, threadNum);
+      vector<float> out(outSize);
+      double best = 1e30;
+      for (int r = 0; r < 3; r++) {
+        std::fill(out.begin(), out.end(), 0.0f);
+        auto t0 = std::chrono::steady_clock::now();
+        cnmlCpuComputePluginYolov3DetectionOutputOpForward(param, inputPtrs, out.data());
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+      }
+      if (base.empty()) {
+        base = out;
+        baseMs = best;
+      }
+      bool same = out == base;
+      bad += !same;
+      printf("batch %2d threads %2d (%s): %8.2f ms, speedup %5.2f, boxes %4d %s\n", batchNum,
+             threadNum, batchNum >= threadNum ? "batch" : "class", best, baseMs / best,
+             (int)out[0], same ? "identical" : "MISMATCH");
+    }
+    cnmlDestroyPluginYolov3DetectionOutputOpParam(&param);
+  }
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
@@ -0,0 +1,60 @@
+// YOLOv3 Stage 1 解码与过滤的测试: 按 kernel 的循环调用真实的 DecodeAllBBoxesFullW/PartW,
+// 与 CPU 参考逐位比较存下的框 (x, y, w, h, obj, 各类别 obj * prob), 覆盖 split H 与
+// split W (分块跨行) 两种路径、多个核的行切分以及多个 confidence_thresh.
+// 另用很小的 tempDstStride 检查溢出: 只保留前 tempDstStride 个框并置 overflow.
+// 同时打印只按 obj 过滤 (旧规则) 时会存下的框数, 作为对比.
+//
+// 用法: ./yolov3_decode_test
+
+#include "yolov3_stage1.h"
+
+using std::vector;
+
+static int check(const char* name, const Net& net, int splitNum) {
+  int bad = 0;
+  int entries = net.numClasses + 5;
+  for (float th : {0.005f, 0.05f, 0.25f, 0.5f, 0.9f}) {
+    half thresh = (half)th;
+    long kept = 0, keptObj = 0;
+    bool same = true;
+    for (int core = 0; core < splitNum; core++) {
+      vector<vector<half>> ref = referenceBoxes(net, thresh, core, splitNum);
+      keptObj += referenceBoxes(net, thresh, core, splitNum, true).size();
+      // 容量足够与只有参考结果一半两种情况
+      int fullStride = PAD_UP((int)ref.size() + 1, C_PAD_SIZE);
+      int smallStride = PAD_UP((int)ref.size() / 2, C_PAD_SIZE);
+      for (int stride : {fullStride, smallStride}) {
+        if (stride == 0) continue;
+        vector<half> dst((size_t)entries * stride, (half)-1);
+        int overflow = 0;
+        int count = stage1(net, thresh, core, splitNum, dst.data(), stride, overflow);
+        int expect = std::min((int)ref.size(), stride);
+        same = same && count == expect && overflow == ((int)ref.size() > stride);
+        for (int i = 0; i < std::min(count, expect); i++) {
+          for (int e = 0; e < entries; e++) {
+            same = same && dst[(size_t)e * stride + i] == ref[i][e];
+          }
+        }
+      }
+      kept += ref.size();
+    }
+    bad += !same;
+    printf("%s thresh %.3f: kept %6ld (obj filter %6ld) %s\n", name, th, kept, keptObj,
+           same ? "ok" : "MISMATCH");
+  }
+  return bad;
+}
+
+int main() {
+  int bad = 0;
+  // 416 输入 80 类, 每行都能放进 NRAM: split H
+  bad += check("416 c80 split H  ",
+               makeNet({{13, 13, 3}, {26, 26, 3}, {52, 52, 3}}, 80, 416, 1), 4);
+  // 一行放不下: split W, 分块跨行
+  bad += check("w 400 c80 split W", makeNet({{8, 400, 3}}, 80, 416, 2), 4);
+  bad += check("416 c600 split W ", makeNet({{13, 13, 3}, {26, 26, 3}}, 600, 416, 3), 4);
+  // 核数多于行数时部分核没有行
+  bad += check("w 400 c80 3 rows ", makeNet({{3, 400, 3}}, 80, 416, 4), 4);
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
@@ -0,0 +1,148 @@
+// 416c80/608c80 特化 kernel 与通用 kernel 的对比: 在 host 上以 4 个核 (一个 cluster)
+// 运行 plugin_yolov3_detection_output_kernel_v2.mlu 编出的 yolov3Kernel_MLU270 与
+// yolov3Kernel_416c80_MLU270 / yolov3Kernel_608c80_MLU270 (BANG 内建函数由 mlu.h /
+// bang_emu.h 模拟), 输入与参数和 cnmlCreatePluginYolov3DetectionOutputOp 传给 kernel 的相同.
+// 统计 host 耗时 (取最好一次)、profile 输出中 decode 阶段的耗时 (各核最大值)、
+// 向量运算与 DMA 次数, 并检查两个 kernel 的输出逐字节相同.
+// 特化只把 tiling 相关的标量计算变为常量, 向量运算与 DMA 应完全相同, 差别在标量部分.
+// 随机输入的框很少重叠, 阈值过低时 NMS 后的框数远超真实网络, 汇总阶段放不下的框
+// 会被丢弃并置 overflow, 因此默认阈值取 0.5 (每张图几百个框).
+//
+// 用法: ./yolov3_spec_kernel_bench [confidence_thresh=0.5] [重复次数=3]
+
+#include <chrono>
+
+#include "yolov3_stage1.h"
+#include "yolov3_profile.h"
+
+using std::vector;
+
+#define HOST_KERNEL_DECL(name)                                                        \
+  void name(half* predicts, void* input0, void* input1, void* input2, void* input3,   \
+            void* input4, void* input5, void* input6, half* thresh_gdram,             \
+            void* buffer_gdram, int* profile_gdram, int* desc_gdram,                  \
+            half* biases_gdram, int num_inputs, int num_classes, int num_batches,     \
+            int num_mask_groups, int num_max_boxes, int PAD_SIZE, int netw, int neth, \
+            half confidence_thresh, half nms_thresh, int temp_dst_stride,             \
+            int output_buffer_size, int output_format, int sort_output, int nms_mode, \
+            half nms_sigma, int float_iou)
+
+// 由 Makefile 分别从 kernel_v2.mlu 与 416c80/608c80.mlu 编译
+HOST_KERNEL_DECL(yolov3Kernel_MLU270);
+HOST_KERNEL_DECL(yolov3Kernel_416c80_MLU270);
+HOST_KERNEL_DECL(yolov3Kernel_608c80_MLU270);
+typedef HOST_KERNEL_DECL((*Kernel));
+
+const int kCores = 4;
+const int kMaxBoxNum = 1024;
+const int kTempDstStride = 2048;  // cnmlCreatePluginYolov3DetectionOutputOpParam 的默认值
+
+struct Result {
+  vector<half> predicts;
+  double ms, decodeUs;
+  long ops, elems, dma, bytes;
+};
+
+static Result run(Kernel kernel, const Net& net, int batchNum, half thresh, int reps) {
+  int classNum = net.numClasses;
+  int inputNum = net.heads.size();
+  // 与 yolov3FillDescriptor 相同: h, w, anchor 数, bias 偏移
+  vector<int> desc(64, 0);
+  for (int i = 0; i < inputNum; i++) {
+    desc[i] = net.heads[i].h;
+    desc[16 + i] = net.heads[i].w;
+    desc[32 + i] = net.heads[i].anchorNum;
+    desc[48 + i] = net.biasOffset[i];
+  }
+  vector<half> biases(64, (half)0);
+  std::copy(net.biases.begin(), net.biases.end(), biases.begin());
+  // batch 份相同的输入
+  vector<vector<half>> inputs(inputNum);
+  void* inputPtrs[7] = {};
+  for (int i = 0; i < inputNum; i++) {
+    for (int b = 0; b < batchNum; b++) {
+      inputs[i].insert(inputs[i].end(), net.inputs[i].begin(), net.inputs[i].end());
+    }
+    inputPtrs[i] = inputs[i].data();
+  }
+  // cnplugin.h: (classNum + 5 + 7 x min(taskDim, 4)) x tempDstStride x taskDim
+  vector<half> buffer((size_t)(classNum + 5 + 7 * kCores) * kTempDstStride * kCores);
+  vector<int> profile((size_t)batchNum * CNML_YOLOV3_PROFILE_CORE_NUM *
+                      CNML_YOLOV3_PROFILE_RECORD_SIZE);
+
+  Result r;
+  r.predicts.resize((size_t)batchNum * (kMaxBoxNum * 7 + 64));
+  r.ms = r.decodeUs = 1e30;
+  long ops[kCores], elems[kCores], dma[kCores], bytes[kCores];
+  for (int rep = 0; rep < reps; rep++) {
+    std::fill(r.predicts.begin(), r.predicts.end(), (half)0);
+    auto t0 = std::chrono::steady_clock::now();
+    emuLaunch(kCores, [&](int t) {
+      kernel(r.predicts.data(), inputPtrs[0], inputPtrs[1], inputPtrs[2], inputPtrs[3],
+             inputPtrs[4], inputPtrs[5], inputPtrs[6], nullptr, buffer.data(), profile.data(),
+             desc.data(), biases.data(), inputNum, classNum, batchNum, net.heads[0].anchorNum,
+             kMaxBoxNum, 64, net.netw, net.neth, thresh, (half)0.45f, kTempDstStride, 256,
+             0, 0, 0, (half)0.5f, 0);
+      ops[t] = g_vec_ops;
+      elems[t] = g_vec_elems;
+      dma[t] = g_dma;
+      bytes[t] = g_dma_bytes;
+    });
+    auto t1 = std::chrono::steady_clock::now();
+    r.ms = std::min(r.ms, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    // 每个 batch 取各核 decode 的最大值, 再对 batch 求和
+    double decodeUs = 0;
+    for (int b = 0; b < batchNum; b++) {
+      int us = 0;
+      for (int c = 0; c < kCores; c++) {
+        const int* record = &profile[(b * CNML_YOLOV3_PROFILE_CORE_NUM + c) *
+                                     CNML_YOLOV3_PROFILE_RECORD_SIZE];
+        us = std::max(us, record[yolov3::PROFILE_DECODE]);
+      }
+      decodeUs += us;
+    }
+    r.decodeUs = std::min(r.decodeUs, decodeUs);
+  }
+  r.ops = r.elems = r.dma = r.bytes = 0;
+  for (int c = 0; c < kCores; c++) {
+    r.ops += ops[c];
+    r.elems += elems[c];
+    r.dma += dma[c];
+    r.bytes += bytes[c];
+  }
+  return r;
+}
+
+int main(int argc, char** argv) {
+  half thresh = (half)(argc > 1 ? atof(argv[1]) : 0.5);
+  int reps = argc > 2 ? atoi(argv[2]) : 3;
+  struct Case {
+    int netSize;
+    Kernel spec;
+    const char* name;
+  } cases[] = {{416, yolov3Kernel_416c80_MLU270, "416c80"},
+               {608, yolov3Kernel_608c80_MLU270, "608c80"}};
+  int bad = 0;
+  printf("%d cores, confidence_thresh %.3f, best of %d\n", kCores, (float)thresh, reps);
+  for (const Case& c : cases) {
+    int s = c.netSize;
+    Net net = makeNet({{s / 32, s / 32, 3}, {s / 16, s / 16, 3}, {s / 8, s / 8, 3}}, 80, s, s);
+    for (int batchNum : {1, 4}) {
+      Result generic = run(yolov3Kernel_MLU270, net, batchNum, thresh, reps);
+      Result spec = run(c.spec, net, batchNum, thresh, reps);
+      bool same = generic.predicts == spec.predicts;
+      bool sameWork = generic.ops == spec.ops && generic.elems == spec.elems &&
+                      generic.dma == spec.dma && generic.bytes == spec.bytes;
+      bad += !same || !sameWork;
+      printf("%s batch %d: boxes %4d, vector ops %7ld (%s), DMA %6ld (%s), output %s\n",
+             c.name, batchNum, (int)(float)generic.predicts[0], generic.ops,
+             generic.ops == spec.ops ? "same" : "DIFF", generic.dma,
+             generic.dma == spec.dma ? "same" : "DIFF", same ? "identical" : "MISMATCH");
+      printf("  generic %8.2f ms, decode %8.0f us\n", generic.ms, generic.decodeUs);
+      printf("  %-7s %8.2f ms, decode %8.0f us, speedup %.2f / decode %.2f\n", c.name,
+             spec.ms, spec.decodeUs, generic.ms / spec.ms, generic.decodeUs / spec.decodeUs);
+    }
+  }
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
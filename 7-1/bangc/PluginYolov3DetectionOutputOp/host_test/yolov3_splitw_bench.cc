@@ -0,0 +1,133 @@
+// split W 解码的两种循环对比 (一行放不下 NRAM 的 head, 单个核):
+//   逐行: 旧的做法, 每行每个 anchor 用标量循环重建 offset_w, 每行结尾一次 remain 调用;
+//   分块: kernel_v2 现在的做法 (yolov3_stage1.h), 把本核的行连成一列按 limit 分块.
+// 统计解码函数调用次数、DMA 次数/字节数、向量运算次数/元素数、标量写次数与 host 耗时,
+// 并检查两者存下的框相同 (顺序不同: 逐行为行优先, 分块为 anchor 优先, 按内容排序后比较).
+//
+// 用法: ./yolov3_splitw_bench [confidence_thresh=0.05]
+
+#include <chrono>
+
+#include "yolov3_stage1.h"
+
+using std::vector;
+
+struct Stat {
+  long calls, ops, elems, dma, bytes, scalar;
+  double ms;
+};
+
+// 分块之前 kernel_v2 中 split W 分支的循环, 只处理一个 head
+static int stage1PerRow(const Net& net, half thresh, int coreIdx, int splitNum, half* dst,
+                        int tempDstStride, long& calls, long& scalar) {
+  vector<half> nram(NRAM_BUFFER_SIZE / sizeof(half));
+  half* buffer = nram.data();
+  half conf_vector[128];
+  half biases[64];
+  std::copy(net.biases.begin(), net.biases.end(), biases);
+  __nramset_half(conf_vector, C_PAD_SIZE, thresh);
+  int num_classes = net.numClasses;
+  int num_entries = num_classes + 5;
+  int entryPad = PAD_UP(num_entries, C_PAD_SIZE);
+  int h = net.heads[0].h, w = net.heads[0].w, anchorNum = net.heads[0].anchorNum;
+  int headChannels = num_entries * anchorNum;
+  int hLoc, hNum;
+  coreRows(h, coreIdx, splitNum, hLoc, hNum);
+  half* input = const_cast<half*>(net.inputs[0].data());
+  int boxCount = 0, overflow = 0;
+  int limit = (NRAM_BUFFER_SIZE / sizeof(half) / 2 / (2 + entryPad) - 64);
+  int segNum = w / limit;
+  int remain = w % limit;
+  int dealNum = PAD_UP(limit, C_PAD_SIZE);
+  half* offset_w = buffer;
+  half* offset_h = buffer + dealNum;
+  half* src = offset_h + dealNum;
+  half* srcTrans = src + dealNum * entryPad;
+  for (int hIdx = hLoc; hIdx < hLoc + hNum; hIdx++) {
+    __nramset_half(offset_h, dealNum, hIdx);
+    for (int anchorIdx = 0; anchorIdx < anchorNum; anchorIdx++) {
+      for (int ii = 0; ii < dealNum; ii++) {
+        offset_w[ii] = ii;
+      }
+      scalar += dealNum;
+      int srcOffset = hIdx * w * headChannels + anchorIdx * num_entries;
+      calls++;
+      boxCount += DecodeAllBBoxesPartW(
+          dst + boxCount, src, srcTrans, input + srcOffset, conf_vector, biases, offset_w,
+          offset_h, 0, anchorIdx, h, w, num_entries, entryPad, limit, segNum, remain, dealNum,
+          1, num_classes, anchorNum, net.netw, net.neth, NRAM2SRAM, tempDstStride,
+          tempDstStride - boxCount, overflow);
+      if (remain > 0) {
+        srcOffset += segNum * limit * headChannels;
+        calls++;
+        boxCount += DecodeAllBBoxesPartW(
+            dst + boxCount, src, srcTrans, input + srcOffset, conf_vector, biases, offset_w,
+            offset_h, 0, anchorIdx, h, w, num_entries, entryPad, remain, 1, remain,
+            PAD_UP(remain, C_PAD_SIZE), 1, num_classes, anchorNum, net.netw, net.neth,
+            NRAM2SRAM, tempDstStride, tempDstStride - boxCount, overflow);
+      }
+    }
+  }
+  return boxCount;
+}
+
+// 存下的框按列取出并排序, 便于比较不同顺序的结果
+static vector<vector<half>> sortedBoxes(const vector<half>& dst, int count, int stride,
+                                        int entries) {
+  vector<vector<half>> boxes(count, vector<half>(entries));
+  for (int i = 0; i < count; i++) {
+    for (int e = 0; e < entries; e++) boxes[i][e] = dst[(size_t)e * stride + i];
+  }
+  std::sort(boxes.begin(), boxes.end(), [](const vector<half>& a, const vector<half>& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+                                        [](half x, half y) { return (float)x < (float)y; });
+  });
+  return boxes;
+}
+
+template <typename F>
+static Stat measure(F f) {
+  emuResetCounters();
+  long calls = 0, scalar = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  f(calls, scalar);
+  auto t1 = std::chrono::steady_clock::now();
+  return {calls, g_vec_ops, g_vec_elems, g_dma, g_dma_bytes, scalar,
+          std::chrono::duration<double, std::milli>(t1 - t0).count()};
+}
+
+int main(int argc, char** argv) {
+  half thresh = (half)(argc > 1 ? atof(argv[1]) : 0.05);
+  struct Case {
+    int classes, h, w;
+  };
+  // 80 类 w=380 (4 核时每核 48 行), 600 类的 52x52 与 104x104
+  int bad = 0;
+  for (Case c : {Case{80, 192, 380}, Case{600, 52, 52}, Case{600, 104, 104}}) {
+    Net net = makeNet({{c.h, c.w, 3}}, c.classes, 416, c.h + c.w);
+    int entries = c.classes + 5, splitNum = 4;
+    int stride = PAD_UP(c.h * c.w * 3 / splitNum + c.w * 3, C_PAD_SIZE);
+    vector<half> dst1((size_t)entries * stride), dst2((size_t)entries * stride);
+    int n1 = 0, n2 = 0, overflow = 0;
+    Stat a = measure([&](long& calls, long& scalar) {
+      n1 = stage1PerRow(net, thresh, 0, splitNum, dst1.data(), stride, calls, scalar);
+    });
+    Stat b = measure([&](long& calls, long& scalar) {
+      n2 = stage1(net, thresh, 0, splitNum, dst2.data(), stride, overflow);
+      int hLoc, hNum;
+      coreRows(c.h, 0, splitNum, hLoc, hNum);
+      int limit = NRAM_BUFFER_SIZE / sizeof(half) / 2 / (2 + PAD_UP(entries, C_PAD_SIZE)) - 64;
+      calls = 3 * ((hNum * c.w + limit - 1) / limit);
+      scalar = PAD_UP(limit, C_PAD_SIZE);  // ramp 只在每个 head 建一次
+    });
+    bool same = n1 == n2 && sortedBoxes(dst1, n1, stride, entries) ==
+                                sortedBoxes(dst2, n2, stride, entries);
+    bad += !same;
+    printf("c%3d %3dx%3d kept %5d | per row: %4ld calls %6ld dma %10ld B %7ld ops %10ld elems "
+           "%7ld scalar %7.1f ms | tiled: %4ld calls %6ld dma %10ld B %7ld ops %10ld elems "
+           "%7ld scalar %7.1f ms %s\n",
+           c.classes, c.h, c.w, n2, a.calls, a.dma, a.bytes, a.ops, a.elems, a.scalar, a.ms,
+           b.calls, b.dma, b.bytes, b.ops, b.elems, b.scalar, b.ms, same ? "ok" : "MISMATCH");
+  }
+  return bad != 0;
+}
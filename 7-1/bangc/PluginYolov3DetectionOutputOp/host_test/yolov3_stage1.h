@@ -0,0 +1,212 @@
+// plugin_yolov3_detection_output_kernel_v2.mlu 的 Stage 1 (解码与过滤) 在 host 上的复现:
+// 调用 plugin_yolov3_detection_helper.h 中真实的 DecodeAllBBoxesFullW/PartW,
+// 循环与切分 (split H / split W 分块) 照抄 kernel, 只模拟单个 batch 中的一个核.
+// 另有逐框计算的 CPU 参考, 运算顺序与 kernel 相同, 结果应逐位一致.
+#ifndef HOST_TEST_YOLOV3_STAGE1_H_
+#define HOST_TEST_YOLOV3_STAGE1_H_
+
+#include <random>
+#include <vector>
+
+#include "bang_emu.h"
+#define __BANG_ARCH__ 270
+#include "BANG_LOG.h"
+#include "plugin_yolov3_detection_helper.h"
+#undef T
+
+struct Head {
+  int h, w, anchorNum;
+};
+
+struct Net {
+  std::vector<Head> heads;
+  int numClasses, netw, neth;
+  std::vector<half> biases;              // 每个 anchor 两个数 (w, h)
+  std::vector<int> biasOffset;           // 每个 head 第一个 anchor 在 biases 中的位置
+  std::vector<std::vector<half>> inputs; // NHWC, C = anchorNum * (numClasses + 5)
+};
+
+// 随机生成输入: obj 与类别的 logit 偏负, 只有少数框的 obj * prob 较大
+inline Net makeNet(const std::vector<Head>& heads, int numClasses, int netSize, int seed) {
+  Net net;
+  net.heads = heads;
+  net.numClasses = numClasses;
+  net.netw = net.neth = netSize;
+  std::mt19937 g(seed);
+  std::normal_distribution<float> coord(0, 0.5f), obj(-3, 2), cls(-4, 2);
+  std::uniform_real_distribution<float> anchor(10, 300);
+  int entries = numClasses + 5;
+  for (const Head& hd : heads) {
+    net.biasOffset.push_back(net.biases.size());
+    for (int a = 0; a < hd.anchorNum; a++) {
+      net.biases.push_back((half)anchor(g));
+      net.biases.push_back((half)anchor(g));
+    }
+    std::vector<half> in((size_t)hd.h * hd.w * hd.anchorNum * entries);
+    for (size_t i = 0; i < in.size(); i++) {
+      int e = i % entries;
+      in[i] = (half)(e < 4 ? coord(g) : e == 4 ? obj(g) : cls(g));
+    }
+    net.inputs.push_back(in);
+  }
+  return net;
+}
+
+// 第 coreIdx 个核 (共 splitNum 个) 负责的行: [hLoc, hLoc + hNum)
+inline void coreRows(int h, int coreIdx, int splitNum, int& hLoc, int& hNum) {
+  int hSeg = h / splitNum;
+  int hRem = h % splitNum;
+  hNum = hSeg + (hRem > coreIdx);
+  hLoc = hSeg * coreIdx + std::min(hRem, coreIdx);
+}
+
+// kernel Stage 1 对第 coreIdx 个核的复现. dst 为 num_entries 行, 行距 tempDstStride,
+// 返回存下的框数, 超出 tempDstStride 时置 overflow.
+inline int stage1(const Net& net, half thresh, int coreIdx, int splitNum, half* dst,
+                  int tempDstStride, int& overflow) {
+  std::vector<half> nram(NRAM_BUFFER_SIZE / sizeof(half));
+  half* buffer = nram.data();
+  half conf_vector[128];
+  half biases[64];
+  std::copy(net.biases.begin(), net.biases.end(), biases);
+  __nramset_half(conf_vector, C_PAD_SIZE, thresh);
+  int num_classes = net.numClasses;
+  int num_entries = num_classes + 5;
+  int entryPad = PAD_UP(num_entries, C_PAD_SIZE);
+  int num_inputs = net.heads.size();
+  int netw = net.netw, neth = net.neth;
+  mluMemcpyDirection_t preprocessStore = NRAM2SRAM;
+  half* result_preprocess = dst;
+  int temp_dst_stride = tempDstStride;
+  int boxCount = 0;
+  overflow = 0;
+  for (int inputIdx = 0; inputIdx < num_inputs; inputIdx++) {
+    int h = net.heads[inputIdx].h;
+    int w = net.heads[inputIdx].w;
+    int hLoc, hNum;
+    coreRows(h, coreIdx, splitNum, hLoc, hNum);
+    int anchorNum = net.heads[inputIdx].anchorNum;
+    int headChannels = num_entries * anchorNum;
+    half* input = const_cast<half*>(net.inputs[inputIdx].data());
+    half* bias = biases + net.biasOffset[inputIdx];
+    int limit = (NRAM_BUFFER_SIZE / sizeof(half) / 2 / (2 + entryPad) - 64) / w;
+    if (limit > 0) {
+      //  Split H
+      int segNum = hNum / limit;
+      int remain = hNum % limit;
+      int dealNum = PAD_UP(limit * w, C_PAD_SIZE);
+      half* offset_w = buffer;
+      half* offset_h = buffer + dealNum;
+      half* src = offset_h + dealNum;
+      half* srcTrans = src + dealNum * entryPad;
+      for (int i = 0; i < w; i++) {
+        offset_w[i] = i;
+      }
+      __memcpy(offset_w + w, offset_w, w * sizeof(half), NRAM2NRAM, w * sizeof(half), 0,
+               limit - 1);
+      for (int anchorIdx = 0; anchorIdx < anchorNum; anchorIdx++) {
+        for (int i = 0; i < limit; i++) {
+          for (int j = 0; j < w; j++) {
+            offset_h[i * w + j] = i + hLoc;
+          }
+        }
+        int srcOffset = hLoc * w * headChannels + anchorIdx * num_entries;
+        boxCount += DecodeAllBBoxesFullW(
+            result_preprocess + boxCount, src, srcTrans, input + srcOffset, conf_vector, bias,
+            offset_w, offset_h, inputIdx, anchorIdx, h, w, num_entries, entryPad, limit,
+            segNum, remain, dealNum, num_inputs, num_classes, anchorNum, netw, neth,
+            preprocessStore, temp_dst_stride, temp_dst_stride - boxCount, overflow);
+        if (remain > 0) {
+          srcOffset += segNum * limit * w * headChannels;
+          boxCount += DecodeAllBBoxesFullW(
+              result_preprocess + boxCount, src, srcTrans, input + srcOffset, conf_vector,
+              bias, offset_w, offset_h, inputIdx, anchorIdx, h, w, num_entries, entryPad,
+              remain, 1, remain, PAD_UP(remain * w, C_PAD_SIZE), num_inputs, num_classes,
+              anchorNum, netw, neth, preprocessStore, temp_dst_stride,
+              temp_dst_stride - boxCount, overflow);
+        }
+      }
+    } else {
+      // Split W
+      limit = (NRAM_BUFFER_SIZE / sizeof(half) / 2 / (2 + entryPad) - 64);
+      int total = hNum * w;
+      int tileNum = (total + limit - 1) / limit;
+      int dealNum = PAD_UP(limit, C_PAD_SIZE);
+      half* offset_w = buffer;
+      half* offset_h = buffer + dealNum;
+      half* src = offset_h + dealNum;
+      half* srcTrans = src + dealNum * entryPad;
+      half* ramp = srcTrans + dealNum * entryPad;
+      for (int i = 0; i < dealNum; i++) {
+        ramp[i] = i;
+      }
+      for (int anchorIdx = 0; anchorIdx < anchorNum; anchorIdx++) {
+        int srcOffset = hLoc * w * headChannels + anchorIdx * num_entries;
+        for (int tileIdx = 0; tileIdx < tileNum; tileIdx++) {
+          int tileStart = tileIdx * limit;
+          int tileSize = std::min(limit, total - tileStart);
+          int hIdx = hLoc + tileStart / w;
+          int wIdx = tileStart % w;
+          __nramset_half(conf_vector + 64, 64, wIdx);
+          __bang_cycle_add(offset_w, ramp, conf_vector + 64, dealNum, C_PAD_SIZE);
+          __nramset_half(conf_vector + 64, 64, w - 1);
+          __bang_cycle_gt(offset_h, offset_w, conf_vector + 64, dealNum, C_PAD_SIZE);
+          __bang_mul_const(srcTrans, offset_h, w, dealNum);
+          __bang_sub(offset_w, offset_w, srcTrans, dealNum);
+          __nramset_half(conf_vector + 64, 64, hIdx);
+          __bang_cycle_add(offset_h, offset_h, conf_vector + 64, dealNum, C_PAD_SIZE);
+          boxCount += DecodeAllBBoxesPartW(
+              result_preprocess + boxCount, src, srcTrans,
+              input + srcOffset + tileStart * headChannels, conf_vector, bias, offset_w,
+              offset_h, inputIdx, anchorIdx, h, w, num_entries, entryPad, tileSize, 1,
+              tileSize, PAD_UP(tileSize, C_PAD_SIZE), num_inputs, num_classes, anchorNum,
+              netw, neth, preprocessStore, temp_dst_stride, temp_dst_stride - boxCount,
+              overflow);
+        }
+      }
+    }
+  }
+  return boxCount;
+}
+
+inline half emuSigmoid(half x) {
+  return (half)(1.0f / (1.0f + expf(-(float)x)));
+}
+
+// CPU 参考: 逐框解码, 按 kernel 的顺序 (head, anchor, 行, 列) 收集 num_entries 个数.
+// objOnly 为 true 时按旧规则只比较 obj, 否则任一类别 obj * prob 超过阈值即保留.
+inline std::vector<std::vector<half>> referenceBoxes(const Net& net, half thresh, int coreIdx,
+                                                     int splitNum, bool objOnly = false) {
+  std::vector<std::vector<half>> boxes;
+  int entries = net.numClasses + 5;
+  for (size_t k = 0; k < net.heads.size(); k++) {
+    const Head& hd = net.heads[k];
+    int hLoc, hNum;
+    coreRows(hd.h, coreIdx, splitNum, hLoc, hNum);
+    for (int a = 0; a < hd.anchorNum; a++) {
+      half biasW = net.biases[net.biasOffset[k] + 2 * a] / net.netw;
+      half biasH = net.biases[net.biasOffset[k] + 2 * a + 1] / net.neth;
+      for (int y = hLoc; y < hLoc + hNum; y++) {
+        for (int x = 0; x < hd.w; x++) {
+          const half* e = &net.inputs[k][((size_t)y * hd.w + x) * hd.anchorNum * entries +
+                                         a * entries];
+          std::vector<half> box(entries);
+          box[0] = (half)(emuSigmoid(e[0]) + (half)x) * (half)(1.0 / hd.w);
+          box[1] = (half)(emuSigmoid(e[1]) + (half)y) * (half)(1.0 / hd.h);
+          box[2] = (half)expf((float)e[2]) * biasW;
+          box[3] = (half)expf((float)e[3]) * biasH;
+          box[4] = emuSigmoid(e[4]);
+          bool keep = objOnly && box[4] > thresh;
+          for (int c = 5; c < entries; c++) {
+            box[c] = emuSigmoid(e[c]) * box[4];
+            keep = keep || (!objOnly && box[c] > thresh);
+          }
+          if (keep) boxes.push_back(box);
+        }
+      }
+    }
+  }
+  return boxes;
+}
+
+#endif  // HOST_TEST_YOLOV3_STAGE1_H_
@@ -30,7 +30,13 @@
 #define NMS_DOWN(x, y) (x / y) * y
 
 enum Addr { NRAM, SRAM, GDRAM };
-enum SplitMode { NMS_BLOCK = 1, NMS_U1 = 4 };
+enum SplitMode { NMS_BLOCK = 1, NMS_U1 = 4, NMS_U2 = 8, NMS_U4 = 16, NMS_U8 = 32 };
+#define NMS_RECORD_SIZE 8  // 多核模式下每个核交换的记录: score, x1, y1, x2, y2, -, index (int32, 4 字节对齐)
+// 抑制方式: 硬抑制 / 线性 Soft-NMS / 高斯 Soft-NMS / DIoU-NMS /
+// 仅 IoU > thresh_iou 时抑制的硬抑制 (与 TF NonMaxSuppressionV3 相同)
+enum NmsMode { NMS_HARD = 0, NMS_SOFT_LINEAR = 1, NMS_SOFT_GAUSSIAN = 2, NMS_DIOU = 3,
+               NMS_HARD_GT = 4 };
+#define NMS_EPS 0.00006103515625  // 除数下限 (half 最小正规数), 避免退化框除零
 
 // max(x, y) ~ max(x - y, 0) + y
 template <typename NMS_DT>
@@ -48,6 +54,225 @@ __mlu_func__ void __svmin_relu(NMS_DT* dst, NMS_DT* src0, NMS_DT* src1, int len)
   __bang_sub(dst, src1, dst, len);
 }
 
+/*!
+ * DIoU 惩罚项 out = d^2 / c^2, d 为框中心距离, c 为与 max box 的最小外接框对角线长度.
+ * 中心与对角线都按两倍计算, 比值不变. 四个 tmp 向量长度不小于 len, out 不能与之重叠.
+ */
+template <typename NMS_DT>
+__mlu_func__ void __nms_diou_penalty(NMS_DT* out, NMS_DT* x1, NMS_DT* y1, NMS_DT* x2, NMS_DT* y2,
+                                     NMS_DT max_x1, NMS_DT max_y1, NMS_DT max_x2, NMS_DT max_y2,
+                                     NMS_DT* tmp0, NMS_DT* tmp1, NMS_DT* tmp2, NMS_DT* tmp3,
+                                     int len) {
+    // 4 * d^2 = ((x1 + x2) - (max_x1 + max_x2))^2 + ((y1 + y2) - (max_y1 + max_y2))^2
+    __nramset(tmp1, len, max_x1 + max_x2);
+    __bang_add(tmp0, x1, x2, len);
+    __bang_sub(tmp0, tmp0, tmp1, len);
+    __bang_mul(tmp0, tmp0, tmp0, len);
+    __nramset(tmp1, len, max_y1 + max_y2);
+    __bang_add(tmp2, y1, y2, len);
+    __bang_sub(tmp2, tmp2, tmp1, len);
+    __bang_mul(tmp2, tmp2, tmp2, len);
+    __bang_add(tmp0, tmp0, tmp2, len);
+
+    // c^2 = (max(x2) - min(x1))^2 + (max(y2) - min(y1))^2
+    __nramset(tmp1, len, max_x1);
+    __svmin_relu(tmp2, x1, tmp1, len);
+    __nramset(tmp1, len, max_x2);
+    __svmax_relu(tmp3, x2, tmp1, len);
+    __bang_sub(tmp2, tmp3, tmp2, len);
+    __bang_mul(tmp2, tmp2, tmp2, len);
+    __nramset(tmp1, len, max_y1);
+    __svmin_relu(tmp3, y1, tmp1, len);
+    __nramset(tmp1, len, max_y2);
+    __svmax_relu(out, y2, tmp1, len);
+    __bang_sub(tmp3, out, tmp3, len);
+    __bang_mul(tmp3, tmp3, tmp3, len);
+    __bang_add(tmp2, tmp2, tmp3, len);
+
+    // out = 4 * d^2 / (4 * c^2)
+    __bang_mul_const(tmp2, tmp2, 4, len);
+    __nramset(tmp1, len, (NMS_DT)NMS_EPS);
+    __svmax_relu(tmp2, tmp2, tmp1, len);
+    __bang_active_reciphp(tmp2, tmp2, len);
+    __bang_mul(out, tmp0, tmp2, len);
+}
+
+/*!
+ * Soft-NMS 的 score 衰减系数, 结果写回 area_i:
+ *   NMS_SOFT_LINEAR:   IoU > thresh_iou 时为 1 - IoU, 否则为 1
+ *   NMS_SOFT_GAUSSIAN: exp(-IoU^2 / sigma)
+ * area_u 与 tmp 会被改写.
+ */
+template <typename NMS_DT>
+__mlu_func__ void __nms_soft_weight(NMS_DT* area_i, NMS_DT* area_u, NMS_DT* tmp,
+                                    NmsMode nms_mode, NMS_DT thresh_iou, NMS_DT sigma,
+                                    int len) {
+    // IoU = area_I / area_U
+    __nramset(tmp, len, (NMS_DT)NMS_EPS);
+    __svmax_relu(area_u, area_u, tmp, len);
+    __bang_active_reciphp(area_u, area_u, len);
+    __bang_mul(area_i, area_i, area_u, len);
+    if (nms_mode == NMS_SOFT_LINEAR) {
+        __nramset(tmp, len, thresh_iou);
+        __bang_gt(tmp, area_i, tmp, len);
+        __bang_mul(area_i, area_i, tmp, len);
+        __nramset(tmp, len, 1);
+        __bang_sub(area_i, tmp, area_i, len);
+    } else {
+        __bang_mul(area_i, area_i, area_i, len);
+        __bang_mul_const(area_i, area_i, -1.0 / sigma, len);
+        __bang_active_exp(area_i, area_i, len);
+    }
+}
+
+// d = d > 0 ? d + pad : 0, 与 CPU 参考实现相同: 不相交时交集为 0, 相交时宽高加上 pad
+template <typename CT>
+__mlu_func__ void __nms_pad_relu(CT* d, CT* tmp0, CT* tmp1, CT pad, int len) {
+    __nramset(tmp0, len, 0);
+    __bang_gt(tmp1, d, tmp0, len);
+    __nramset(tmp0, len, pad);
+    __bang_add(d, d, tmp0, len);
+    __bang_mul(d, d, tmp1, len);
+}
+
+/*!
+ * 与 max box 的重叠对 score 的作用系数 factor:
+ *   NMS_HARD / NMS_DIOU: 保留标记, IoU (DIoU 时减去惩罚项) < thresh_iou 时为 1, 否则为 0,
+ *       比较方式为 area_U * thresh_iou > area_I, 不做除法
+ *   NMS_HARD_GT: 保留标记, IoU <= thresh_iou 时为 1, 即 1 - (area_I > area_U * thresh_iou)
+ *   NMS_SOFT_LINEAR / NMS_SOFT_GAUSSIAN: 衰减系数, 见 __nms_soft_weight
+ * w_pad / h_pad 不为 0 时宽高按 x2 - x1 + w_pad 计算, 与 CPU 参考实现相同.
+ * CT 为计算类型. 三个 tmp 向量长度不小于 len, penalty 仅 NMS_DIOU 使用.
+ */
+template <typename CT>
+__mlu_func__ void __nms_factor(CT* factor, CT* x1, CT* y1, CT* x2, CT* y2,
+                               CT max_x1, CT max_y1, CT max_x2, CT max_y2,
+                               CT* tmp0, CT* tmp1, CT* tmp2, CT* penalty,
+                               NmsMode nms_mode, CT thresh_iou, CT sigma,
+                               CT w_pad, CT h_pad, int len) {
+    int use_pad = w_pad != (CT)0 || h_pad != (CT)0;
+    CT max_area = (max_x2 - max_x1 + w_pad) * (max_y2 - max_y1 + h_pad);
+    if (nms_mode == NMS_DIOU) {
+        __nms_diou_penalty(penalty, x1, y1, x2, y2, max_x1, max_y1, max_x2, max_y2,
+                           factor, tmp0, tmp1, tmp2, len);
+    }
+    // 计算相交部分的面积
+    // area_I = (inter_x2 - inter_x1) * (inter_y2 - inter_y1)
+    __nramset(tmp0, len, max_x1);
+    __svmax_relu(factor, x1, tmp0, len);    // 相交部分左上角横坐标
+    __nramset(tmp2, len, max_x2);
+    __svmin_relu(tmp1, x2, tmp2, len);      // 相交部分右下角横坐标
+    __bang_sub(factor, tmp1, factor, len);
+    if (use_pad) {
+        __nms_pad_relu(factor, tmp0, tmp1, w_pad, len);
+    } else {
+        __bang_active_relu(factor, factor, len);  // 相交部分的宽度
+    }
+
+    __nramset(tmp1, len, max_y1);
+    __svmax_relu(tmp0, y1, tmp1, len);
+    __nramset(tmp1, len, max_y2);
+    __svmin_relu(tmp2, y2, tmp1, len);
+    __bang_sub(tmp0, tmp2, tmp0, len);
+    if (use_pad) {
+        __nms_pad_relu(tmp0, tmp1, tmp2, h_pad, len);
+    } else {
+        __bang_active_relu(tmp0, tmp0, len);      // 相交部分的高度
+    }
+    __bang_mul(factor, factor, tmp0, len);      // area_I
+
+    // 计算相并部分的面积
+    // area_U = (x2 - x1) * (y2 - y1) + max_area - area_I
+    __bang_sub(tmp0, x2, x1, len);
+    __bang_sub(tmp2, y2, y1, len);
+    if (use_pad) {
+        __nramset(tmp1, len, w_pad);
+        __bang_add(tmp0, tmp0, tmp1, len);
+        __nramset(tmp1, len, h_pad);
+        __bang_add(tmp2, tmp2, tmp1, len);
+    }
+    __bang_mul(tmp1, tmp0, tmp2, len);
+    __nramset(tmp0, len, max_area);
+    __bang_add(tmp1, tmp1, tmp0, len);
+    __bang_sub(tmp1, tmp1, factor, len);        // area_U
+
+    if (nms_mode == NMS_SOFT_LINEAR || nms_mode == NMS_SOFT_GAUSSIAN) {
+        __nms_soft_weight(factor, tmp1, tmp0, nms_mode, thresh_iou, sigma, len);
+        return;
+    }
+    if (nms_mode == NMS_DIOU) {
+        // IoU - penalty >= thresh  <=>  area_I >= area_U * (thresh + penalty)
+        __nramset(tmp0, len, thresh_iou);
+        __bang_add(penalty, penalty, tmp0, len);
+        __bang_mul(tmp1, tmp1, penalty, len);
+    } else {
+        __bang_mul_const(tmp1, tmp1, thresh_iou, len);
+    }
+    if (nms_mode == NMS_HARD_GT) {
+        __bang_gt(factor, factor, tmp1, len);   // area_I > area_U * thresh ?
+        __nramset(tmp0, len, 1);
+        __bang_sub(factor, tmp0, factor, len);
+        return;
+    }
+    __bang_gt(factor, tmp1, factor, len);       // area_U * thresh > area_I ?
+}
+
+// 混合精度模式下 half 与 float 之间的转换, NMS_DT 为 float 时直接拷贝
+__mlu_func__ void __nms_to_float(float* dst, half* src, int len) {
+    __bang_half2float(dst, src, len);
+}
+__mlu_func__ void __nms_to_float(float* dst, float* src, int len) {
+    __memcpy(dst, src, len * sizeof(float), NRAM2NRAM);
+}
+__mlu_func__ void __nms_from_float(half* dst, float* src, int len) {
+    __bang_float2half_rn(dst, src, len);
+}
+__mlu_func__ void __nms_from_float(float* dst, float* src, int len) {
+    __memcpy(dst, src, len * sizeof(float), NRAM2NRAM);
+}
+
+#define NMS_FLOAT_BUFFER_NUM 9   // 混合精度模式需要的 float 向量个数
+
+/*!
+ * 计算 factor (见 __nms_factor). float_iou 为 0 时直接用 NMS_DT 计算, 临时空间为
+ * tmp0 / tmp1 / tmp2 / penalty; 否则坐标先转换为 float, 面积, 交集, 并集都用 float 累加,
+ * 最后把 factor 转回 NMS_DT, 临时空间为 fbuf 中 NMS_FLOAT_BUFFER_NUM 个长度为 len 的向量.
+ * half 的 10 位尾数在归一化坐标下表示小框的面积误差很大, 混合精度只增加片上计算,
+ * 输入输出仍为 half.
+ */
+template <typename NMS_DT>
+__mlu_func__ void __nms_overlap(NMS_DT* factor, NMS_DT* x1, NMS_DT* y1, NMS_DT* x2, NMS_DT* y2,
+                                NMS_DT max_x1, NMS_DT max_y1, NMS_DT max_x2, NMS_DT max_y2,
+                                NMS_DT* tmp0, NMS_DT* tmp1, NMS_DT* tmp2, NMS_DT* penalty,
+                                float* fbuf, int float_iou, NmsMode nms_mode,
+                                NMS_DT thresh_iou, NMS_DT sigma, float w_pad, float h_pad,
+                                int len) {
+    if (!float_iou) {
+        __nms_factor(factor, x1, y1, x2, y2, max_x1, max_y1, max_x2, max_y2,
+                     tmp0, tmp1, tmp2, penalty, nms_mode, thresh_iou, sigma,
+                     (NMS_DT)w_pad, (NMS_DT)h_pad, len);
+        return;
+    }
+    float* fx1 = fbuf;
+    float* fy1 = fx1 + len;
+    float* fx2 = fy1 + len;
+    float* fy2 = fx2 + len;
+    float* ffactor = fy2 + len;
+    float* ftmp0 = ffactor + len;
+    float* ftmp1 = ftmp0 + len;
+    float* ftmp2 = ftmp1 + len;
+    float* fpenalty = ftmp2 + len;
+    __nms_to_float(fx1, x1, len);
+    __nms_to_float(fy1, y1, len);
+    __nms_to_float(fx2, x2, len);
+    __nms_to_float(fy2, y2, len);
+    __nms_factor(ffactor, fx1, fy1, fx2, fy2,
+                 (float)max_x1, (float)max_y1, (float)max_x2, (float)max_y2,
+                 ftmp0, ftmp1, ftmp2, fpenalty, nms_mode, (float)thresh_iou, (float)sigma,
+                 w_pad, h_pad, len);
+    __nms_from_float(factor, ffactor, len);
+}
+
 
 /*!
 * 实现非极大值抑制（NMS），支持输入和输出地址空间的多样化选择（包括GDRAM/SRAM/NRAM）
@@ -62,7 +287,10 @@ __mlu_func__ void __svmin_relu(NMS_DT* dst, NMS_DT* src0, NMS_DT* src1, int len)
 * @param[in] buffer             计算使用的NRAM空间首地址
 * @param[in] buffer_size        计算使用的NRAM空间大小 - 单位：字节
 * @param[in] sram               在函数外部声明的SRAM的地址空间，在UNION1模式下通过对SRAM的读写完成核间通信，找到score的最大值
-* @param[in] split_mode         拆分模式: NMS_BLOCK(BLOCK) / NMS_U1(UNION1)
+                                UNION2 及以上模式下 SRAM 不能跨 cluster 共享, 改为传入 GDRAM 上的交换空间.
+                                至少 2 * split_mode * NMS_RECORD_SIZE 个元素, 同一任务中的多个 union 作业不能共用
+* @param[in] split_mode         拆分模式: NMS_BLOCK(BLOCK) / NMS_U1(UNION1) / NMS_U2, NMS_U4, NMS_U8 (UNION2/4/8)
+                                UNION2 及以上模式要求 src 与 dst 均为 GDRAM
 * @param[in] input_box_num      输入的待筛选边界框的数量
 * @param[in] input_stride       输入数据的步长
 * @param[out] output_stride     输出数据的步长
@@ -81,6 +309,16 @@ __mlu_func__ void __svmin_relu(NMS_DT* dst, NMS_DT* src0, NMS_DT* src1, int len)
     y2, y2, y2, .....0000
     2: 
     when dst == NRAM, save selected box score only at original location.
+* @param[in] nms_mode          抑制方式, 默认为硬抑制 NMS_HARD:
+    NMS_SOFT_LINEAR / NMS_SOFT_GAUSSIAN: 不再删除重叠框, 而是衰减其 score (Soft-NMS),
+        输出的 score 为衰减后的值, score 不超过 thresh_score 的框不再输出
+    NMS_DIOU: IoU 减去中心距离惩罚项 d^2 / c^2 后再与 thresh_iou 比较 (DIoU-NMS)
+    NMS_HARD_GT: 硬抑制, 但 IoU 等于 thresh_iou 的框保留, thresh_iou 为 0 时不相交的框不被抑制
+* @param[in] sigma             高斯 Soft-NMS 的 sigma
+* @param[in] float_iou         非 0 时 (仅 NMS_DT 为 half 时有效) 面积, 交集, 并集转换为 float 计算,
+                                每个待筛选框多占用 2 * NMS_FLOAT_BUFFER_NUM 个 half 的 buffer
+* @param[in] w_pad             框宽度的附加量, 宽度按 x2 - x1 + w_pad 计算, CPU 参考实现中为 1 / netw
+* @param[in] h_pad             框高度的附加量
 */
 
 template <typename NMS_DT>
@@ -100,17 +338,41 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
                                 int keepNum,                    // 根据概率排序选择保留概率最高的边界框个数
                                 NMS_DT thresh_iou,              // 交并比阈值
                                 NMS_DT thresh_score,            // confidence score 阈值
-                                int save_method                 // 存储格式：0 / 1 / 2
+                                int save_method,                // 存储格式：0 / 1 / 2
+                                NmsMode nms_mode = NMS_HARD,    // 抑制方式
+                                NMS_DT sigma = 0.5,             // 高斯 Soft-NMS 参数
+                                int float_iou = 0,              // 是否用 float 计算 IoU
+                                float w_pad = 0,                // 宽度附加量
+                                float h_pad = 0                 // 高度附加量
                                 ) {
     /*====== PREPARATORY  ======*/
     /*------ 变量声明 ------*/
     int core_limit = split_mode;    // 启用的核数
-    int32_t* loop_end_flag = (int32_t *)(sram + 28);  // for U1: 结束标识符
-    loop_end_flag[0] = 0;
-    int nms_buffer_count1 = 9;
-    int nms_buffer_count2 = 4;
+    int multi_cluster = core_limit > NMS_U1;
+    // 核在本次拆分中的序号, 多 cluster 时按 union 作业内的 taskId 计算
+    int core_id = multi_cluster ? taskId % core_limit : coreId;
+    // 负责写输出的核
+    int store_core = core_limit == 1 ||
+                     (multi_cluster ? core_id == core_limit - 1 : coreId == coreDim - 1);
+    int use_diou = nms_mode == NMS_DIOU;  // DIoU 需要额外一个向量存放惩罚项
+    float_iou = float_iou && sizeof(NMS_DT) == 2;
+    int float_count = float_iou * NMS_FLOAT_BUFFER_NUM * 2;  // float 向量按 half 计的个数
     int nram_save_limit_count;      // NRAM上临时存储待筛选边界框数量
     nram_save_limit_count = dst == NRAM ? 0 : 256;
+    // max_box 之后是多核交换用的空间: 各核的记录, 取出的 score 及其最大值,
+    // 不与长度为 max_seg_pad 的 inter_x1 等共用, buffer 较小时也不会互相覆盖
+    int exchange_count = core_limit > 1 ?
+                         NMS_UP(core_limit * NMS_RECORD_SIZE, NMS_SIZE) + 2 * NMS_SIZE : 0;
+    int max_box_count = 64 + exchange_count;
+    // float 临时空间使一段放不下 NMS_SIZE 个框时, 退回 half 计算 IoU
+    if (float_count > 0 &&
+        (buffer_size - (max_box_count + nram_save_limit_count * 5) * (int)sizeof(NMS_DT)) /
+        ((9 + use_diou + float_count) * (int)sizeof(NMS_DT)) < NMS_SIZE) {
+        float_iou = 0;
+        float_count = 0;
+    }
+    int nms_buffer_count1 = 9 + use_diou + float_count;
+    int nms_buffer_count2 = 4 + use_diou + float_count;
 
     /* 数据调度模式
     0: load data to NRAM buffer first; 
@@ -122,7 +384,7 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
     int MODE = 0;
     if (src == NRAM) {
         int flag1 = (input_box_num == NMS_UP(input_box_num, NMS_SIZE));  // input_box_num must be pad
-        int flag2 = (buffer_size > (nms_buffer_count2 * input_box_num + 64 /*max_box*/ +
+        int flag2 = (buffer_size > (nms_buffer_count2 * input_box_num + max_box_count +
                                     (nram_save_limit_count * 5) * (dst != NRAM)) *
                                     sizeof(NMS_DT));  // buffer is enough
         if (flag1 && flag2)
@@ -151,6 +413,8 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
     NMS_DT* inter_y1;
     NMS_DT* inter_x2;
     NMS_DT* inter_y2;
+    NMS_DT* penalty;        // buffer空间，DIoU 惩罚项
+    float* fbuf;            // buffer空间，混合精度的 float 临时空间
     NMS_DT* max_box;        // buffer空间，存放置信度最高的边界框信息 [score, x1, y1, x2, y2]
     NMS_DT* nram_save;      // buffer空间，待筛选边界框的临时存储空间
 
@@ -172,7 +436,7 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
             remain = input_box_num;
             remain_pad = remain;
         } else {
-            limit = (buffer_size - 64 * sizeof(NMS_DT) /*reserve for max score box*/ -
+            limit = (buffer_size - max_box_count * sizeof(NMS_DT) /*reserve for max score box*/ -
                     nram_save_limit_count * 5 * sizeof(NMS_DT)) /
                     (nms_buffer_count1 * sizeof(NMS_DT));
             len_core = input_box_num;
@@ -185,7 +449,7 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
     }
     // src == SRAM or GDRAM
     else {
-        limit = (buffer_size - 64 * sizeof(NMS_DT) -
+        limit = (buffer_size - max_box_count * sizeof(NMS_DT) -
                 nram_save_limit_count * 5 * sizeof(NMS_DT)) /
                 (nms_buffer_count1 * sizeof(NMS_DT));
         if (core_limit == 1) {
@@ -195,13 +459,13 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
             // 多核拆分 (尽量平均)
             if (input_box_num % core_limit == 0) {
                 len_core = input_box_num / core_limit;
-                input_offset = coreId * len_core;
+                input_offset = core_id * len_core;
             } else {
                 // 
                 int avg_core = input_box_num / core_limit;
                 int tmp = input_box_num % core_limit;
-                coreId < tmp ? len_core = avg_core + 1 : len_core = avg_core;
-                input_offset = avg_core * coreId + (coreId <= tmp ? coreId : tmp);
+                core_id < tmp ? len_core = avg_core + 1 : len_core = avg_core;
+                input_offset = avg_core * core_id + (core_id <= tmp ? core_id : tmp);
             }
         }
         max_seg_pad = NMS_DOWN(limit, NMS_SIZE);
@@ -216,8 +480,10 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
         inter_y1 = inter_x1 + input_box_num;
         inter_x2 = inter_y1 + input_box_num;
         inter_y2 = inter_x2 + input_box_num;
-        max_box = inter_y2 + input_box_num;  // the max score, x1, y1, x2, y2
-        nram_save = max_box + 64;
+        penalty = inter_y2 + input_box_num;
+        fbuf = (float *)(penalty + input_box_num * use_diou);
+        max_box = (NMS_DT *)fbuf + input_box_num * float_count;  // the max score, x1, y1, x2, y2
+        nram_save = max_box + max_box_count;
     } else {
         score = buffer;
         x1 = score + max_seg_pad;
@@ -228,21 +494,18 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
         inter_y1 = inter_x1 + max_seg_pad;
         inter_x2 = inter_y1 + max_seg_pad;
         inter_y2 = inter_x2 + max_seg_pad;
-        max_box = inter_y2 + max_seg_pad;  // the max score, x1, y1, x2, y2
-        nram_save = max_box + 64;
+        penalty = inter_y2 + max_seg_pad;
+        fbuf = (float *)(penalty + max_seg_pad * use_diou);
+        max_box = (NMS_DT *)fbuf + max_seg_pad * float_count;  // the max score, x1, y1, x2, y2
+        nram_save = max_box + max_box_count;
     }
 
 
     /*====== EXECUTION PHASE ======*/
 
     for (int keep = 0; keep < keepNum; keep++) {
-        if (core_limit != 1) {
-            __sync_cluster();  // sync before current loop
-        }
-
         int max_index = 0;         // the max score index
         int global_max_index = 0;  // for U1
-        NMS_DT max_area = 0;       // the max socre area
         max_box[0] = 0;            // init 0
 
         // Find the box with max confidence score in every core
@@ -286,48 +549,51 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
             max_box[2] = input_y1_ptr[max_index];
             max_box[3] = input_x2_ptr[max_index];
             max_box[4] = input_y2_ptr[max_index];
-            max_area = (max_box[3] - max_box[1]) * (max_box[4] - max_box[2]);
             input_score_ptr[max_index] = 0;
             global_max_index = max_index;
-        } else if (core_limit == 4) {
-            // get the max box's x1, y1, x2, y2 on every core
+        } else {
+            // 多核: 每个核把自己的最大框打包成一条记录 [score, x1, y1, x2, y2, index],
+            // 一次拷贝写入交换空间 (UNION1 为 SRAM, 跨 cluster 时为 GDRAM), 同步后一次读回
+            // 全部记录, 每个核各自求最大值. 各核的结果相同, 不需要再广播, 也不需要结束
+            // 标识符, 每轮只有一次同步.
+            // 交换空间分两组交替使用: 写第 keep 轮的记录时, 其他核都已越过第 keep - 1 轮
+            // 的同步, 不会再读取同一组中第 keep - 2 轮的记录.
+            NMS_DT* slot = sram + (keep % 2) * core_limit * NMS_RECORD_SIZE;
             max_box[1] = input_x1_ptr[max_index];
             max_box[2] = input_y1_ptr[max_index];
             max_box[3] = input_x2_ptr[max_index];
             max_box[4] = input_y2_ptr[max_index];
-            ((int32_t *)(max_box + 5))[0] = max_index;
-            // copy every core's box info to sram, score---x1---y1---x2---y2---
-            for (int i = 0; i < 5; i++) {
-                __memcpy(sram + i * core_limit + coreId, max_box + i, 1 * sizeof(NMS_DT), NRAM2SRAM);
+            ((int32_t *)(max_box + 6))[0] = max_index;
+            NMS_DT* records = max_box + 64;
+            NMS_DT* record_score = records + NMS_UP(core_limit * NMS_RECORD_SIZE, NMS_SIZE);
+            NMS_DT* record_max = record_score + NMS_SIZE;
+            if (multi_cluster) {
+                __memcpy(slot + core_id * NMS_RECORD_SIZE, max_box,
+                         NMS_RECORD_SIZE * sizeof(NMS_DT), NRAM2GDRAM);
+                __sync_all();
+                __memcpy(records, slot, core_limit * NMS_RECORD_SIZE * sizeof(NMS_DT), GDRAM2NRAM);
+            } else {
+                __memcpy(slot + core_id * NMS_RECORD_SIZE, max_box,
+                         NMS_RECORD_SIZE * sizeof(NMS_DT), NRAM2SRAM);
+                __sync_cluster();
+                __memcpy(records, slot, core_limit * NMS_RECORD_SIZE * sizeof(NMS_DT), SRAM2NRAM);
             }
-            // copy every core's max_index to sram, use 2 NMS_DT to store max_index
-            __memcpy(sram + 5 * core_limit + coreId * 2, max_box + 5, 2 * sizeof(NMS_DT), NRAM2SRAM);
-            __sync_cluster();
-
-            
-            // copy score from sram to nram and find the max
-            __nramset(inter_x1, 64, 0);
-            __memcpy(inter_x1, sram, core_limit * sizeof(NMS_DT), SRAM2NRAM);
-            __bang_max(max_box, inter_x1, 64);
-
-            int max_core = ((unsigned short *)max_box)[1] * (sizeof(NMS_DT) == 2) +
-                           ((unsigned int *)max_box)[1] * (sizeof(NMS_DT) == 4);
-            // copy the max box to max_box
-            __memcpy(max_box + 1, sram + 1 * core_limit + max_core, 1 * sizeof(NMS_DT), SRAM2NRAM);     // x1
-            __memcpy(max_box + 2, sram + 2 * core_limit + max_core, 1 * sizeof(NMS_DT), SRAM2NRAM);     // y1
-            __memcpy(max_box + 3, sram + 3 * core_limit + max_core, 1 * sizeof(NMS_DT), SRAM2NRAM);     // x2
-            __memcpy(max_box + 4, sram + 4 * core_limit + max_core, 1 * sizeof(NMS_DT), SRAM2NRAM);     // y2
-            __memcpy(max_box + 5, sram + 5 * core_limit + 2 * max_core, 2 * sizeof(NMS_DT), SRAM2NRAM); // max_index
-            max_area = (max_box[3] - max_box[1]) * (max_box[4] - max_box[2]);
-            global_max_index = ((int32_t *)(max_box + 5))[0];
+
+            // 取出各记录的 score 求最大值, score 相同时取序号最小的核, 即输入中靠前的框
+            __nramset(record_score, NMS_SIZE, 0);
+            __memcpy(record_score, records, sizeof(NMS_DT), NRAM2NRAM, sizeof(NMS_DT),
+                     NMS_RECORD_SIZE * sizeof(NMS_DT), core_limit - 1);
+            __bang_max(record_max, record_score, NMS_SIZE);
+            int max_core = ((unsigned short *)record_max)[1] * (sizeof(NMS_DT) == 2) +
+                           ((unsigned int *)record_max)[1] * (sizeof(NMS_DT) == 4);
+            __memcpy(max_box, records + max_core * NMS_RECORD_SIZE,
+                     NMS_RECORD_SIZE * sizeof(NMS_DT), NRAM2NRAM);
+            global_max_index = ((int32_t *)(max_box + 6))[0];
 
             // 将搜索出的score最大的候选框的score置为零（排除在之后的移除操作之外）
-            if (src != NRAM) {
+            // 只由该框所在的核置零, 其他核不会读写这一段 score
+            if (core_id == max_core) {
                 input_score_ptr[global_max_index] = 0;
-            } else {
-                if (coreId == max_core) {
-                    input_score_ptr[global_max_index] = 0;
-                }
             }
         }
 
@@ -354,7 +620,7 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
                     }
                     nram_save_count = 0;
                 } else {
-                    if (coreId == coreDim - 1) {
+                    if (store_core) {
                         if (save_method == 0) {  // score, x1, y1, x2, y2
                             __memcpy(output_data, nram_save, nram_save_count * 5 * sizeof(NMS_DT), store_dir);
                             output_data += nram_save_count * 5;
@@ -370,20 +636,9 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
         }           // if dst
 
         // if the max score <= thresh, end
-        if (core_limit == 1) {
-            if (max_box[0] <= thresh_score) {
-                break;
-        }
-        } else {
-            if (max_box[0] <= thresh_score) {
-                if (coreId == coreDim - 1) {
-                    loop_end_flag[0] = 1;
-                }
-            }
-            __sync_cluster();  // wait for update loop_end_flag
-            if (loop_end_flag[0] == 1) {
-                break;
-            }
+        // 多核模式下各核求得的最大值相同, 各自判断即可
+        if (max_box[0] <= thresh_score) {
+            break;
         }
         
         // store to nram
@@ -410,7 +665,7 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
                 save_ptr[max_index] = max_box[0];
             }
         } else {
-            if (coreId == coreDim - 1) {
+            if (store_core) {
                 if (save_method == 0) {  // score, x1, y1, x2, y2
                 __memcpy(save_ptr + save_offset * 5, max_box, 5 * sizeof(NMS_DT), NRAM2NRAM,
                         5 * sizeof(NMS_DT), 5 * sizeof(NMS_DT), 0);
@@ -441,7 +696,7 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
                                 output_stride * sizeof(NMS_DT), nram_save_limit_count * sizeof(NMS_DT), 4);
                     }
                 } else {
-                    if (coreId == coreDim - 1) {
+                    if (store_core) {
                         if (save_method == 0) {  // score, x1, y1, x2, y2
                             __memcpy(output_data, nram_save, nram_save_count * 5 * sizeof(NMS_DT), store_dir);
                         } else {  // score---, x1---, y1---, x2---, y2---
@@ -503,40 +758,12 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
             }
 
             /*---- Compute IoU ----*/
-            // 计算相交部分的面积
-            // area_I = (inter_x2 - inter_x1) * (inter_y2 - inter_y1)
-            __nramset(inter_y1, seg_len, max_box[1]);       // max_x1
-            __svmax_relu(inter_x1, x1, inter_y1, seg_len);  // inter_x1 (相交部分左上角横坐标)
-            __nramset(inter_y2, seg_len, max_box[3]);       // max_x2
-            __svmin_relu(inter_x2, x2, inter_y2, seg_len);  // inter_x2 (相交部分右下角横坐标)
-            __bang_sub(inter_x1, inter_x2, inter_x1, seg_len);  // inter_x2 - inter_x1
-            __bang_active_relu(inter_x1, inter_x1, seg_len);    // 相交部分的宽度 inter_w | inter_x2 - inter_x1|
-            
-            __nramset(inter_x2, seg_len, max_box[2]);         // max_y1
-            __svmax_relu(inter_y1, y1, inter_x2, seg_len);    // inter_y1
-            __nramset(inter_x2, seg_len, max_box[4]);         // max_y2
-            __svmin_relu(inter_y2, y2, inter_x2, seg_len);    // inter_y2
-            __bang_sub(inter_y1, inter_y2, inter_y1, seg_len);  // inter_y2, inter_y1
-            __bang_active_relu(inter_y1, inter_y1, seg_len);    // 相交部分的高度 inter_h
-            __bang_mul(inter_x1, inter_x1, inter_y1, seg_len);  // area_I
-
-            // 计算输入框的面积 
-            // area = (x2 - x1) * (y2 - y1);
-            __bang_sub(inter_y1, x2, x1, seg_len);
-            __bang_sub(inter_y2, y2, y1, seg_len);
-            __bang_mul(inter_x2, inter_y1, inter_y2, seg_len);  // area
-
-            // 计算相并部分的面积
-            // area_U = area + max_area - area_I
-            __nramset(inter_y1, seg_len, max_area);
-            __bang_add(inter_x2, inter_x2, inter_y1, seg_len);
-            __bang_sub(inter_x2, inter_x2, inter_x1, seg_len);  // area_U
-
-            /*---- Select the box ----*/
-            // if IoU is greater than threshold, set the score to zero
-            __bang_mul_const(inter_x2, inter_x2, thresh_iou, seg_len);
-            __bang_gt(inter_x1, inter_x2, inter_x1, seg_len);   // 比较向量化：area_U * thresh > area_I ?
-            __bang_mul(score, score, inter_x1, seg_len);        // 置零向量化
+            // IoU 超过阈值的框 score 置零, Soft-NMS 时乘以衰减系数
+            __nms_overlap(inter_x1, x1, y1, x2, y2,
+                          max_box[1], max_box[2], max_box[3], max_box[4],
+                          inter_y1, inter_x2, inter_y2, penalty, fbuf, float_iou,
+                          nms_mode, thresh_iou, sigma, w_pad, h_pad, seg_len);
+            __bang_mul(score, score, inter_x1, seg_len);
 
             /*---- Update the score ----*/
             if (MODE == 0) {  // do nothing when MODE = 1
@@ -555,6 +782,578 @@ __mlu_func__ void nms_detection(int &output_box_num,            // 筛选出的
     }       // for keepNum
 }
 
+/*====== 排序模式 (sorted-candidate NMS) ======*/
+/*
+ * nms_detection 每保留一个框都要对全部候选框做一次 __bang_max, 数据不在 NRAM 时
+ * 还要从 GDRAM/SRAM 重新加载. 排序模式只遍历一次输入, 把 score 超过阈值的框
+ * 压缩到 NRAM, 做一次片上双调排序 (降序), 再按排序后的顺序依次抑制:
+ *   - 不再需要逐个求最大值, 每次 IoU 计算只覆盖排在当前框之后的部分;
+ *   - 遇到 score <= thresh_score 的框即可提前结束.
+ * 排序的代价为 O(n * log^2(n)) 次向量运算, 候选框较少时不如逐个求最大值,
+ * 由 nms_detection_auto 按候选框数量选择.
+ */
 
+#define NMS_SORT_BUFFER_NUM 16   // 排序模式需要的 NRAM 向量个数, 每个长度为 sort_cap
+#define NMS_SORT_MIN_BOX 1024    // 输入框少于该值时使用逐个求最大值的 nms_detection
+#define NMS_SORT_MAX_BOX 4096    // 排序模式能处理的超过阈值的框数上限
+
+// 不小于 num 的 2 的幂, 至少为 NMS_SIZE
+__mlu_func__ int __nms_sort_len(int num) {
+    int len = NMS_SIZE;
+    while (len < num) {
+        len *= 2;
+    }
+    return len;
+}
+
+// buffer_size 下 buffer_num 个向量能容纳的候选框个数 (2 的幂), 不足 NMS_SIZE 时返回 0
+template <typename NMS_DT>
+__mlu_func__ int __nms_sort_capacity(int buffer_size, int buffer_num) {
+    int cap = NMS_SIZE;
+    if ((buffer_num * cap + NMS_SIZE) * (int)sizeof(NMS_DT) > buffer_size) {
+        return 0;
+    }
+    while (cap * 2 <= NMS_SORT_MAX_BOX &&
+           (buffer_num * cap * 2 + NMS_SIZE) * (int)sizeof(NMS_DT) <= buffer_size) {
+        cap *= 2;
+    }
+    return cap;
+}
+
+// mask[i] = (i & j) ? 1 : 0, j >= len 时全为 0
+template <typename NMS_DT>
+__mlu_func__ void __nms_bit_mask(NMS_DT* mask, int j, int len) {
+    if (j >= len) {
+        __nramset(mask, len, 0);
+        return;
+    }
+    // 先写出一个不短于 NMS_SIZE 的周期, 再整段复制
+    int period = 2 * j > NMS_SIZE ? 2 * j : NMS_SIZE;
+    if (2 * j <= NMS_SIZE) {
+        for (int i = 0; i < NMS_SIZE; i++) {
+            mask[i] = (i & j) ? 1 : 0;
+        }
+    } else {
+        __nramset(mask, j, 0);
+        __nramset(mask + j, j, 1);
+    }
+    if (len > period) {
+        __memcpy(mask + period, mask, period * sizeof(NMS_DT), NRAM2NRAM,
+                 period * sizeof(NMS_DT), 0, len / period - 2);
+    }
+}
+
+// partner[i] = data[i ^ j] = data[i + j] * (1 - mask_j) + data[i - j] * mask_j
+// 乘数只有 0/1, 结果与直接搬运完全一致
+template <typename NMS_DT>
+__mlu_func__ void __nms_partner(NMS_DT* partner, NMS_DT* shift, NMS_DT* data,
+                                NMS_DT* mask_j, NMS_DT* inv_mask_j, int j, int len) {
+    __memcpy(shift, data + j, (len - j) * sizeof(NMS_DT), NRAM2NRAM);
+    __memcpy(partner + j, data, (len - j) * sizeof(NMS_DT), NRAM2NRAM);
+    __bang_mul(partner, partner, mask_j, len);
+    __bang_mul(shift, shift, inv_mask_j, len);
+    __bang_add(partner, partner, shift, len);
+}
+
+// data = data * (1 - swap) + partner * swap
+template <typename NMS_DT>
+__mlu_func__ void __nms_select(NMS_DT* data, NMS_DT* partner, NMS_DT* swap,
+                               NMS_DT* inv_swap, int len) {
+    __bang_mul(data, data, inv_swap, len);
+    __bang_mul(partner, partner, swap, len);
+    __bang_add(data, data, partner, len);
+}
+
+/*!
+ * 对 score 做降序双调排序, payload 中的各行随 score 一起交换. len 为 2 的幂.
+ * 比较-交换的对象 i ^ j 通过两次 NRAM 内的平移拷贝加 0/1 掩码得到,
+ * 每一步都是长度为 len 的向量运算.
+ * tmp 至少包含 10 个长度为 len 的向量.
+ */
+template <typename NMS_DT>
+__mlu_func__ void __nms_bitonic_sort(NMS_DT* score, NMS_DT** payload, int payload_num,
+                                     NMS_DT* tmp, int len) {
+    NMS_DT* partner    = tmp;
+    NMS_DT* shift      = partner + len;
+    NMS_DT* mask_j     = shift + len;
+    NMS_DT* mask_k     = mask_j + len;
+    NMS_DT* inv_mask_j = mask_k + len;
+    NMS_DT* swap       = inv_mask_j + len;
+    NMS_DT* inv_swap   = swap + len;
+    NMS_DT* gt_p       = inv_swap + len;
+    NMS_DT* gt_s       = gt_p + len;
+    NMS_DT* ones       = gt_s + len;
+
+    // 平移拷贝不会写满 partner / shift, 先清零避免未初始化数据参与乘法
+    __nramset(partner, len, 0);
+    __nramset(shift, len, 0);
+    __nramset(ones, len, 1);
+
+    for (int k = 2; k <= len; k *= 2) {
+        __nms_bit_mask(mask_k, k, len);
+        for (int j = k / 2; j > 0; j /= 2) {
+            __nms_bit_mask(mask_j, j, len);
+            __bang_sub(inv_mask_j, ones, mask_j, len);
+
+            // 降序: (i & k) == (i & j) 的位置保留较大值, 否则保留较小值
+            // take_min = (mask_j - mask_k)^2
+            __bang_sub(gt_s, mask_j, mask_k, len);
+            __bang_mul(swap, gt_s, gt_s, len);
+
+            // swap = take_min ? (score > partner) : (partner > score)
+            // 一对位置上的判断互为镜像, 相等时两边都不交换
+            __nms_partner(partner, shift, score, mask_j, inv_mask_j, j, len);
+            __bang_gt(gt_p, partner, score, len);
+            __bang_gt(gt_s, score, partner, len);
+            __bang_sub(gt_s, gt_s, gt_p, len);
+            __bang_mul(swap, swap, gt_s, len);
+            __bang_add(swap, swap, gt_p, len);
+            __bang_sub(inv_swap, ones, swap, len);
+
+            __nms_select(score, partner, swap, inv_swap, len);
+            for (int c = 0; c < payload_num; c++) {
+                __nms_partner(partner, shift, payload[c], mask_j, inv_mask_j, j, len);
+                __nms_select(payload[c], partner, swap, inv_swap, len);
+            }
+        }
+    }
+}
+
+/*!
+ * 排序模式的 NMS, 参数含义与 nms_detection 相同, 仅支持 NMS_BLOCK 与 save_method 0/1.
+ * 双调排序不稳定: score 各不相同时结果与 nms_detection 相同; score 相等的框
+ * 输出先后 (以及互相抑制时保留哪一个) 不确定, nms_detection 总是保留序号小的框.
+ * 超过 thresh_score 的框多于 buffer 能容纳的个数时不做任何写入并返回 false,
+ * 调用者应改用 nms_detection. 输入数据不会被修改.
+ * Soft-NMS 会改变 score 的先后顺序, 预先排序无效, 同样返回 false.
+ */
+template <typename NMS_DT>
+__mlu_func__ bool nms_detection_sorted(int &output_box_num,
+                                       NMS_DT* output_data,
+                                       Addr dst,
+                                       NMS_DT* input_data_score,
+                                       NMS_DT* input_data_box,
+                                       Addr src,
+                                       NMS_DT* buffer,
+                                       int buffer_size,
+                                       int input_box_num,
+                                       int input_stride,
+                                       int output_stride,
+                                       int keepNum,
+                                       NMS_DT thresh_iou,
+                                       NMS_DT thresh_score,
+                                       int save_method,
+                                       NmsMode nms_mode = NMS_HARD,
+                                       int float_iou = 0,
+                                       float w_pad = 0,
+                                       float h_pad = 0) {
+    if (nms_mode == NMS_SOFT_LINEAR || nms_mode == NMS_SOFT_GAUSSIAN) {
+        return false;
+    }
+    float_iou = float_iou && sizeof(NMS_DT) == 2;
+    int float_count = float_iou * NMS_FLOAT_BUFFER_NUM * 2;
+    int cap = __nms_sort_capacity<NMS_DT>(buffer_size, NMS_SORT_BUFFER_NUM + float_count);
+    if (cap == 0 || save_method == 2) {
+        return false;
+    }
+
+    NMS_DT* score = buffer;
+    NMS_DT* x1    = score + cap;
+    NMS_DT* y1    = x1 + cap;
+    NMS_DT* x2    = y1 + cap;
+    NMS_DT* y2    = x2 + cap;
+    NMS_DT* tmp   = y2 + cap;             // 排序/IoU 临时空间, 10 个向量
+    NMS_DT* flag  = tmp + 10 * cap;       // 保留标记
+    float*  fbuf  = (float *)(flag + cap);  // 混合精度的 float 临时空间
+    NMS_DT* count = flag + cap + float_count * cap;  // __bang_count 结果
+
+    /*----- 1. 压缩: 一次遍历, 保留 score > thresh_score 的框 -----*/
+    mluMemcpyDirection_t load_dir = GDRAM2NRAM;
+    if (src == NRAM) {
+        load_dir = NRAM2NRAM;
+    } else if (src == SRAM) {
+        load_dir = SRAM2NRAM;
+    }
+    NMS_DT* load_score = tmp;
+    NMS_DT* load_box   = tmp + cap;       // 4 行, 与输入相同的 x1/y1/x2/y2 排列
+    NMS_DT* mask       = tmp + 5 * cap;
+    NMS_DT* thresh_vec = tmp + 6 * cap;
+    NMS_DT* collected  = tmp + 7 * cap;
+    NMS_DT* dst_rows[5] = {score, x1, y1, x2, y2};
+
+    // 排序长度之外的位置填 thresh_score, 排序后落在末尾且不会被保留
+    __nramset(score, cap, thresh_score);
+    __nramset(x1, 4 * cap, 0);
+    __nramset(thresh_vec, cap, thresh_score);
+    int total = 0;
+    for (int offset = 0; offset < input_box_num; offset += cap) {
+        int cpy_len = input_box_num - offset < cap ? input_box_num - offset : cap;
+        int seg_len = NMS_UP(cpy_len, NMS_SIZE);
+        __nramset(load_score, seg_len, thresh_score);
+        __memcpy(load_score, input_data_score + offset, cpy_len * sizeof(NMS_DT), load_dir);
+        __memcpy(load_box, input_data_box + offset, cpy_len * sizeof(NMS_DT), load_dir,
+                 cap * sizeof(NMS_DT), input_stride * sizeof(NMS_DT), 3);
+        __bang_gt(mask, load_score, thresh_vec, seg_len);
+        __bang_count((uint32_t*)count, mask, seg_len);
+        int seg_count = ((uint32_t*)count)[0];
+        if (seg_count == 0) {
+            continue;
+        }
+        if (total + seg_count > cap) {
+            return false;
+        }
+        for (int r = 0; r < 5; r++) {
+            NMS_DT* row = r == 0 ? load_score : load_box + (r - 1) * cap;
+            __bang_collect(collected, row, mask, seg_len);
+            __memcpy(dst_rows[r] + total, collected, seg_count * sizeof(NMS_DT), NRAM2NRAM);
+        }
+        total += seg_count;
+    }
+    if (total == 0) {
+        return true;
+    }
+
+    /*----- 2. 排序 -----*/
+    int len = __nms_sort_len(total);
+    __nms_bitonic_sort(score, dst_rows + 1, 4, tmp, len);
+
+    /*----- 3. 按 score 降序依次抑制 -----*/
+    NMS_DT* alive    = tmp;
+    NMS_DT* inter_x1 = tmp + cap;
+    NMS_DT* inter_y1 = inter_x1 + cap;
+    NMS_DT* inter_x2 = inter_y1 + cap;
+    NMS_DT* inter_y2 = inter_x2 + cap;
+    NMS_DT* penalty  = nms_mode == NMS_DIOU ? inter_y2 + cap : 0;
+    __nramset(alive, len, 1);
+    __nramset(flag, len, 0);
+    int total_pad = NMS_UP(total, NMS_SIZE);
+    int keep_count = 0;
+    for (int i = 0; i < total && keep_count < keepNum; i++) {
+        if (alive[i] == (NMS_DT)0) {
+            continue;
+        }
+        if (score[i] <= thresh_score) {
+            break;  // 之后的框 score 都不会更大
+        }
+        flag[i] = 1;
+        keep_count++;
+
+        // 只需要与排在 i 之后的框比较, 起点按 NMS_SIZE 向下对齐
+        int start = NMS_DOWN((i + 1), NMS_SIZE);
+        int seg_len = total_pad - start;
+        if (i + 1 >= total) {
+            break;
+        }
+        __nms_overlap(inter_x1, x1 + start, y1 + start, x2 + start, y2 + start,
+                      x1[i], y1[i], x2[i], y2[i], inter_y1, inter_x2, inter_y2, penalty,
+                      fbuf, float_iou, nms_mode, thresh_iou, (NMS_DT)0, w_pad, h_pad,
+                      seg_len);
+        __bang_mul(alive + start, alive + start, inter_x1, seg_len);
+    }
+    if (keep_count == 0) {
+        return true;
+    }
+
+    /*----- 4. 存储 -----*/
+    mluMemcpyDirection_t store_dir = NRAM2GDRAM;
+    if (dst == NRAM) {
+        store_dir = NRAM2NRAM;
+    } else if (dst == SRAM) {
+        store_dir = NRAM2SRAM;
+    }
+    NMS_DT* save = tmp + cap;   // 5 行, score---, x1---, y1---, x2---, y2---
+    for (int r = 0; r < 5; r++) {
+        __bang_collect(save + r * cap, dst_rows[r], flag, total_pad);
+    }
+    // 与 nms_detection 一致: dst 为 NRAM 时从第 output_box_num 个位置接着写,
+    // 否则从 output_data 开始写, 由调用者传入已偏移的地址
+    int out_offset = dst == NRAM ? output_box_num : 0;
+    NMS_DT* out = output_data + (save_method == 0 ? out_offset * 5 : out_offset);
+    if (save_method == 0) {  // score, x1, y1, x2, y2 | score, x1, ...
+        NMS_DT* packed = tmp + 6 * cap;
+        for (int i = 0; i < keep_count; i++) {
+            for (int r = 0; r < 5; r++) {
+                packed[i * 5 + r] = save[r * cap + i];
+            }
+        }
+        __memcpy(out, packed, keep_count * 5 * sizeof(NMS_DT), store_dir);
+    } else {  // score---, x1---, y1---, x2---, y2---
+        // 与 nms_detection 一致: dst 为 NRAM 时行间距为 input_box_num
+        int row_stride = dst == NRAM ? input_box_num : output_stride;
+        __memcpy(out, save, keep_count * sizeof(NMS_DT), store_dir,
+                 row_stride * sizeof(NMS_DT), cap * sizeof(NMS_DT), 4);
+    }
+    output_box_num += keep_count;
+    return true;
+}
+
+/*!
+ * 按候选框数量选择 NMS 实现: 输入框较多且为单核拆分时先尝试排序模式,
+ * 超过阈值的框放不进 NRAM 或为 Soft-NMS 时退回逐个求最大值的 nms_detection.
+ * 参数与 nms_detection 相同. 走排序模式时 score 相等的框先后不确定, 见 nms_detection_sorted.
+ */
+template <typename NMS_DT>
+__mlu_func__ void nms_detection_auto(int &output_box_num,
+                                     NMS_DT* output_data,
+                                     Addr dst,
+                                     NMS_DT* input_data_score,
+                                     NMS_DT* input_data_box,
+                                     Addr src,
+                                     NMS_DT* buffer,
+                                     int buffer_size,
+                                     NMS_DT* sram,
+                                     SplitMode split_mode,
+                                     int input_box_num,
+                                     int input_stride,
+                                     int output_stride,
+                                     int keepNum,
+                                     NMS_DT thresh_iou,
+                                     NMS_DT thresh_score,
+                                     int save_method,
+                                     NmsMode nms_mode = NMS_HARD,
+                                     NMS_DT sigma = 0.5,
+                                     int float_iou = 0,
+                                     float w_pad = 0,
+                                     float h_pad = 0) {
+    if (split_mode == NMS_BLOCK && input_box_num >= NMS_SORT_MIN_BOX &&
+        nms_detection_sorted(output_box_num, output_data, dst, input_data_score,
+                             input_data_box, src, buffer, buffer_size, input_box_num,
+                             input_stride, output_stride, keepNum, thresh_iou,
+                             thresh_score, save_method, nms_mode, float_iou, w_pad, h_pad)) {
+        return;
+    }
+    nms_detection(output_box_num, output_data, dst, input_data_score, input_data_box,
+                  src, buffer, buffer_size, sram, split_mode, input_box_num,
+                  input_stride, output_stride, keepNum, thresh_iou, thresh_score,
+                  save_method, nms_mode, sigma, float_iou, w_pad, h_pad);
+}
+
+/*====== 多类别批量模式 ======*/
+
+#define NMS_MC_BUFFER_NUM 20     // 多类别模式需要的长度为 cap 的 NRAM 向量个数
+#ifndef NMS_MC_USE_OFFSET
+#define NMS_MC_USE_OFFSET(DT) (sizeof(DT) == 4)  // 是否用坐标偏移隔离类别
+#endif
+
+/*!
+ * 多类别批量 NMS: class_num 行 score 共享同一组 x1/y1/x2/y2, 一次调用完成所有类别,
+ * 按类别顺序输出, 类内 score 降序. score 各不相同时结果与逐类调用 nms_detection 相同,
+ * 类内 score 相等的框先后不确定 (双调排序不稳定).
+ *   1. 每个类别先求 score 最大值, 不超过 thresh_score 的类别直接跳过;
+ *   2. 其余类别中超过阈值的框压缩到一起, 附带类别序号, 只做一次双调排序;
+ *   3. 坐标偏移: 第 r 个非空类别的 x1/x2 加上 r * span (span 大于所有框的横向跨度),
+ *      不同类别的框不会相交, 一遍抑制即可完成所有类别.
+ *      half 的精度承受不了偏移, 改为用类别序号相等的掩码屏蔽跨类别的抑制.
+ *
+ * 输入必须在 NRAM 上, input_box_num 按 NMS_SIZE 对齐, score 第 c 行位于
+ * input_data_score + c * input_stride. 输出 6 行: class---, score---, x1---, y1---,
+ * x2---, y2---, 行间距为 output_stride, 类别号为 class_start + c.
+ * keepNum 为每个类别保留框数的上限, max_output_num 为所有类别保留框数之和的上限.
+ * 超过阈值的框放不进 buffer、保留框数超过 max_output_num 或为 Soft-NMS 时
+ * 不写输出并返回 false.
+ */
+template <typename NMS_DT>
+__mlu_func__ bool nms_detection_multiclass(int &output_box_num,
+                                           NMS_DT* output_data,
+                                           Addr dst,
+                                           NMS_DT* input_data_score,
+                                           NMS_DT* input_data_box,
+                                           NMS_DT* buffer,
+                                           int buffer_size,
+                                           int class_num,
+                                           int class_start,
+                                           int input_box_num,
+                                           int input_stride,
+                                           int output_stride,
+                                           int keepNum,
+                                           NMS_DT thresh_iou,
+                                           NMS_DT thresh_score,
+                                           NmsMode nms_mode = NMS_HARD,
+                                           int float_iou = 0,
+                                           float w_pad = 0,
+                                           float h_pad = 0,
+                                           int max_output_num = 0x7fffffff) {
+    if (nms_mode == NMS_SOFT_LINEAR || nms_mode == NMS_SOFT_GAUSSIAN) {
+        return false;
+    }
+    // 前两个向量与输入等长, 用于筛选; 之后是每个非空类别的类别号与保留计数
+    NMS_DT* mask       = buffer;
+    NMS_DT* thresh_vec = mask + input_box_num;
+    int* class_list    = (int*)(thresh_vec + input_box_num);
+    int* class_keep    = class_list + class_num;
+    int head_size = 2 * input_box_num * sizeof(NMS_DT) +
+                    NMS_UP(2 * class_num * (int)sizeof(int), NMS_SIZE * (int)sizeof(NMS_DT));
+    float_iou = float_iou && sizeof(NMS_DT) == 2;
+    int float_count = float_iou * NMS_FLOAT_BUFFER_NUM * 2;
+    int cap = __nms_sort_capacity<NMS_DT>(buffer_size - head_size,
+                                          NMS_MC_BUFFER_NUM + float_count);
+    if (cap == 0) {
+        return false;
+    }
+    NMS_DT* score = buffer + head_size / sizeof(NMS_DT);
+    NMS_DT* cls   = score + cap;
+    NMS_DT* x1    = cls + cap;
+    NMS_DT* y1    = x1 + cap;
+    NMS_DT* x2    = y1 + cap;
+    NMS_DT* y2    = x2 + cap;
+    NMS_DT* ox1   = y2 + cap;             // 偏移后的 x1 / x2
+    NMS_DT* ox2   = ox1 + cap;
+    NMS_DT* tmp   = ox2 + cap;            // 10 个向量
+    NMS_DT* flag  = tmp + 10 * cap;
+    float*  fbuf  = (float *)(flag + cap);
+    NMS_DT* count = flag + cap + float_count * cap;
+    NMS_DT* rows[6] = {score, cls, x1, y1, x2, y2};
+
+    /*----- 1. 逐类别预筛并压缩 -----*/
+    __nramset(thresh_vec, input_box_num, thresh_score);
+    __nramset(score, cap, thresh_score);
+    __nramset(cls, 5 * cap, 0);
+    int total = 0;
+    int class_count = 0;
+    for (int c = 0; c < class_num; c++) {
+        NMS_DT* row = input_data_score + c * input_stride;
+        __bang_max(mask, row, input_box_num);
+        if (mask[0] <= thresh_score) {
+            continue;  // 该类别没有超过阈值的框
+        }
+        __bang_gt(mask, row, thresh_vec, input_box_num);
+        __bang_count((uint32_t*)count, mask, input_box_num);
+        int seg_count = ((uint32_t*)count)[0];
+        if (total + seg_count > cap) {
+            return false;
+        }
+        for (int r = 0; r < 6; r++) {
+            if (r == 1) {
+                continue;
+            }
+            NMS_DT* src_row = r == 0 ? row : input_data_box + (r - 2) * input_stride;
+            __bang_collect(tmp, src_row, mask, input_box_num);
+            __memcpy(rows[r] + total, tmp, seg_count * sizeof(NMS_DT), NRAM2NRAM);
+        }
+        for (int i = 0; i < seg_count; i++) {
+            cls[total + i] = class_count;
+        }
+        class_list[class_count] = c;
+        class_keep[class_count] = 0;
+        class_count++;
+        total += seg_count;
+    }
+    if (total == 0) {
+        return true;
+    }
+
+    /*----- 2. 所有类别一起排序 -----*/
+    int len = __nms_sort_len(total);
+    __nms_bitonic_sort(score, rows + 1, 5, tmp, len);
+
+    /*----- 3. 类别间坐标偏移 -----*/
+    bool use_offset = NMS_MC_USE_OFFSET(NMS_DT);
+    if (use_offset) {
+        __bang_max(count, x2, len);
+        NMS_DT hi = count[0];
+        __bang_mul_const(ox1, x1, -1, len);
+        __bang_max(count, ox1, len);
+        NMS_DT lo = -count[0];
+        NMS_DT span = hi - lo + 1;
+        __bang_mul_const(ox2, cls, span, len);
+        __bang_add(ox1, x1, ox2, len);
+        __bang_add(ox2, x2, ox2, len);
+    } else {
+        ox1 = x1;
+        ox2 = x2;
+    }
+
+    /*----- 4. 一遍抑制所有类别 -----*/
+    NMS_DT* alive = tmp;
+    NMS_DT* keep  = tmp + cap;
+    NMS_DT* t0    = tmp + 2 * cap;
+    NMS_DT* t1    = tmp + 3 * cap;
+    NMS_DT* t2    = tmp + 4 * cap;
+    NMS_DT* penalty = nms_mode == NMS_DIOU ? tmp + 5 * cap : 0;
+    __nramset(alive, len, 1);
+    __nramset(flag, len, 0);
+    int total_pad = NMS_UP(total, NMS_SIZE);
+    for (int i = 0; i < total; i++) {
+        if (alive[i] == (NMS_DT)0) {
+            continue;
+        }
+        if (score[i] <= thresh_score) {
+            break;
+        }
+        int rank = (int)cls[i];
+        if (class_keep[rank] >= keepNum) {
+            continue;  // 与逐类处理一致: 该类别已达上限, 不再保留也不再抑制
+        }
+        flag[i] = 1;
+        class_keep[rank]++;
+        if (i + 1 >= total) {
+            break;
+        }
+        int start = NMS_DOWN((i + 1), NMS_SIZE);
+        int seg_len = total_pad - start;
+        __nms_overlap(keep, ox1 + start, y1 + start, ox2 + start, y2 + start,
+                      ox1[i], y1[i], ox2[i], y2[i], t0, t1, t2, penalty, fbuf, float_iou,
+                      nms_mode, thresh_iou, (NMS_DT)0, w_pad, h_pad, seg_len);
+        if (!use_offset) {
+            // 类别不同的框一律保留: keep = max(keep, (cls - rank)^2 > 0)
+            __nramset(t0, seg_len, cls[i]);
+            __bang_sub(t0, cls + start, t0, seg_len);
+            __bang_mul(t0, t0, t0, seg_len);
+            __nramset(t1, seg_len, 0);
+            __bang_gt(t0, t0, t1, seg_len);
+            __svmax_relu(keep, keep, t0, seg_len);
+        }
+        __bang_mul(alive + start, alive + start, keep, seg_len);
+    }
+
+    int keep_total = 0;
+    for (int rank = 0; rank < class_count; rank++) {
+        keep_total += class_keep[rank];
+    }
+    if (keep_total > max_output_num) {
+        return false;
+    }
+
+    /*----- 5. 按类别顺序存储 -----*/
+    mluMemcpyDirection_t store_dir = NRAM2GDRAM;
+    if (dst == NRAM) {
+        store_dir = NRAM2NRAM;
+    } else if (dst == SRAM) {
+        store_dir = NRAM2SRAM;
+    }
+    NMS_DT* save  = tmp;                  // 6 行
+    NMS_DT* ne    = tmp + 6 * cap;
+    NMS_DT* zeros = tmp + 7 * cap;
+    __nramset(zeros, total_pad, 0);
+    for (int rank = 0; rank < class_count; rank++) {
+        int keep_num = class_keep[rank];
+        if (keep_num == 0) {
+            continue;
+        }
+        // 当前类别中被保留的框: flag * (cls == rank)
+        __nramset(ne, total_pad, (NMS_DT)rank);
+        __bang_sub(ne, cls, ne, total_pad);
+        __bang_mul(ne, ne, ne, total_pad);
+        __bang_gt(ne, ne, zeros, total_pad);
+        __bang_mul(ne, ne, flag, total_pad);
+        __bang_sub(ne, flag, ne, total_pad);
+
+        __nramset(save + cap, cap, (NMS_DT)(class_start + class_list[rank]));
+        __bang_collect(save, score, ne, total_pad);
+        for (int r = 2; r < 6; r++) {
+            __bang_collect(save + r * cap, rows[r], ne, total_pad);
+        }
+        // score 行在前, 类别行在后, 调整为 class, score, x1, y1, x2, y2
+        __memcpy(output_data + output_box_num, save + cap, keep_num * sizeof(NMS_DT),
+                 store_dir);
+        __memcpy(output_data + output_box_num + output_stride, save,
+                 keep_num * sizeof(NMS_DT), store_dir);
+        __memcpy(output_data + output_box_num + 2 * output_stride, save + 2 * cap,
+                 keep_num * sizeof(NMS_DT), store_dir, output_stride * sizeof(NMS_DT),
+                 cap * sizeof(NMS_DT), 3);
+        output_box_num += keep_num;
+    }
+    return true;
+}
 
-#endif  // _NMS_DETECTION_H_
\ No newline at end of file
+#endif  // _NMS_DETECTION_H_
@@ -0,0 +1,197 @@
+/*************************************************************************
+ * Copyright (C) [2020] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+#include "cnplugin.h"
+#include "plugin_nms_kernel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+cnmlStatus_t cnmlCreatePluginNmsOpParam(
+    cnmlPluginNmsOpParam_t *param,
+    int batchNum,
+    int boxNum,
+    int maxOutputSize,
+    float iouThreshold,
+    float scoreThreshold,
+    cnmlCoreVersion_t core_version) {
+  if (param == nullptr || batchNum < 1 || boxNum < 1 || maxOutputSize < 1 ||
+      maxOutputSize > CNML_NMS_MAX_OUTPUT_SIZE) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  *param = new cnmlPluginNmsOpParam();
+  (*param)->batchNum = batchNum;
+  (*param)->boxNum = boxNum;
+  (*param)->maxOutputSize = maxOutputSize;
+  (*param)->iouThreshold = iouThreshold;
+  (*param)->scoreThreshold = scoreThreshold;
+  (*param)->core_version = core_version;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlDestroyPluginNmsOpParam(
+    cnmlPluginNmsOpParam_t *param) {
+  if (param == nullptr || *param == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  delete (*param);
+  *param = nullptr;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlCreatePluginNmsOp(
+    cnmlBaseOp_t *op,
+    cnmlPluginNmsOpParam_t param,
+    cnmlTensor_t *nms_input_tensors,
+    cnmlTensor_t *nms_output_tensors) {
+  if (op == nullptr || param == nullptr || nms_input_tensors == nullptr ||
+      nms_output_tensors == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  int batchNum = param->batchNum;
+  int boxNum = param->boxNum;
+  int boxStride = (boxNum + 63) / 64 * 64;
+  int maxOutputSize = param->maxOutputSize;
+
+  uint16_t iou_threshold_half;
+  uint16_t score_threshold_half;
+  cnrtConvertFloatToHalf(&iou_threshold_half, param->iouThreshold);
+  cnrtConvertFloatToHalf(&score_threshold_half, param->scoreThreshold);
+
+  cnrtKernelParamsBuffer_t params;
+  cnrtGetKernelParamsBuffer(&params);
+  cnrtKernelParamsBufferMarkInput(params);   // boxes
+  cnrtKernelParamsBufferMarkInput(params);   // scores
+  cnrtKernelParamsBufferMarkOutput(params);  // detections
+  cnrtKernelParamsBufferMarkOutput(params);  // valid_outputs
+  cnrtKernelParamsBufferMarkOutput(params);  // buffer
+  cnrtKernelParamsBufferAddParam(params, &batchNum, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &boxNum, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &boxStride, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &maxOutputSize, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &iou_threshold_half, sizeof(uint16_t));
+  cnrtKernelParamsBufferAddParam(params, &score_threshold_half, sizeof(uint16_t));
+
+  void **InterfacePtr = reinterpret_cast<void **>(&NmsOpKernel);
+  cnmlCreatePluginOp(op,
+                     "nms",
+                     InterfacePtr,
+                     params,
+                     nms_input_tensors,
+                     2,
+                     nms_output_tensors,
+                     3,
+                     nullptr,
+                     0);
+
+  cnrtDestroyKernelParamsBuffer(params);
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlComputePluginNmsOpForward(
+    cnmlBaseOp_t op,
+    void *inputs[],
+    int num_inputs,
+    void *outputs[],
+    int num_outputs,
+    cnrtInvokeFuncParam_t *compute_forw_param,
+    cnrtQueue_t queue) {
+  cnmlComputePluginOpForward_V3(op,
+                                inputs,
+                                num_inputs,
+                                outputs,
+                                num_outputs,
+                                compute_forw_param,
+                                queue);
+  return CNML_STATUS_SUCCESS;
+}
+
+namespace {
+
+// Keep test of nms_detection with NMS_HARD_GT: area_I <= area_U * thresh,
+// so only boxes with IoU > thresh are dropped, as in NonMaxSuppressionV3.
+// Coordinates are [a1, b1, a2, b2] in either corner order.
+inline bool nmsCpuKeep(const float *m, const float *n, float iouThreshold) {
+  float inter_a = std::max(std::min(m[2], n[2]) - std::max(m[0], n[0]), 0.0f);
+  float inter_b = std::max(std::min(m[3], n[3]) - std::max(m[1], n[1]), 0.0f);
+  float area_i = inter_a * inter_b;
+  float area_u = (n[2] - n[0]) * (n[3] - n[1]) +
+                 (m[2] - m[0]) * (m[3] - m[1]) - area_i;
+  return area_i <= area_u * iouThreshold;
+}
+
+}  // namespace
+
+cnmlStatus_t cnmlCpuComputePluginNmsOpForward(
+    cnmlPluginNmsOpParam_t param,
+    const float *boxes,
+    const float *scores,
+    float *detections,
+    int *valid_outputs) {
+  if (param == nullptr || boxes == nullptr || scores == nullptr ||
+      detections == nullptr || valid_outputs == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  const int boxNum = param->boxNum;
+  const int maxOutputSize = param->maxOutputSize;
+  std::vector<int> order;
+  std::vector<int> kept;
+  order.reserve(boxNum);
+  kept.reserve(maxOutputSize);
+  for (int batch = 0; batch < param->batchNum; batch++) {
+    const float *box = boxes + (size_t)batch * boxNum * 4;
+    const float *score = scores + (size_t)batch * boxNum;
+    float *out = detections + (size_t)batch * maxOutputSize * 5;
+
+    // candidates in descending score order, ties by index; the MLU may
+    // order equal scores differently
+    order.clear();
+    for (int i = 0; i < boxNum; i++) {
+      if (score[i] > param->scoreThreshold) {
+        order.push_back(i);
+      }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [score](int a, int b) { return score[a] > score[b]; });
+
+    kept.clear();
+    for (size_t k = 0; k < order.size() && (int)kept.size() < maxOutputSize; k++) {
+      const float *n = box + order[k] * 4;
+      bool keep = true;
+      for (size_t j = 0; j < kept.size() && keep; j++) {
+        keep = nmsCpuKeep(box + kept[j] * 4, n, param->iouThreshold);
+      }
+      if (keep) {
+        kept.push_back(order[k]);
+      }
+    }
+
+    memset(out, 0, sizeof(float) * maxOutputSize * 5);
+    for (size_t j = 0; j < kept.size(); j++) {
+      out[j * 5] = score[kept[j]];
+      memcpy(out + j * 5 + 1, box + kept[j] * 4, sizeof(float) * 4);
+    }
+    valid_outputs[batch] = (int)kept.size();
+  }
+  return CNML_STATUS_SUCCESS;
+}
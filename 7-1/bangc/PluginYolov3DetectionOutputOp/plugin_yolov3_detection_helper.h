@@ -33,6 +33,9 @@
 #endif
 #define C_PAD_SIZE 64 // PAD_SIZE because of c_inst constrain
 #define LINESIZE 256
+// Default scratch sizes. The kernel takes the actual values as runtime params
+// (temp_dst_stride / output_buffer_size), see
+// cnmlSetPluginYolov3DetectionOutputOpBufferSize().
 #define TEMP_DST_STRIDE 2048
 #define OUTPUT_BUFFER_SIZE 256
 #define LINESIZE 256
@@ -343,12 +346,15 @@ __mlu_func__ int DecodeAllBBoxesFullW(
   int num_mask_groups,
   int netw,
   int neth,
-  mluMemcpyDirection_t dir) {
+  mluMemcpyDirection_t dir,
+  int dstStride,
+  int capacity,
+  int &overflow) {
   int boxCount  = 0;
   int segCount  = 0;
   int segSize   = limit * w * num_entries * num_mask_groups;
   int dataSize  = num_entries * sizeof(T);
-  int dstStride = entryPad * sizeof(T);
+  int loadStride = entryPad * sizeof(T);
   int srcStride = num_entries * num_mask_groups * sizeof(T);
   int segment = limit * w - 1;
   for (int segIdx = 0; segIdx < segNum; segIdx++) {
@@ -356,7 +362,7 @@ __mlu_func__ int DecodeAllBBoxesFullW(
              src_gdram + segIdx * segSize,
              dataSize,
              GDRAM2NRAM,
-             dstStride,
+             loadStride,
              srcStride,
              segment);
 
@@ -393,10 +399,8 @@ __mlu_func__ int DecodeAllBBoxesFullW(
     __bang_cycle_add(offset_h, offset_h, temp + 64, dealNum, C_PAD_SIZE);
 
     // w & h
-    T biasW = biases[2 * num_mask_groups * inputIdx +
-                     2 * anchorIdx + 0] / netw;
-    T biasH = biases[2 * num_mask_groups * inputIdx +
-                     2 * anchorIdx + 1] / neth;
+    T biasW = biases[2 * anchorIdx + 0] / netw;
+    T biasH = biases[2 * anchorIdx + 1] / neth;
     __bang_active_exp(srcTrans + 2 * dealNum,
                       srcTrans + 2 * dealNum,
                       2 * dealNum);
@@ -417,18 +421,42 @@ __mlu_func__ int DecodeAllBBoxesFullW(
                      srcTrans + 4 * dealNum,
                      (num_entries - 5) * dealNum,
                      dealNum);
-    __bang_write_zero(src, dealNum * num_entries);
+    // A box can only become an NMS candidate if one of its class scores
+    // obj * prob passes the threshold, so filter on that instead of obj alone
+    // and keep those boxes only. Count the passing classes of each box with a
+    // tree of row additions; a count of 1 or more is above any threshold < 1,
+    // a count of 0 never is.
+    __bang_cycle_gt(src + dealNum,
+                    srcTrans + 5 * dealNum,
+                    temp,
+                    (num_entries - 5) * dealNum,
+                    C_PAD_SIZE);
+    int rowNum = num_entries - 5;
+    while (rowNum > 1) {
+      int halfNum = rowNum / 2;
+      __bang_add(src + dealNum,
+                 src + dealNum,
+                 src + dealNum + (rowNum - halfNum) * dealNum,
+                 halfNum * dealNum);
+      rowNum -= halfNum;
+    }
     __bang_cycle_gt(src,
-                    srcTrans + 4 * dealNum,
+                    src + dealNum,
                     temp,
                     dealNum,
                     C_PAD_SIZE);
+    __bang_write_zero(src + dealNum, dealNum * (num_entries - 1));
     __bang_cycle_add(src + dealNum, src + dealNum, src, dealNum * (num_entries - 1), dealNum);
     __bang_count((uint32_t*)temp + 16 * sizeof(T), src, dealNum);
     segCount = ((uint32_t*)temp)[16* sizeof(T)];
     // PRINTF_SCALAR("segCount: %d\n", segCount);
     // PRINTF_SCALAR("boxCount: %d\n", boxCount);
-    if (segCount > 0) {
+    // keep the first "capacity" boxes and flag the rest as overflow
+    int storeCount = min(segCount, capacity - boxCount);
+    if (storeCount < segCount) {
+      overflow = 1;
+    }
+    if (storeCount > 0) {
       __bang_collect(src, srcTrans, src, dealNum * num_entries);
       // PRINTF_VECTOR("----- obj -----", "%hf ", srcTrans + 4 * segCount, segCount);
       // PRINTF_VECTOR("----- X -----", "%hf ", srcTrans + 5 * segCount, segCount);
@@ -437,12 +465,12 @@ __mlu_func__ int DecodeAllBBoxesFullW(
       // PRINTF_VECTOR("----- H -----", "%hf ", srcTrans + 3 * segCount, segCount);
       __memcpy(dst + boxCount,
                src,
-               segCount * sizeof(T),
+               storeCount * sizeof(T),
                dir,
-               TEMP_DST_STRIDE * sizeof(T),
+               dstStride * sizeof(T),
                segCount * sizeof(T),
                num_entries - 1);
-      boxCount += segCount;
+      boxCount += storeCount;
     }
   }
   return boxCount;
@@ -472,12 +500,15 @@ __mlu_func__ int DecodeAllBBoxesPartW(
   int num_mask_groups,
   int netw,
   int neth,
-  mluMemcpyDirection_t dir) {
+  mluMemcpyDirection_t dir,
+  int dstStride,
+  int capacity,
+  int &overflow) {
   int boxCount  = 0;
   int segCount  = 0;
   int segSize   = limit * num_entries * num_mask_groups;
   int dataSize  = num_entries * sizeof(T);
-  int dstStride = entryPad * sizeof(T);
+  int loadStride = entryPad * sizeof(T);
   int srcStride = num_entries * num_mask_groups * sizeof(T);
   int segment = limit - 1;
   for (int segIdx = 0; segIdx < segNum; segIdx++) {
@@ -485,7 +516,7 @@ __mlu_func__ int DecodeAllBBoxesPartW(
              src_gdram + segIdx * segSize,
              dataSize,
              GDRAM2NRAM,
-             dstStride,
+             loadStride,
              srcStride,
              segment);
 
@@ -527,10 +558,8 @@ __mlu_func__ int DecodeAllBBoxesPartW(
     __bang_cycle_add(offset_w, offset_w, temp + 64, dealNum, C_PAD_SIZE);
 
     // w & h
-    T biasW = biases[2 * num_mask_groups * inputIdx +
-                     2 * anchorIdx + 0] / netw;
-    T biasH = biases[2 * num_mask_groups * inputIdx +
-                     2 * anchorIdx + 1] / neth;
+    T biasW = biases[2 * anchorIdx + 0] / netw;
+    T biasH = biases[2 * anchorIdx + 1] / neth;
     __bang_active_exp(srcTrans + 2 * dealNum,
                       srcTrans + 2 * dealNum,
                       2 * dealNum);
@@ -551,18 +580,42 @@ __mlu_func__ int DecodeAllBBoxesPartW(
                      srcTrans + 4 * dealNum,
                      (num_entries - 5) * dealNum,
                      dealNum);
-    __bang_write_zero(src, dealNum * num_entries);
+    // A box can only become an NMS candidate if one of its class scores
+    // obj * prob passes the threshold, so filter on that instead of obj alone
+    // and keep those boxes only. Count the passing classes of each box with a
+    // tree of row additions; a count of 1 or more is above any threshold < 1,
+    // a count of 0 never is.
+    __bang_cycle_gt(src + dealNum,
+                    srcTrans + 5 * dealNum,
+                    temp,
+                    (num_entries - 5) * dealNum,
+                    C_PAD_SIZE);
+    int rowNum = num_entries - 5;
+    while (rowNum > 1) {
+      int halfNum = rowNum / 2;
+      __bang_add(src + dealNum,
+                 src + dealNum,
+                 src + dealNum + (rowNum - halfNum) * dealNum,
+                 halfNum * dealNum);
+      rowNum -= halfNum;
+    }
     __bang_cycle_gt(src,
-                    srcTrans + 4 * dealNum,
+                    src + dealNum,
                     temp,
                     dealNum,
                     C_PAD_SIZE);
+    __bang_write_zero(src + dealNum, dealNum * (num_entries - 1));
     __bang_cycle_add(src + dealNum, src + dealNum, src, dealNum * (num_entries - 1), dealNum);
     __bang_count((uint32_t*)temp + 16 * sizeof(T), src, dealNum);
     segCount = ((uint32_t*)temp)[16* sizeof(T)];
     PRINTF_SCALAR("segCount: %d\n", segCount);
     PRINTF_SCALAR("boxCount: %d\n", boxCount);
-    if (segCount > 0) {
+    // keep the first "capacity" boxes and flag the rest as overflow
+    int storeCount = min(segCount, capacity - boxCount);
+    if (storeCount < segCount) {
+      overflow = 1;
+    }
+    if (storeCount > 0) {
       __bang_collect(src, srcTrans, src, dealNum * num_entries);
       // PRINTF_VECTOR("----- obj -----", "%hf ", srcTrans + 4 * segCount, segCount);
       // PRINTF_VECTOR("----- X -----", "%hf ", srcTrans + 5 * segCount, segCount);
@@ -571,12 +624,12 @@ __mlu_func__ int DecodeAllBBoxesPartW(
       // PRINTF_VECTOR("----- H -----", "%hf ", srcTrans + 3 * segCount, segCount);
       __memcpy(dst + boxCount,
                src,
-               segCount * sizeof(T),
+               storeCount * sizeof(T),
                dir,
-               TEMP_DST_STRIDE * sizeof(T),
+               dstStride * sizeof(T),
                segCount * sizeof(T),
                num_entries - 1);
-      boxCount += segCount;
+      boxCount += storeCount;
     }
   }
   return boxCount;
@@ -23,54 +23,51 @@
 #ifndef __YOLOV3_KERNEL_H__
 #define __YOLOV3_KERNEL_H__
 
+// All kernels take the same params. The _416c80 / _608c80 variants are
+// built from the same source with the shapes of YOLOv3 at 416x416 / 608x608
+// and 80 classes fixed at compile time, see
+// plugin_yolov3_detection_output_kernel_416c80.mlu.
+#define YOLOV3_KERNEL_DECL(name)         \
+  void name(uint16_t *predicts,          \
+            void *input0,                \
+            void *input1,                \
+            void *input2,                \
+            void *input3,                \
+            void *input4,                \
+            void *input5,                \
+            void *input6,                \
+            uint16_t *thresh,            \
+            void *buffer_gdram,          \
+            int *profile,                \
+            int *desc,                   \
+            uint16_t *biases,            \
+            int num_inputs,              \
+            int num_classes,             \
+            int batchNum,                \
+            int num_mask_groups,         \
+            int num_max_boxes,           \
+            int PAD_SIZE,                \
+            int netw,                    \
+            int neth,                    \
+            uint16_t confidence_thresh,  \
+            uint16_t nms_thresh,         \
+            int temp_dst_stride,         \
+            int output_buffer_size,      \
+            int output_format,           \
+            int sort_output,             \
+            int nms_mode,                \
+            uint16_t nms_sigma,          \
+            int float_iou)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
-  void yolov3Kernel_MLU270(uint16_t *predicts,
-                           void *input0,
-                           void *input1,
-                           void *input2,
-                           void *input3,
-                           void *input4,
-                           void *input5,
-                           void *input6,
-                           void *buffer_gdram,
-                           int *h_arr,
-                           int *w_arr,
-                           uint16_t *biases,
-                           int num_inputs,
-                           int num_classes,
-                           int batchNum,
-                           int num_mask_groups,
-                           int num_max_boxes,
-                           int PAD_SIZE,
-                           int netw,
-                           int neth,
-                           uint16_t confidence_thresh,
-                           uint16_t nms_thresh);
-
-  void yolov3Kernel_MLU220(uint16_t *predicts,
-                           void *input0,
-                           void *input1,
-                           void *input2,
-                           void *input3,
-                           void *input4,
-                           void *input5,
-                           void *input6,
-                           void *buffer_gdram,
-                           int *h_arr,
-                           int *w_arr,
-                           uint16_t *biases,
-                           int num_inputs,
-                           int num_classes,
-                           int batchNum,
-                           int num_mask_groups,
-                           int num_max_boxes,
-                           int PAD_SIZE,
-                           int netw,
-                           int neth,
-                           uint16_t confidence_thresh,
-                           uint16_t nms_thresh);
+  YOLOV3_KERNEL_DECL(yolov3Kernel_MLU270);
+  YOLOV3_KERNEL_DECL(yolov3Kernel_MLU220);
+  YOLOV3_KERNEL_DECL(yolov3Kernel_416c80_MLU270);
+  YOLOV3_KERNEL_DECL(yolov3Kernel_416c80_MLU220);
+  YOLOV3_KERNEL_DECL(yolov3Kernel_608c80_MLU270);
+  YOLOV3_KERNEL_DECL(yolov3Kernel_608c80_MLU220);
 
 #ifdef __cplusplus
 }
@@ -23,6 +23,125 @@
 #include "cnplugin.h"
 #include "plugin_yolov3_detection_output_kernel_v1.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Static tensors of the descriptor table and the half biases. They only
+// depend on the heads, the anchors and the core version, so params with the
+// same ones (e.g. the same model loaded by several sessions) share a single
+// refcounted copy instead of creating and binding their own.
+struct Yolov3ConstData {
+  std::vector<int> key;
+  cnmlTensor_t cnml_static_tensors[2];
+  cnmlCpuTensor_t cpu_static_tensors[2];
+  int desc[64];
+  int16_t biases[64];
+  int refCount;
+};
+
+std::mutex yolov3ConstMutex;
+std::map<std::vector<int>, Yolov3ConstData *> yolov3ConstCache;
+
+// Builds the head descriptor table from the per-head shapes and anchor
+// counts of param.
+void yolov3FillDescriptor(cnmlPluginYolov3DetectionOutputOpParam_t param,
+                          int *desc) {
+  int biasOffset = 0;
+  for (int i = 0; i < 64; i++) {
+    desc[i] = 0;
+  }
+  for (int inputId = 0; inputId < param->inputNum; inputId++) {
+    desc[inputId]      = param->inputHs[inputId];
+    desc[16 + inputId] = param->inputWs[inputId];
+    desc[32 + inputId] = param->anchorNums[inputId];
+    desc[48 + inputId] = biasOffset;
+    biasOffset += 2 * param->anchorNums[inputId];
+  }
+}
+
+// Points param at the const data matching its heads and anchors, creating
+// it on first use.
+void yolov3AcquireConstData(cnmlPluginYolov3DetectionOutputOpParam_t param) {
+  std::vector<int> key(1 + 64 + 64);
+  key[0] = param->core_version;
+  yolov3FillDescriptor(param, &key[1]);
+  memcpy(&key[65], param->biases, 64 * sizeof(float));
+
+  std::lock_guard<std::mutex> lock(yolov3ConstMutex);
+  Yolov3ConstData *data = yolov3ConstCache[key];
+  if (data == nullptr) {
+    data = new Yolov3ConstData();
+    data->key = key;
+    data->refCount = 0;
+    memcpy(data->desc, &key[1], 64 * sizeof(int));
+    cnrtCastDataType(param->biases, CNRT_FLOAT32, data->biases,
+                     CNRT_FLOAT16, 64, nullptr);
+    cnmlCreateTensor(&data->cnml_static_tensors[0],  // desc
+                     CNML_CONST, CNML_DATA_INT32, 1, 64, 1, 1);
+    cnmlCreateTensor(&data->cnml_static_tensors[1],  // biases
+                     CNML_CONST, CNML_DATA_FLOAT16, 1, 64, 1, 1);
+    cnmlCreateCpuTensor(&data->cpu_static_tensors[0],  // desc
+                        CNML_CONST, CNML_DATA_INT32, CNML_NHWC, 1, 64, 1, 1);
+    cnmlCreateCpuTensor(&data->cpu_static_tensors[1],  // biases
+                        CNML_CONST, CNML_DATA_FLOAT32, CNML_NHWC, 1, 64, 1, 1);
+    cnmlBindConstData_V2(data->cnml_static_tensors[0], data->desc, false);
+    cnmlBindConstData_V2(data->cnml_static_tensors[1], data->biases, false);
+    yolov3ConstCache[key] = data;
+  }
+  data->refCount++;
+  param->const_data = data;
+  param->cnml_static_tensors = data->cnml_static_tensors;
+  param->cpu_static_tensors = data->cpu_static_tensors;
+  param->desc = data->desc;
+}
+
+// Network size of the specialized kernel matching param, 0 if there is none.
+// The specialized kernels fix YOLOv3 with 80 classes and 3 heads of
+// net/32, net/16, net/8 with 3 anchors each, in this order.
+int yolov3SpecNetSize(cnmlPluginYolov3DetectionOutputOpParam_t param) {
+  int net = param->netw;
+  if ((net != 416 && net != 608) || param->neth != net ||
+      param->classNum != 80 || param->inputNum != 3) {
+    return 0;
+  }
+  for (int inputId = 0; inputId < 3; inputId++) {
+    int hw = net / (32 >> inputId);
+    if (param->inputWs[inputId] != hw || param->inputHs[inputId] != hw ||
+        param->anchorNums[inputId] != 3) {
+      return 0;
+    }
+  }
+  return net;
+}
+
+// Drops the reference of param, the last one destroys the tensors.
+void yolov3ReleaseConstData(cnmlPluginYolov3DetectionOutputOpParam_t param) {
+  Yolov3ConstData *data = (Yolov3ConstData *)param->const_data;
+  if (data == nullptr) return;
+  param->const_data = nullptr;
+  param->cnml_static_tensors = nullptr;
+  param->cpu_static_tensors = nullptr;
+  param->desc = nullptr;
+
+  std::lock_guard<std::mutex> lock(yolov3ConstMutex);
+  if (--data->refCount > 0) return;
+  yolov3ConstCache.erase(data->key);
+  for (int i = 0; i < 2; i++) {
+    cnmlDestroyTensor(&data->cnml_static_tensors[i]);
+    cnmlDestroyCpuTensor(&data->cpu_static_tensors[i]);
+  }
+  delete data;
+}
+
+}  // namespace
+
 cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOpParam(
     cnmlPluginYolov3DetectionOutputOpParam_t *param,
     int batchNum,
@@ -38,59 +157,16 @@ cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOpParam(
     int* inputWs,
     int* inputHs,
     float* biases) {
-  // CHECK_ENFORCE(param, "param shouldn't be nullptr");
-  *param = new cnmlPluginYolov3DetectionOutputOpParam();
-
-  (*param)->cnml_static_tensors
-    = (cnmlTensor_t *)malloc(sizeof(cnmlTensor_t) * 7);
-  (*param)->cpu_static_tensors
-    = (cnmlCpuTensor_t *)malloc(sizeof(cnmlCpuTensor_t) * 7);
-
-  // malloc and create const tensor for inputWs, inputHs, and biases
-  cnmlCreateTensor(
-      &(*param)->cnml_static_tensors[4],  // imageWs
-      CNML_CONST, CNML_DATA_INT32,
-      1, 64, 1, 1);
-
-  cnmlCreateTensor(
-      &(*param)->cnml_static_tensors[5],  // imageHs
-      CNML_CONST, CNML_DATA_INT32,
-      1, 64, 1, 1);
-
-  cnmlCreateTensor(
-      &(*param)->cnml_static_tensors[6],  // biases
-      CNML_CONST, CNML_DATA_FLOAT16,
-      1, 64, 1, 1);
-
-  cnmlCreateCpuTensor(
-      &(*param)->cpu_static_tensors[4],  // imageWs
-      CNML_CONST, CNML_DATA_INT32,
-      CNML_NHWC, 1, 64, 1, 1);
-
-  cnmlCreateCpuTensor(
-      &(*param)->cpu_static_tensors[5],  // imageHs
-      CNML_CONST, CNML_DATA_INT32,
-      CNML_NHWC, 1, 64, 1, 1);
-
-  cnmlCreateCpuTensor(
-      &(*param)->cpu_static_tensors[6],  // biases
-      CNML_CONST, CNML_DATA_FLOAT32,
-      CNML_NHWC, 1, 64, 1, 1);
-
-  // malloc and create const tensor for fake input tensor
-  for (int inputId = 0; inputId < 7 - inputNum; inputId++) {
-    cnmlCreateTensor(
-        &(*param)->cnml_static_tensors[inputId],  // fake inputs
-        CNML_CONST, CNML_DATA_INT32,
-        1, 64, 1, 1);
-  }
-
-  for (int inputId = 0; inputId < 7 - inputNum; inputId++) {
-    cnmlCreateCpuTensor(
-        &(*param)->cpu_static_tensors[inputId],  // fake inputs
-        CNML_CONST, CNML_DATA_INT32,
-        CNML_NHWC, 1, 64, 1, 1);
+  if (param == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
   }
+  // callers may destroy *param unconditionally, never leave it dangling
+  *param = nullptr;
+  if (inputWs == nullptr || inputHs == nullptr || biases == nullptr ||
+      inputNum < 1 || inputNum > 7 || 2 * maskGroupNum * inputNum > 64) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  *param = new cnmlPluginYolov3DetectionOutputOpParam();
 
   // scalar params
   (*param)->batchNum = batchNum;
@@ -103,54 +179,69 @@ cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOpParam(
   (*param)->confidence_thresh = confidence_thresh;
   (*param)->nms_thresh = nms_thresh;
   (*param)->core_version = core_version;
-
-  // bind const data
+  (*param)->cpuThreadNum = 1;
+  (*param)->tempDstStride = 2048;     // TEMP_DST_STRIDE
+  (*param)->outputBufferSize = 256;   // OUTPUT_BUFFER_SIZE
+  (*param)->outputFormat = CNML_YOLOV3_OUTPUT_SLAB;
+  (*param)->sortOutput = 0;
+  (*param)->runtimeThresholds = 0;
+  (*param)->profile = 0;
+  (*param)->nmsMode = CNML_YOLOV3_NMS_HARD;
+  (*param)->nmsSigma = 0.5;
+  (*param)->floatIou = 0;
+
+  // host copies of the heads and anchors, also used by the CPU forward
   (*param)->inputWs = (int *)malloc(sizeof(int) * 64);
   (*param)->inputHs = (int *)malloc(sizeof(int) * 64);
-  (*param)->biases  = (float *)malloc(sizeof(int) * 64);
+  (*param)->anchorNums = (int *)malloc(sizeof(int) * 64);
+  (*param)->biases  = (float *)malloc(sizeof(float) * 64);
 
   for (int inputId = 0; inputId < inputNum; inputId++) {
     (*param)->inputWs[inputId] = inputWs[inputId];
     (*param)->inputHs[inputId] = inputHs[inputId];
+    (*param)->anchorNums[inputId] = maskGroupNum;
+  }
+  for (int biasId = 0; biasId < 64; biasId++) {
+    (*param)->biases[biasId] =
+        biasId < 2 * maskGroupNum * inputNum ? biases[biasId] : 0;
   }
-  for (int biasId = 0; biasId < 2 * maskGroupNum * inputNum; biasId++) {
-    (*param)->biases[biasId] = biases[biasId];
-  }
-
-  //If MluTensor's datatype != CpuTensor's datatype, need to cast data.
-  void *cast_biases = (int16_t*)malloc(sizeof(int16_t)*(1*64*1*1));
-  cnrtCastDataType((*param)->biases, CNRT_FLOAT32, cast_biases, CNRT_FLOAT16, 64, nullptr);
-  (*param)->cast_data.push_back(cast_biases);
-
-  cnmlBindConstData_V2(
-      (*param)->cnml_static_tensors[0],
-      (*param)->inputWs,
-      false);
-  cnmlBindConstData_V2(
-      (*param)->cnml_static_tensors[1],
-      (*param)->inputWs,
-      false);
-  cnmlBindConstData_V2(
-      (*param)->cnml_static_tensors[2],
-      (*param)->inputWs,
-      false);
-  cnmlBindConstData_V2(
-      (*param)->cnml_static_tensors[3],
-      (*param)->inputWs,
-      false);
-  cnmlBindConstData_V2(
-      (*param)->cnml_static_tensors[4],
-      (*param)->inputWs,
-      false);
-  cnmlBindConstData_V2(
-      (*param)->cnml_static_tensors[5],
-      (*param)->inputHs,
-      false);
-  cnmlBindConstData_V2(
-      (*param)->cnml_static_tensors[6],
-      cast_biases,
-      false);
 
+  // static tensors: [0] head descriptor table, [1] biases
+  yolov3AcquireConstData(*param);
+
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpAnchors(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int *anchorNums,
+    float *biases) {
+  if (param == nullptr || anchorNums == nullptr || biases == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  int biasNum = 0;
+  int maxAnchorNum = 0;
+  for (int inputId = 0; inputId < param->inputNum; inputId++) {
+    if (anchorNums[inputId] < 1) {
+      return CNML_STATUS_INVALIDPARAM;
+    }
+    biasNum += 2 * anchorNums[inputId];
+    maxAnchorNum = std::max(maxAnchorNum, anchorNums[inputId]);
+  }
+  if (biasNum > 64) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  for (int inputId = 0; inputId < param->inputNum; inputId++) {
+    param->anchorNums[inputId] = anchorNums[inputId];
+  }
+  for (int biasId = 0; biasId < 64; biasId++) {
+    param->biases[biasId] = biasId < biasNum ? biases[biasId] : 0;
+  }
+  param->maskGroupNum = maxAnchorNum;
+  // the old const data may be shared with other params, switch instead of
+  // updating it in place
+  yolov3ReleaseConstData(param);
+  yolov3AcquireConstData(param);
   return CNML_STATUS_SUCCESS;
 }
 
@@ -159,23 +250,12 @@ cnmlStatus_t cnmlDestroyPluginYolov3DetectionOutputOpParam(
   // CHECK_ENFORCE(param, "param pointer shouldn't be nullptr!");
   // CHECK_ENFORCE(*param, "param is nullptr, maybe double free!");
 
-  // destroy static tensors
-  for (int i = 0; i < 7; i++) {
-    cnmlDestroyTensor(
-        &(*param)->cnml_static_tensors[i]);
-  }
-  for (int i = 0; i < 7; i++) {
-    cnmlDestroyCpuTensor(
-        &(*param)->cpu_static_tensors[i]);
-  }
-  free((*param)->cnml_static_tensors);
-  free((*param)->cpu_static_tensors);
+  // static tensors are destroyed with the last param sharing them
+  yolov3ReleaseConstData(*param);
   free((*param)->inputWs);
   free((*param)->inputHs);
+  free((*param)->anchorNums);
   free((*param)->biases);
-  for (auto ptr : (*param)->cast_data) {
-    free(ptr);
-  }
   delete (*param);
   *param = nullptr;
 
@@ -207,17 +287,25 @@ cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOp(
     = param->nms_thresh;
   cnmlCoreVersion_t core_version
     = param->core_version;
+  int tempDstStride = param->tempDstStride;
+  int outputBufferSize = param->outputBufferSize;
+  int outputFormat = param->outputFormat;
+  int sortOutput = param->sortOutput;
+  int nmsMode = param->nmsMode;
+  int floatIou = param->floatIou;
 
   // convert thresh from float to half
   uint16_t confidence_threshold_half;
   uint16_t nms_threshold_half;
+  uint16_t nms_sigma_half;
   cnrtConvertFloatToHalf(&confidence_threshold_half, confidence_thresh);
   cnrtConvertFloatToHalf(&nms_threshold_half, nms_thresh);
+  cnrtConvertFloatToHalf(&nms_sigma_half, param->nmsSigma);
 
-  // prepare op
-  int input_num = inputNum;
-  int output_num = 2;
-  int static_num = 7;
+  // prepare op, runtime thresholds come as one more input after the heads
+  int input_num = inputNum + (param->runtimeThresholds ? 1 : 0);
+  int output_num = param->profile ? 3 : 2;
+  int static_num = 2;
   cnmlTensor_t *cnml_static_tensors
     = param->cnml_static_tensors;
   cnmlCpuTensor_t *cpu_static_tensors
@@ -232,13 +320,25 @@ cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOp(
     cnrtKernelParamsBufferMarkInput(params); // input tensors
   }
 
+  // the kernel has 7 head slots, missing heads get a null pointer instead of
+  // a fake tensor and are skipped through the descriptor table
+  void *null_input = nullptr;
   for (int count = 0; count < 7 - inputNum; count++) {
-    cnrtKernelParamsBufferMarkStatic(params); // fake input tensors
+    cnrtKernelParamsBufferAddParam(params, &null_input, sizeof(void *));
+  }
+  if (param->runtimeThresholds) {
+    cnrtKernelParamsBufferMarkInput(params); // threshold tensor
+  } else {
+    cnrtKernelParamsBufferAddParam(params, &null_input, sizeof(void *));
   }
 
   cnrtKernelParamsBufferMarkOutput(params); // buffer tensor
-  cnrtKernelParamsBufferMarkStatic(params); // w arr
-  cnrtKernelParamsBufferMarkStatic(params); // h arr
+  if (param->profile) {
+    cnrtKernelParamsBufferMarkOutput(params); // profile tensor
+  } else {
+    cnrtKernelParamsBufferAddParam(params, &null_input, sizeof(void *));
+  }
+  cnrtKernelParamsBufferMarkStatic(params); // head descriptor table
   cnrtKernelParamsBufferMarkStatic(params); // bias data
 
   cnrtKernelParamsBufferAddParam(params, &inputNum, sizeof(int));
@@ -248,23 +348,31 @@ cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOp(
   if (SPI_DISABLED) {
     cnrtKernelParamsBufferAddParam(params, &batchNum, sizeof(int));
   } else {
+    // same order as the tensors marked above: output, heads, thresholds,
+    // buffer, profile
+    int tensor_num = input_num + output_num;
     cnmlTensor_t *mlu_tensors
-      = (cnmlTensor_t *)malloc(sizeof(cnmlTensor_t) * (inputNum + 2));
+      = (cnmlTensor_t *)malloc(sizeof(cnmlTensor_t) * tensor_num);
+    cnmlDimension_t *dimension
+      = (cnmlDimension_t *)malloc(sizeof(cnmlDimension_t) * tensor_num) ;
 
     mlu_tensors[0] = yolov3_output_tensors[0];
-    for (int count = 0; count < inputNum; count++) {
-      mlu_tensors[count + 1] = yolov3_input_tensors[count];
-    }
-    mlu_tensors[inputNum + 1] = yolov3_output_tensors[1];
-
-    cnmlDimension_t *dimension
-      = (cnmlDimension_t *)malloc(sizeof(cnmlDimension_t) * (inputNum + 2)) ;
     dimension[0] = cnmlDimension_t::CNML_DIM_C;
-    for (int count = 0; count < inputNum + 1; count++) {
+    for (int count = 0; count < input_num; count++) {
+      mlu_tensors[count + 1] = yolov3_input_tensors[count];
       dimension[count + 1] = cnmlDimension_t::CNML_DIM_N;
     }
+    if (param->runtimeThresholds) {
+      // [1, 2, 1, 1] thresholds are shared by every batch, mark a unit
+      // dimension so that they are not sliced along N
+      dimension[inputNum + 1] = cnmlDimension_t::CNML_DIM_W;
+    }
+    for (int count = 1; count < output_num; count++) {
+      mlu_tensors[input_num + count] = yolov3_output_tensors[count];
+      dimension[input_num + count] = cnmlDimension_t::CNML_DIM_N;
+    }
     cnmlPluginOpParamsBufferMarkTensorDimension(params, mlu_tensors,
-                    dimension, inputNum + 2);
+                    dimension, tensor_num);
     free(mlu_tensors);
     free(dimension);
   }
@@ -278,15 +386,35 @@ cnmlStatus_t cnmlCreatePluginYolov3DetectionOutputOp(
   cnrtKernelParamsBufferAddParam(params, &confidence_threshold_half,
                                  sizeof(uint16_t));
   cnrtKernelParamsBufferAddParam(params, &nms_threshold_half, sizeof(uint16_t));
-
-  // create Plugin op
+  cnrtKernelParamsBufferAddParam(params, &tempDstStride, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &outputBufferSize, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &outputFormat, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &sortOutput, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &nmsMode, sizeof(int));
+  cnrtKernelParamsBufferAddParam(params, &nms_sigma_half, sizeof(uint16_t));
+  cnrtKernelParamsBufferAddParam(params, &floatIou, sizeof(int));
+
+  // create Plugin op, common deployments get a kernel built for their shapes
   void **InterfacePtr;
+  int specNetSize = yolov3SpecNetSize(param);
   switch (core_version){
     case CNML_MLU220:
-      InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_MLU220);
+      if (specNetSize == 416) {
+        InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_416c80_MLU220);
+      } else if (specNetSize == 608) {
+        InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_608c80_MLU220);
+      } else {
+        InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_MLU220);
+      }
       break;
     default:
-      InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_MLU270);
+      if (specNetSize == 416) {
+        InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_416c80_MLU270);
+      } else if (specNetSize == 608) {
+        InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_608c80_MLU270);
+      } else {
+        InterfacePtr = reinterpret_cast<void **>(&yolov3Kernel_MLU270);
+      }
       break;
   }
   cnmlCreatePluginOp(op,
@@ -323,327 +451,553 @@ cnmlStatus_t cnmlComputePluginYolov3DetectionOutputOpForward(
   return CNML_STATUS_SUCCESS;
 }
 
-cnmlStatus_t cnmlCpuComputePluginYolov3DetectionOutputOpForward(
-    cnmlPluginYolov3DetectionOutputOpParam_t param,
-    void **inputs,
-    void *outputs) {
-  int batchNum = param->batchNum;
+namespace {
+
+// Same expression as the original reference: exp in float, division in
+// double, rounded back to float. Keeping it identical keeps the output
+// bit-compatible with previous CPU results.
+inline float yolov3Sigmoid(float x) {
+  return 1.0 / (1 + std::exp(-x));
+}
+
+// Lower bound in the logit domain for sigmoid(x) > thresh. Values below it
+// can never pass, so the exact sigmoid is only evaluated for the few values
+// above it. The margin absorbs the rounding of the float sigmoid.
+inline float yolov3LogitBound(float thresh) {
+  if (thresh <= 0.0f) return -INFINITY;
+  if (thresh >= 1.0f) return INFINITY;
+  return (float)(std::log((double)thresh / (1.0 - thresh)) - 0.05);
+}
+
+struct Yolov3CpuCandidate {
+  float score;
+  int index;
+};
+
+// Descending score, ascending box index on ties: the order in which the
+// repeated max_element scan of the reference picked boxes.
+inline bool yolov3CandidateGreater(const Yolov3CpuCandidate &a,
+                                   const Yolov3CpuCandidate &b) {
+  return a.score > b.score || (a.score == b.score && a.index < b.index);
+}
+
+// Per-batch scratch space, kept across batches to avoid reallocations.
+// Boxes are stored as SoA, candidates are bucketed per class.
+struct Yolov3CpuWorkspace {
+  std::vector<float> x1, y1, x2, y2;
+  std::vector<double> area;
+  std::vector<std::vector<Yolov3CpuCandidate> > cands;
+  std::vector<std::vector<int> > keeps;
+  std::vector<char> suppressed;
+};
+
+// Decodes every head of one batch into ws: boxes with obj > confidence_thresh
+// are kept, and class scores obj * prob >= confidence_thresh become NMS
+// candidates of their class.
+void yolov3CpuDecode(cnmlPluginYolov3DetectionOutputOpParam_t param,
+                     void **inputs,
+                     int batchIdx,
+                     Yolov3CpuWorkspace *ws) {
   int inputNum = param->inputNum;
   int classNum = param->classNum;
-  int anchorNum = param->maskGroupNum;
-  int maxBoxNum = param->maxBoxNum;
   int netw = param->netw;
   int neth = param->neth;
   float confidence_thresh = param->confidence_thresh;
-  float nms_thresh = param->nms_thresh;
-
-  int* inputWs = param->inputWs;
-  int* inputHs = param->inputHs;
-  float* biases = param->biases;
-
-  int total_hw = inputHs[0] * inputWs[0]
-               + inputHs[1] * inputWs[1]
-               + inputHs[2] * inputWs[2];
+  int *inputWs = param->inputWs;
+  int *inputHs = param->inputHs;
+  float *biases = param->biases;
 
-  std::vector<float> obj_kept;
-  std::vector<std::vector<float> >loc_kept;
-  std::vector<std::vector<float> >prob_kept;
   int unit = 5 + classNum;
-  int ch = unit * anchorNum;
-
-  std::cout << "==================== CPU TEST ===================="
-            << std::endl;
-  #if DEBUG_MODE
-  std::cout << "inputNum: " << inputNum << std::endl;
-  std::cout << "batchNum: " << batchNum << std::endl;
-  #endif
+  float objBound = yolov3LogitBound(confidence_thresh);
+
+  ws->x1.clear();
+  ws->y1.clear();
+  ws->x2.clear();
+  ws->y2.clear();
+  ws->cands.resize(classNum);
+  ws->keeps.resize(classNum);
+  for (int classIdx = 0; classIdx < classNum; classIdx++) {
+    ws->cands[classIdx].clear();
+    ws->keeps[classIdx].clear();
+  }
 
-  for (int batchIdx = 0; batchIdx < batchNum; batchIdx++) {
-    int outBatchSize = (maxBoxNum * 7 + 64) * batchIdx;
-    int boxCount = 0;
-    obj_kept.clear();
-    loc_kept.clear();
-    prob_kept.clear();
-    int idx = 0;
-    for (int i = 0; i < inputNum; i++) {
-      int hw = inputWs[i] * inputHs[i];
-      int batchSize = hw * ch;
-
-      #ifdef DEBUG_MDOE
-      std::cout << "inputId: " << i << " " << hw << std::endl;
-      #endif
-
-      for (int j = 0; j < anchorNum; j++) {
-        for (int k = 0; k < hw; k++) {
-          int x_idx   = j * unit * hw + 0 * hw + k + batchSize * batchIdx;
-          int y_idx   = j * unit * hw + 1 * hw + k + batchSize * batchIdx;
-          int w_idx   = j * unit * hw + 2 * hw + k + batchSize * batchIdx;
-          int h_idx   = j * unit * hw + 3 * hw + k + batchSize * batchIdx;
-          int obj_idx = j * unit * hw + 4 * hw + k + batchSize * batchIdx;
-          float obj = 1.0 / (1 + std::exp(-((float *)inputs[i])[obj_idx]));
-          if (obj > confidence_thresh) {
-            obj_kept.push_back(obj);
-            int x_offset  = k % inputWs[i];
-            int y_offset  = k / inputHs[i];
-            float w_bias  = (float)biases[i * 6 + j * 2 + 0] / netw;
-            float h_bias  = (float)biases[i * 6 + j * 2 + 1] / neth;
-
-            #ifdef DEBUG_MODE
-            std::cout << "===== before =====" << std::endl;
-            std::cout << ((float *)inputs[i])[x_idx] << " "
-                      << ((float *)inputs[i])[y_idx] << " "
-                      << ((float *)inputs[i])[w_idx] << " "
-                      << ((float *)inputs[i])[h_idx] << " "
-                      << std::endl;
-
-            std::cout << i << " "
-                      << j << " "
-                      << k << " "
-                      << x_offset << " "
-                      << y_offset << " "
-                      << std::endl;
-            #endif
-            std::vector<float> loc_tmp;
-            loc_tmp.push_back(
-              (x_offset + 1.0 / (1 + std::exp(-((float *)inputs[i])[x_idx]))) / inputWs[i]);
-            loc_tmp.push_back(
-              (y_offset + 1.0 / (1 + std::exp(-((float *)inputs[i])[y_idx]))) / inputHs[i]);
-            loc_tmp.push_back(
-              std::exp(((float *)inputs[i])[w_idx]) * w_bias);
-            loc_tmp.push_back(
-              std::exp(((float *)inputs[i])[h_idx]) * h_bias);
-            loc_kept.push_back(loc_tmp);
-
-            #ifdef DEBUG_MODE
-            std::cout << "===== after =====" << std::endl;
-            std::cout << loc_kept[idx][0] << " "
-                      << loc_kept[idx][1] << " "
-                      << loc_kept[idx][2] << " "
-                      << loc_kept[idx][3] << " "
-                      << idx << " "
-                      << std::endl
-                      << std::endl;
-            #endif
-
-            std::vector<float> prob_tmp;
-            for (int entry = 0; entry < classNum; entry++) {
-              int prob_idx = j * unit * hw + (entry + 5) * hw + k + batchSize * batchIdx;
-              prob_tmp.push_back(
-                1.0 / (1 + std::exp(-((float *)inputs[i])[prob_idx])));
-            }
-            prob_kept.push_back(prob_tmp);
-            idx++;
+  // heads may differ in shape and anchor count, anchors of head i start at
+  // biases + 2 * (anchors of heads 0..i-1)
+  const float *headBiases = biases;
+  for (int i = 0; i < inputNum; i++) {
+    int anchorNum = param->anchorNums[i];
+    int hw = inputWs[i] * inputHs[i];
+    const float *batchData =
+        (const float *)inputs[i] + hw * unit * anchorNum * batchIdx;
+    for (int j = 0; j < anchorNum; j++) {
+      const float *anchorData = batchData + j * unit * hw;
+      const float *objRow = anchorData + 4 * hw;
+      float w_bias = (float)headBiases[j * 2 + 0] / netw;
+      float h_bias = (float)headBiases[j * 2 + 1] / neth;
+      for (int k = 0; k < hw; k++) {
+        if (!(objRow[k] > objBound)) continue;
+        float obj = yolov3Sigmoid(objRow[k]);
+        if (!(obj > confidence_thresh)) continue;
+
+        int x_offset = k % inputWs[i];
+        int y_offset = k / inputWs[i];
+        float x = (x_offset + 1.0 / (1 + std::exp(-anchorData[k]))) / inputWs[i];
+        float y = (y_offset + 1.0 / (1 + std::exp(-anchorData[hw + k]))) / inputHs[i];
+        float w = std::exp(anchorData[2 * hw + k]) * w_bias;
+        float h = std::exp(anchorData[3 * hw + k]) * h_bias;
+        float x1 = x - w / 2;
+        float y1 = y - h / 2;
+        int boxIdx = ws->x1.size();
+        ws->x1.push_back(x1);
+        ws->y1.push_back(y1);
+        ws->x2.push_back(x1 + w);
+        ws->y2.push_back(y1 + h);
+
+        float probBound = yolov3LogitBound(confidence_thresh / obj);
+        const float *probData = anchorData + 5 * hw + k;
+        for (int classIdx = 0; classIdx < classNum; classIdx++) {
+          float logit = probData[classIdx * hw];
+          if (!(logit > probBound)) continue;
+          float score = obj * yolov3Sigmoid(logit);
+          if (score >= confidence_thresh) {
+            Yolov3CpuCandidate cand = {score, boxIdx};
+            ws->cands[classIdx].push_back(cand);
           }
         }
       }
     }
+    headBiases += 2 * anchorNum;
+  }
 
-    #ifdef DEBUG_MODE
-    std::cout << "maskCount: " << obj_kept.size() << std::endl;
-    std::cout << "===== check obj =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << obj_kept[i] << " ";
-    }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check x =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][0] << " ";
-    }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check y =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][1] << " ";
-    }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check w =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][2] << " ";
-    }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check h =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][3] << " ";
-    }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    #endif
-
-    for (int i = 0; i < idx; i++) {
-      loc_kept[i][0] = loc_kept[i][0] - loc_kept[i][2] / 2;
-      loc_kept[i][1] = loc_kept[i][1] - loc_kept[i][3] / 2;
-      loc_kept[i][2] = loc_kept[i][0] + loc_kept[i][2];
-      loc_kept[i][3] = loc_kept[i][1] + loc_kept[i][3];
-    }
+  // box areas are shared by every class, compute them once
+  int boxNum = ws->x1.size();
+  double w_pad = 1.0 / netw;
+  double h_pad = 1.0 / neth;
+  ws->area.resize(boxNum);
+  for (int b = 0; b < boxNum; b++) {
+    ws->area[b] = (ws->y2[b] - ws->y1[b] + h_pad)
+                * (ws->x2[b] - ws->x1[b] + w_pad);
+  }
+}
 
-    #if DEBUG_MODE
-    std::cout << "===== check obj =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << obj_kept[i] << " ";
-    }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check x1 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][0] << " ";
+// IoU of boxes m and n of ws, boxes are widened by one network pixel.
+inline float yolov3CpuIou(const Yolov3CpuWorkspace &ws, int m, int n,
+                          double w_pad, double h_pad) {
+  float x1_max = std::max(ws.x1[m], ws.x1[n]);
+  float y1_max = std::max(ws.y1[m], ws.y1[n]);
+  float x2_min = std::min(ws.x2[m], ws.x2[n]);
+  float y2_min = std::min(ws.y2[m], ws.y2[n]);
+  float inter_area = (y2_min - y1_max + h_pad)
+                   * (x2_min - x1_max + w_pad);
+  if ((y2_min <= y1_max) || (x2_min <= x1_max))
+    inter_area = 0.0;
+  float union_area = ws.area[m] + ws.area[n] - inter_area;
+  return inter_area / union_area;
+}
+
+// DIoU penalty d^2 / c^2 of boxes m and n: squared distance of the centers
+// over the squared diagonal of the smallest box enclosing both.
+inline float yolov3CpuDiouPenalty(const Yolov3CpuWorkspace &ws, int m, int n) {
+  float dx = (ws.x1[m] + ws.x2[m]) - (ws.x1[n] + ws.x2[n]);
+  float dy = (ws.y1[m] + ws.y2[m]) - (ws.y1[n] + ws.y2[n]);
+  float cw = std::max(ws.x2[m], ws.x2[n]) - std::min(ws.x1[m], ws.x1[n]);
+  float ch = std::max(ws.y2[m], ws.y2[n]) - std::min(ws.y1[m], ws.y1[n]);
+  float c2 = 4 * (cw * cw + ch * ch);
+  return c2 > 0 ? (dx * dx + dy * dy) / c2 : 0;
+}
+
+// Soft-NMS of one class: repeatedly keeps the best remaining candidate and
+// decays the scores of the others by their overlap with it. Kept candidates
+// hold their score at the time they were picked, candidates decayed below
+// confidence_thresh are dropped.
+void yolov3CpuSoftNmsClass(cnmlPluginYolov3DetectionOutputOpParam_t param,
+                           const Yolov3CpuWorkspace &ws,
+                           std::vector<Yolov3CpuCandidate> *cands,
+                           int limit,
+                           std::vector<char> *suppressed,
+                           std::vector<int> *keep) {
+  float confidence_thresh = param->confidence_thresh;
+  float nms_thresh = param->nms_thresh;
+  float sigma = param->nmsSigma;
+  bool linear = param->nmsMode == CNML_YOLOV3_NMS_SOFT_LINEAR;
+  double w_pad = 1.0 / param->netw;
+  double h_pad = 1.0 / param->neth;
+  int candNum = cands->size();
+  std::sort(cands->begin(), cands->end(), yolov3CandidateGreater);
+  suppressed->assign(candNum, 0);
+
+  Yolov3CpuCandidate *c = cands->data();
+  char *done = suppressed->data();
+  while ((int)keep->size() < limit) {
+    // first of the highest scores, as the sort order breaks ties
+    int a = -1;
+    for (int b = 0; b < candNum; b++) {
+      if (!done[b] && c[b].score >= confidence_thresh &&
+          (a < 0 || c[b].score > c[a].score)) {
+        a = b;
+      }
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check y1 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][1] << " ";
+    if (a < 0) break;
+    done[a] = 1;
+    keep->push_back(a);
+    for (int b = 0; b < candNum; b++) {
+      if (done[b]) continue;
+      float IOU = yolov3CpuIou(ws, c[a].index, c[b].index, w_pad, h_pad);
+      if (linear) {
+        if (IOU > nms_thresh) c[b].score *= 1 - IOU;
+      } else {
+        c[b].score *= std::exp(-IOU * IOU / sigma);
+      }
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check x2 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][2] << " ";
+  }
+}
+
+// NMS of one class: sort once, then greedy suppression over the sorted list.
+// Positions of at most limit kept candidates are appended to keep. Only reads
+// the shared boxes of ws, so different classes may run concurrently.
+void yolov3CpuNmsClass(cnmlPluginYolov3DetectionOutputOpParam_t param,
+                       const Yolov3CpuWorkspace &ws,
+                       std::vector<Yolov3CpuCandidate> *cands,
+                       int limit,
+                       std::vector<char> *suppressed,
+                       std::vector<int> *keep) {
+  float confidence_thresh = param->confidence_thresh;
+  float nms_thresh = param->nms_thresh;
+  bool diou = param->nmsMode == CNML_YOLOV3_NMS_DIOU;
+  double w_pad = 1.0 / param->netw;
+  double h_pad = 1.0 / param->neth;
+  int candNum = cands->size();
+  if (candNum == 0 || limit <= 0) return;
+  if (param->nmsMode == CNML_YOLOV3_NMS_SOFT_LINEAR ||
+      param->nmsMode == CNML_YOLOV3_NMS_SOFT_GAUSSIAN) {
+    yolov3CpuSoftNmsClass(param, ws, cands, limit, suppressed, keep);
+    return;
+  }
+  std::sort(cands->begin(), cands->end(), yolov3CandidateGreater);
+  suppressed->assign(candNum, 0);
+
+  const Yolov3CpuCandidate *c = cands->data();
+  char *sup = suppressed->data();
+  for (int a = 0; a < candNum && (int)keep->size() < limit; a++) {
+    if (sup[a]) continue;
+    keep->push_back(a);
+    int m = c[a].index;
+    for (int b = a + 1; b < candNum; b++) {
+      // scores equal to the threshold are kept but never suppressed
+      if (sup[b] || c[b].score <= confidence_thresh)
+        continue;
+      int n = c[b].index;
+      float IOU = yolov3CpuIou(ws, m, n, w_pad, h_pad);
+      if (diou) {
+        IOU -= yolov3CpuDiouPenalty(ws, m, n);
+      }
+      if (IOU >= nms_thresh) {
+        sup[b] = 1;
+      }
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check y2 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_kept[i][3] << " ";
+  }
+}
+
+// Writes the kept boxes of one class, returns the new box count.
+int yolov3CpuEmitClass(const Yolov3CpuWorkspace &ws,
+                       int classIdx,
+                       int batchIdx,
+                       int boxCount,
+                       int maxBoxNum,
+                       float *out) {
+  const std::vector<Yolov3CpuCandidate> &cands = ws.cands[classIdx];
+  const std::vector<int> &keep = ws.keeps[classIdx];
+  for (size_t i = 0; i < keep.size() && boxCount < maxBoxNum; i++) {
+    const Yolov3CpuCandidate &cand = cands[keep[i]];
+    float *box = out + 64 + boxCount * 7;
+    box[0] = batchIdx;
+    box[1] = classIdx;
+    box[2] = cand.score;
+    box[3] = ws.x1[cand.index];
+    box[4] = ws.y1[cand.index];
+    box[5] = ws.x2[cand.index];
+    box[6] = ws.y2[cand.index];
+    boxCount++;
+  }
+  return boxCount;
+}
+
+// Stage 3: writes the kept boxes of all classes in descending score order,
+// ties in class order, keeping the top maxBoxNum. Returns the box count.
+int yolov3CpuEmitSorted(const Yolov3CpuWorkspace &ws,
+                        int classNum,
+                        int batchIdx,
+                        int maxBoxNum,
+                        float *out) {
+  std::vector<std::pair<int, int> > kept;
+  for (int classIdx = 0; classIdx < classNum; classIdx++) {
+    for (size_t i = 0; i < ws.keeps[classIdx].size(); i++) {
+      kept.push_back(std::make_pair(classIdx, ws.keeps[classIdx][i]));
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    #endif
-
-    #if DEBUG_MODE
-    std::cout << "===== check obj =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << obj_sort[i] << " ";
+  }
+  auto score = [&](const std::pair<int, int> &k) {
+    return ws.cands[k.first][k.second].score;
+  };
+  // kept is in class order already, a stable sort keeps that on ties
+  std::stable_sort(kept.begin(), kept.end(),
+                   [&](const std::pair<int, int> &a,
+                       const std::pair<int, int> &b) {
+    return score(a) > score(b);
+  });
+  int boxCount = std::min((int)kept.size(), maxBoxNum);
+  for (int i = 0; i < boxCount; i++) {
+    const Yolov3CpuCandidate &cand = ws.cands[kept[i].first][kept[i].second];
+    float *box = out + 64 + i * 7;
+    box[0] = batchIdx;
+    box[1] = kept[i].first;
+    box[2] = cand.score;
+    box[3] = ws.x1[cand.index];
+    box[4] = ws.y1[cand.index];
+    box[5] = ws.x2[cand.index];
+    box[6] = ws.y2[cand.index];
+  }
+  return boxCount;
+}
+
+// Runs fn(task, worker) for task in [0, taskNum) on threadNum workers. Tasks
+// are handed out dynamically since per-class NMS cost is very uneven.
+template <typename Fn>
+void yolov3CpuParallelFor(int taskNum, int threadNum, Fn fn) {
+  threadNum = std::min(threadNum, taskNum);
+  if (threadNum <= 1) {
+    for (int task = 0; task < taskNum; task++) fn(task, 0);
+    return;
+  }
+  std::atomic<int> next(0);
+  auto worker = [&](int workerIdx) {
+    for (int task = next++; task < taskNum; task = next++) {
+      fn(task, workerIdx);
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check x1 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_sort[i][0] << " ";
+  };
+  std::vector<std::thread> threads;
+  for (int t = 1; t < threadNum; t++) {
+    threads.push_back(std::thread(worker, t));
+  }
+  worker(0);
+  for (auto &t : threads) t.join();
+}
+
+// Decodes and runs NMS for one batch on the calling thread, writing into its
+// own (maxBoxNum * 7 + 64) slab of outputs.
+void yolov3CpuDetectBatch(cnmlPluginYolov3DetectionOutputOpParam_t param,
+                          void **inputs,
+                          float *outputs,
+                          int batchIdx,
+                          Yolov3CpuWorkspace *ws) {
+  int maxBoxNum = param->maxBoxNum;
+  float *out = outputs + (maxBoxNum * 7 + 64) * batchIdx;
+  yolov3CpuDecode(param, inputs, batchIdx, ws);
+  int boxCount = 0;
+  if (param->sortOutput) {
+    // any class may hold part of the global top maxBoxNum
+    for (int classIdx = 0; classIdx < param->classNum; classIdx++) {
+      yolov3CpuNmsClass(param, *ws, &ws->cands[classIdx], maxBoxNum,
+                        &ws->suppressed, &ws->keeps[classIdx]);
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check y1 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_sort[i][1] << " ";
+    boxCount = yolov3CpuEmitSorted(*ws, param->classNum, batchIdx,
+                                   maxBoxNum, out);
+  } else {
+    for (int classIdx = 0; classIdx < param->classNum; classIdx++) {
+      yolov3CpuNmsClass(param, *ws, &ws->cands[classIdx],
+                        maxBoxNum - boxCount,
+                        &ws->suppressed, &ws->keeps[classIdx]);
+      boxCount = yolov3CpuEmitClass(*ws, classIdx, batchIdx, boxCount,
+                                    maxBoxNum, out);
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check x2 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_sort[i][2] << " ";
+  }
+  out[0] = (float)boxCount;
+  out[2] = 0;  // no fixed candidate buffer on CPU, never overflows
+}
+
+// Repacks the slab of one batch into the compact layout in place: the
+// header keeps the count and the overflow flag, the 4th number holds
+// maxBoxNum and boxes become [classId, score, x1, y1, x2, y2]. Record i only
+// moves to a lower offset, so going forward never overwrites unread boxes.
+void yolov3CpuCompact(float *out, int maxBoxNum) {
+  int boxCount = (int)out[0];
+  out[3] = (float)maxBoxNum;
+  for (int i = 0; i < boxCount; i++) {
+    const float *box = out + 64 + i * 7;
+    float *record = out + 64 + i * 6;
+    for (int k = 0; k < 6; k++) {
+      record[k] = box[k + 1];
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    std::cout << "===== check y2 =====" << std::endl;
-    for (int i = 0; i < idx; i++) {
-      std::cout << loc_sort[i][3] << " ";
+  }
+}
+
+}  // namespace
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpCpuThreadNum(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int threadNum) {
+  if (param == nullptr || threadNum < 0) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->cpuThreadNum = threadNum;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpBufferSize(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int tempDstStride,
+    int outputBufferSize) {
+  if (param == nullptr || tempDstStride < 128 || tempDstStride % 64 != 0 ||
+      outputBufferSize <= 0) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->tempDstStride = tempDstStride;
+  param->outputBufferSize = outputBufferSize;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpOutputFormat(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    cnmlYolov3OutputFormat_t format) {
+  if (param == nullptr || (format != CNML_YOLOV3_OUTPUT_SLAB &&
+                           format != CNML_YOLOV3_OUTPUT_COMPACT)) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->outputFormat = format;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpSortOutput(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int sortOutput) {
+  if (param == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->sortOutput = sortOutput ? 1 : 0;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpRuntimeThresholds(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int runtimeThresholds) {
+  if (param == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->runtimeThresholds = runtimeThresholds ? 1 : 0;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpProfile(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int profile) {
+  if (param == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->profile = profile ? 1 : 0;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpNmsMode(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    cnmlYolov3NmsMode_t mode,
+    float sigma) {
+  if (param == nullptr || mode < CNML_YOLOV3_NMS_HARD ||
+      mode > CNML_YOLOV3_NMS_DIOU || !(sigma > 0)) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->nmsMode = mode;
+  param->nmsSigma = sigma;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlSetPluginYolov3DetectionOutputOpFloatIou(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    int floatIou) {
+  if (param == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  param->floatIou = floatIou ? 1 : 0;
+  return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlCpuComputePluginYolov3DetectionOutputOpForward(
+    cnmlPluginYolov3DetectionOutputOpParam_t param,
+    void **inputs,
+    void *outputs) {
+  if (param == nullptr || inputs == nullptr || outputs == nullptr) {
+    return CNML_STATUS_INVALIDPARAM;
+  }
+  cnmlPluginYolov3DetectionOutputOpParam runtimeParam;
+  if (param->runtimeThresholds) {
+    const float *thresh = (const float *)inputs[param->inputNum];
+    if (thresh == nullptr) {
+      return CNML_STATUS_INVALIDPARAM;
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
-    #endif
-
-    // NMS BY CLASS
-    for (int classIdx = 0 ; classIdx < classNum; classIdx++) {
-      std::vector<float> target;
-      for (int boxIdx = 0; boxIdx < idx; boxIdx++) {
-        target.push_back(obj_kept[boxIdx] * prob_kept[boxIdx][classIdx]);
-      }
-      for (int iter = 0; iter < idx; iter++) {
-        float maxValue = *max_element(target.begin(), target.end());
-        int   maxIndex = max_element(target.begin(), target.end()) - target.begin();
-        if (maxValue < confidence_thresh)
-          continue;
-        // store and printf boxParams
-        ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 0] = batchIdx;
-        ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 1] = classIdx;
-        ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 2] = maxValue;
-        ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 3] = loc_kept[maxIndex][0];
-        ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 4] = loc_kept[maxIndex][1];
-        ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 5] = loc_kept[maxIndex][2];
-        ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 6] = loc_kept[maxIndex][3];
-        boxCount++;
-        std::cout << batchIdx << " "
-                  << classIdx << " "
-                  << maxValue << " "
-                  << loc_kept[maxIndex][0] << " "
-                  << loc_kept[maxIndex][1] << " "
-                  << loc_kept[maxIndex][2] << " "
-                  << loc_kept[maxIndex][3] << " "
-                  << std::endl
-                  << std::endl;
-        target[maxIndex] = -1;
-
-        // do nms
-        float x1_star = loc_kept[maxIndex][0];
-        float y1_star = loc_kept[maxIndex][1];
-        float x2_star = loc_kept[maxIndex][2];
-        float y2_star = loc_kept[maxIndex][3];
-        for (int nmsIter = 0; nmsIter < idx; nmsIter++) {
-          if ((target[nmsIter] <= confidence_thresh) || (nmsIter == maxIndex))
-            continue;
-          // compute IOU
-          float x1 = loc_kept[nmsIter][0];
-          float y1 = loc_kept[nmsIter][1];
-          float x2 = loc_kept[nmsIter][2];
-          float y2 = loc_kept[nmsIter][3];
-          float x1_max = std::max(x1_star, x1);
-          float y1_max = std::max(y1_star, y1);
-          float x2_min = std::min(x2_star, x2);
-          float y2_min = std::min(y2_star, y2);
-          float inter_area = (y2_min - y1_max + 1.0 / neth)
-                           * (x2_min - x1_max + 1.0 / netw);
-          if ((y2_min <= y1_max) || (x2_min <= x1_max))
-            inter_area = 0.0;
-          float union_area = (y2_star - y1_star + 1.0 / neth)
-                           * (x2_star - x1_star + 1.0 / netw)
-                           + (y2 - y1 + 1.0 / neth)
-                           * (x2 - x1 + 1.0 / netw)
-                           - inter_area;
-
-          #ifdef DEBUG_MODE
-          std::cout << "  " << inter_area << " "
-                    << "  " << union_area << " "
-                    << "  " << inter_area / union_area << " "
-                    << std::endl
-                    << std::endl;
-          #endif
-
-          float IOU = inter_area / union_area;
-          if ((IOU >= nms_thresh)) {
-          target[nmsIter] = -1;
-          }
-        }
+    runtimeParam = *param;
+    runtimeParam.confidence_thresh = thresh[0];
+    runtimeParam.nms_thresh = thresh[1];
+    param = &runtimeParam;
+  }
+  int batchNum = param->batchNum;
+  int classNum = param->classNum;
+  int maxBoxNum = param->maxBoxNum;
+  int threadNum = param->cpuThreadNum;
+  if (threadNum <= 0) {
+    threadNum = std::max(1, (int)std::thread::hardware_concurrency());
+  }
+
+  if (threadNum == 1 || batchNum >= threadNum) {
+    // enough batches to keep every thread busy: one batch per task, each
+    // batch writes only its own output slab
+    std::vector<Yolov3CpuWorkspace> ws(std::min(threadNum, batchNum));
+    yolov3CpuParallelFor(batchNum, threadNum, [&](int batchIdx, int worker) {
+      yolov3CpuDetectBatch(param, inputs, (float *)outputs, batchIdx,
+                           &ws[worker]);
+      if (param->outputFormat == CNML_YOLOV3_OUTPUT_COMPACT) {
+        yolov3CpuCompact((float *)outputs + (maxBoxNum * 7 + 64) * batchIdx,
+                         maxBoxNum);
       }
-      for (int nmsIdx = 0; nmsIdx < idx; nmsIdx++) {
-        if (target[nmsIdx] > confidence_thresh) {
-          // store and printf boxParams
-          ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 0] = batchIdx;
-          ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 1] = classIdx;
-          ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 2] = target[nmsIdx];
-          ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 3] = loc_kept[nmsIdx][0];
-          ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 4] = loc_kept[nmsIdx][1];
-          ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 5] = loc_kept[nmsIdx][2];
-          ((float *)outputs)[outBatchSize + 64 + boxCount * 7 + 6] = loc_kept[nmsIdx][3];
-          boxCount++;
-          std::cout << batchIdx << " "
-                    << classIdx << " "
-                    << target[nmsIdx] << " "
-                    << loc_kept[nmsIdx][0] << " "
-                    << loc_kept[nmsIdx][1] << " "
-                    << loc_kept[nmsIdx][2] << " "
-                    << loc_kept[nmsIdx][3] << " "
-                    << std::endl
-                    << std::endl;
-        }
+    });
+    return CNML_STATUS_SUCCESS;
+  }
+
+  // fewer batches than threads: decode serially, run NMS of different classes
+  // concurrently, then emit in class order so the output stays deterministic.
+  // Classes go in waves so that, as in the serial path, NMS stops once
+  // maxBoxNum boxes have been emitted. With sortOutput every class is run
+  // and the boxes are emitted by score at the end.
+  Yolov3CpuWorkspace ws;
+  std::vector<std::vector<char> > suppressed(threadNum);
+  int waveSize = 2 * threadNum;
+  for (int batchIdx = 0; batchIdx < batchNum; batchIdx++) {
+    float *out = (float *)outputs + (maxBoxNum * 7 + 64) * batchIdx;
+    yolov3CpuDecode(param, inputs, batchIdx, &ws);
+    int boxCount = 0;
+    bool sortOutput = param->sortOutput;
+    for (int waveBegin = 0;
+         waveBegin < classNum && (sortOutput || boxCount < maxBoxNum);
+         waveBegin += waveSize) {
+      int waveEnd = std::min(waveBegin + waveSize, classNum);
+      int limit = sortOutput ? maxBoxNum : maxBoxNum - boxCount;
+      yolov3CpuParallelFor(waveEnd - waveBegin, threadNum,
+                           [&](int task, int worker) {
+        int classIdx = waveBegin + task;
+        yolov3CpuNmsClass(param, ws, &ws.cands[classIdx], limit,
+                          &suppressed[worker], &ws.keeps[classIdx]);
+      });
+      for (int classIdx = waveBegin; classIdx < waveEnd && !sortOutput;
+           classIdx++) {
+        boxCount = yolov3CpuEmitClass(ws, classIdx, batchIdx, boxCount,
+                                      maxBoxNum, out);
       }
     }
-    ((float *)outputs)[outBatchSize] = (float)boxCount;
+    if (sortOutput) {
+      boxCount = yolov3CpuEmitSorted(ws, classNum, batchIdx, maxBoxNum, out);
+    }
+    out[0] = (float)boxCount;
+    out[2] = 0;
+    if (param->outputFormat == CNML_YOLOV3_OUTPUT_COMPACT) {
+      yolov3CpuCompact(out, maxBoxNum);
+    }
   }
-  std::cout << "========= Num of valid box from cpu is "
-            << (int)(((float *)outputs)[0]) << " ========="
-            << std::endl;
   return CNML_STATUS_SUCCESS;
 }
@@ -0,0 +1,151 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+// Host-side reader for the CNML_YOLOV3_OUTPUT_COMPACT layout of
+// PluginYolov3DetectionOutputOp. Header only and free of cnrt/cnml so it can
+// be used by post-processing code that never links the plugin.
+//
+// Per batch, at batchId * (64 + 7 * maxBoxNum) halfs:
+//   [0] box count (half)   [2] overflow flag (half)   [3] maxBoxNum (int16)
+//   [64 + 6 * i] classId (int16), score, x1, y1, x2, y2 (half)
+#ifndef YOLOV3_DETECTIONS_H_
+#define YOLOV3_DETECTIONS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace yolov3 {
+
+inline float halfToFloat(uint16_t h) {
+  uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  int32_t exp = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+  uint32_t x;
+  if (exp == 0) {
+    if (mant == 0) {
+      x = sign;
+    } else {
+      exp = 1;
+      while (!(mant & 0x400)) {
+        mant <<= 1;
+        --exp;
+      }
+      mant &= 0x3ff;
+      x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+    }
+  } else if (exp == 31) {
+    x = sign | 0x7f800000 | (mant << 13);
+  } else {
+    x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+  }
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+struct Box {
+  int classId;
+  float score;
+  float x1, y1, x2, y2;
+};
+
+const int kHeaderSize = 64;
+const int kRecordSize = 6;
+
+// Detections of one batch. Only keeps a pointer into the output buffer,
+// boxes are decoded on access.
+class Detections {
+ public:
+  class const_iterator {
+   public:
+    const_iterator(const Detections *dets, int idx) : dets_(dets), idx_(idx) {}
+    Box operator*() const { return (*dets_)[idx_]; }
+    const_iterator &operator++() {
+      ++idx_;
+      return *this;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return idx_ != other.idx_;
+    }
+    bool operator==(const const_iterator &other) const {
+      return idx_ == other.idx_;
+    }
+
+   private:
+    const Detections *dets_;
+    int idx_;
+  };
+
+  explicit Detections(const uint16_t *slab) : slab_(slab) {
+    count_ = (int)halfToFloat(slab_[0]);
+    int maxBoxNum = (int16_t)slab_[3];
+    if (count_ < 0) count_ = 0;
+    if (count_ > maxBoxNum) count_ = maxBoxNum;
+  }
+
+  int size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  // The kernel dropped boxes because a scratch buffer was too small.
+  bool overflow() const { return halfToFloat(slab_[2]) != 0.0f; }
+  int maxBoxNum() const { return (int16_t)slab_[3]; }
+
+  Box operator[](int idx) const {
+    const uint16_t *record = slab_ + kHeaderSize + idx * kRecordSize;
+    Box box;
+    box.classId = (int16_t)record[0];
+    box.score = halfToFloat(record[1]);
+    box.x1 = halfToFloat(record[2]);
+    box.y1 = halfToFloat(record[3]);
+    box.x2 = halfToFloat(record[4]);
+    box.y2 = halfToFloat(record[5]);
+    return box;
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, count_); }
+
+  // Bytes that hold the valid part of this batch, enough for a partial
+  // device to host copy once the header has been read.
+  size_t bytes() const { return (kHeaderSize + kRecordSize * count_) * 2; }
+
+ private:
+  const uint16_t *slab_;
+  int count_;
+};
+
+// Byte distance between two batches of the output tensor.
+inline size_t batchStride(int maxBoxNum) {
+  return (size_t)(kHeaderSize + 7 * maxBoxNum) * 2;
+}
+
+// View of batch `batchId` in a compact output buffer copied to host.
+inline Detections view(const void *output, int batchId) {
+  const uint16_t *base = (const uint16_t *)output;
+  int maxBoxNum = (int16_t)base[3];
+  return Detections((const uint16_t *)((const char *)base +
+                                       batchId * batchStride(maxBoxNum)));
+}
+
+}  // namespace yolov3
+
+#endif  // YOLOV3_DETECTIONS_H_
@@ -0,0 +1,130 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+// Host-side summary of the profile output of PluginYolov3DetectionOutputOp,
+// see cnmlSetPluginYolov3DetectionOutputOpProfile. Records of several runs
+// can be appended to one Yolov3Profile before printing, e.g.
+//
+//   yolov3::Yolov3Profile prof;
+//   for (...) {
+//     // run the op, copy the profile output back to host_profile
+//     prof.add(host_profile, batchNum);
+//   }
+//   prof.print(stdout);
+#ifndef YOLOV3_PROFILE_H_
+#define YOLOV3_PROFILE_H_
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include "yolov3_profile_layout.h"
+
+namespace yolov3 {
+
+enum ProfileStage {
+  PROFILE_DECODE = 0,
+  PROFILE_GATHER,
+  PROFILE_NMS,
+  PROFILE_STORE,
+  PROFILE_STAGE_NUM
+};
+
+class Yolov3Profile {
+ public:
+  // Adds the records of one run, profile holds batchNum batches.
+  void add(const int *profile, int batchNum) {
+    for (int b = 0; b < batchNum; b++) {
+      const int *batch = profile + b * CNML_YOLOV3_PROFILE_CORE_NUM *
+                                       CNML_YOLOV3_PROFILE_RECORD_SIZE;
+      int coreNum = std::min(std::max(batch[7], 0), CNML_YOLOV3_PROFILE_CORE_NUM);
+      int batchUs = 0;
+      for (int c = 0; c < coreNum; c++) {
+        const int *record = batch + c * CNML_YOLOV3_PROFILE_RECORD_SIZE;
+        int coreUs = 0;
+        for (int s = 0; s < PROFILE_STAGE_NUM; s++) {
+          stageUs_[s].push_back(record[s]);
+          coreUs += record[s];
+        }
+        decodedBoxes_.push_back(record[4]);
+        // per-class NMS cost, only meaningful for cores that ran NMS
+        if (record[6] > 0) {
+          nmsClassUs_.push_back((float)record[PROFILE_NMS] / record[6]);
+        }
+        batchUs = std::max(batchUs, coreUs);
+      }
+      if (coreNum > 0) batchUs_.push_back(batchUs);
+    }
+  }
+
+  void print(FILE *out) const {
+    static const char *kStageName[PROFILE_STAGE_NUM] = {
+        "decode", "gather", "nms", "store"};
+    float total = 0.0f;
+    for (int s = 0; s < PROFILE_STAGE_NUM; s++) total += sum(stageUs_[s]);
+    fprintf(out, "%-10s %10s %10s %10s %10s %7s\n",
+            "stage(us)", "mean", "p50", "p90", "p99", "share");
+    for (int s = 0; s < PROFILE_STAGE_NUM; s++) {
+      printRow(out, kStageName[s], stageUs_[s],
+               total > 0 ? 100.0f * sum(stageUs_[s]) / total : 0.0f);
+    }
+    printRow(out, "nms/class", nmsClassUs_, -1.0f);
+    printRow(out, "batch", batchUs_, -1.0f);
+    printRow(out, "boxes", decodedBoxes_, -1.0f);
+  }
+
+ private:
+  template <typename V>
+  static float sum(const std::vector<V> &v) {
+    float s = 0.0f;
+    for (size_t i = 0; i < v.size(); i++) s += v[i];
+    return s;
+  }
+
+  template <typename V>
+  static float percentile(std::vector<V> v, float p) {
+    if (v.empty()) return 0.0f;
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(p * (v.size() - 1) + 0.5f)];
+  }
+
+  template <typename V>
+  static void printRow(FILE *out, const char *name, const std::vector<V> &v,
+                       float share) {
+    float mean = v.empty() ? 0.0f : sum(v) / v.size();
+    fprintf(out, "%-10s %10.1f %10.1f %10.1f %10.1f", name, mean,
+            percentile(v, 0.5f), percentile(v, 0.9f), percentile(v, 0.99f));
+    if (share >= 0) {
+      fprintf(out, " %6.1f%%", share);
+    }
+    fprintf(out, "\n");
+  }
+
+  std::vector<int> stageUs_[PROFILE_STAGE_NUM];
+  std::vector<float> nmsClassUs_;
+  std::vector<int> batchUs_;
+  std::vector<int> decodedBoxes_;
+};
+
+}  // namespace yolov3
+
+#endif  // YOLOV3_PROFILE_H_
@@ -0,0 +1,33 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+// Size of the profile output of PluginYolov3DetectionOutputOp, shared by
+// cnplugin.h, the MLU kernel and yolov3_profile.h. Plain macros without
+// includes so that the kernel can use them, see
+// cnmlSetPluginYolov3DetectionOutputOpProfile for the record layout.
+#ifndef YOLOV3_PROFILE_LAYOUT_H_
+#define YOLOV3_PROFILE_LAYOUT_H_
+
+#define CNML_YOLOV3_PROFILE_CORE_NUM 16
+#define CNML_YOLOV3_PROFILE_RECORD_SIZE 8
+
+#endif  // YOLOV3_PROFILE_LAYOUT_H_
@@ -955,6 +955,38 @@ REGISTER_OP("MLUNonMaxSuppression")
     });
 #endif  // CAMBRICON_MLU
 
+// 批量 NMS, 在 MLU 上直接调用 nms_detection (cnmlCreatePluginNmsOp),
+// 输出保留框的 [score, 4 个坐标] 而不是下标, 供 SSD/EAST 等后处理使用
+REGISTER_OP("NmsDetection")
+    .Input("boxes: T")
+    .Input("scores: T")
+    .Output("detections: T")
+    .Output("valid_outputs: int32")
+    .Attr("T: {half, float} = DT_HALF")
+    .Attr("max_output_size: int >= 1")
+    .Attr("iou_threshold: float = 0.5")
+    .Attr("score_threshold: float = 0.0")
+    .SetShapeFn([](InferenceContext* c) {
+      // boxes: [batch, num_boxes, 4], scores: [batch, num_boxes]
+      ShapeHandle boxes;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &boxes));
+      ShapeHandle scores;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &scores));
+      DimensionHandle batch;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 0), c->Dim(scores, 0), &batch));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 1), c->Dim(scores, 1), &unused));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 2), 4, &unused));
+
+      int max_output_size;
+      TF_RETURN_IF_ERROR(c->GetAttr("max_output_size", &max_output_size));
+      c->set_output(0, c->MakeShape({batch, max_output_size, 5}));
+      c->set_output(1, c->Vector(batch));
+      return Status::OK();
+    });
+
 
 REGISTER_OP("NonMaxSuppressionWithOverlaps")
     .Input("overlaps: float")
@@ -1007,11 +1039,10 @@ REGISTER_OP("CombinedNonMaxSuppression")
 //TODO:完成Yolov3DetectionOutput算子注册
 REGISTER_OP("Yolov3DetectionOutput")
         .Output("predicts: T")
-        .Input("input0: T")
-        .Input("input1: T")
-        .Input("input2: T")
+        .Input("inputs: inputNum * T")
+        .Input("thresholds: num_thresholds * T")
         .Attr("batchNum: int")
-        .Attr("inputNum: int")
+        .Attr("inputNum: int >= 1")
         .Attr("classNum: int")
         .Attr("maskGroupNum: int")
         .Attr("maxBoxNum: int")
@@ -1022,6 +1053,11 @@ REGISTER_OP("Yolov3DetectionOutput")
         .Attr("inputWs: list(int) = [13, 26, 52]")
         .Attr("inputHs: list(int) = [13, 26, 52]")
         .Attr("biases: list(float) = [116, 90, 156, 198, 373, 326, 30, 61, 62, 45, 59, 119, 10, 13, 16, 30, 33, 23]")
+        // 每个 head 的 anchor 数, 为空时每个 head 都有 maskGroupNum 个
+        .Attr("anchorNums: list(int) = []")
+        .Attr("tempDstStride: int = 2048")
+        .Attr("outputBufferSize: int = 256")
+        .Attr("num_thresholds: int >= 0 = 0")
         .Attr("T: type")
         .SetShapeFn([](InferenceContext *c){
           return SetOutputForYolov3DetectionOutput(c);
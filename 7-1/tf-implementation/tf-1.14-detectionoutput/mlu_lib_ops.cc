@@ -1936,8 +1936,32 @@ tensorflow::Status ComputeYolov3DetectionOutputOp(MLUBaseOp* op,
   compute_forw_param.affinity = &affinity;
   compute_forw_param.end = CNRT_PARAM_END;
 
-  cnmlComputePluginYolov3DetectionOutputOpForward(
-    op, inputs, input_num, outputs, output_num, &compute_forw_param, queue);
+  CNML_RETURN_STATUS(cnmlComputePluginYolov3DetectionOutputOpForward(
+    op, inputs, input_num, outputs, output_num, &compute_forw_param, queue));
+}
+
+tensorflow::Status CreateNmsDetectionOp(MLUBaseOp** op,
+    MLUTensor** input_tensors, MLUTensor** output_tensors,
+    cnmlPluginNmsOpParam_t param) {
+  CNML_RETURN_STATUS(cnmlCreatePluginNmsOp(
+    op, param, input_tensors, output_tensors));
+}
+
+tensorflow::Status ComputeNmsDetectionOp(MLUBaseOp* op,
+                                         MLUCnrtQueue* queue,
+                                         void* inputs[],
+                                         int input_num,
+                                         void* outputs[],
+                                         int output_num) {
+  int dp = 1;
+  cnrtInvokeFuncParam_t compute_forw_param;
+  u32_t affinity = 0x01;
+  compute_forw_param.data_parallelism = &dp;
+  compute_forw_param.affinity = &affinity;
+  compute_forw_param.end = CNRT_PARAM_END;
+
+  CNML_RETURN_STATUS(cnmlComputePluginNmsOpForward(
+    op, inputs, input_num, outputs, output_num, &compute_forw_param, queue));
 }
 
 /*tensorflow::Status CreatePowerDifferenceOp(MLUBaseOp** op, MLUTensor* input1,
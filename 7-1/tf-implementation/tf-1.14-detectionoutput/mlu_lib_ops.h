@@ -934,6 +934,18 @@ tensorflow::Status ComputeYolov3DetectionOutputOp(MLUBaseOp* op,
                                                   void* outputs[], 
                                                   int output_num);
                                                   
+/******************************************************/
+tensorflow::Status CreateNmsDetectionOp(MLUBaseOp** op,
+    MLUTensor** input_tensors, MLUTensor** output_tensors,
+    cnmlPluginNmsOpParam_t param);
+
+tensorflow::Status ComputeNmsDetectionOp(MLUBaseOp* op,
+                                         MLUCnrtQueue* queue,
+                                         void* inputs[],
+                                         int input_num,
+                                         void* outputs[],
+                                         int output_num);
+
 /******************************************************/
 /*tensorflow::Status CreatePowerDifferenceOp(MLUBaseOp** op, MLUTensor* input1,
                                              MLUTensor* input2,
@@ -541,12 +541,19 @@ struct MLUYolov3DetectionOutputOpParam {
   int* inputWs_;
   int* inputHs_;
   float* biases_;
+  int* anchorNums_;
+  int tempDstStride_;
+  int outputBufferSize_;
+  bool runtimeThresholds_;
   // TODO:构造函数
   MLUYolov3DetectionOutputOpParam(int batchNum, int inputNum, int classNum, 
                                   int maskGroupNum, int maxBoxNum, 
                                   int netw, int neth, 
                                   float confidence_thresh, float nms_thresh, 
-                                  int *inputWs, int *inputHs, float *biases):
+                                  int *inputWs, int *inputHs, float *biases,
+                                  int *anchorNums,
+                                  int tempDstStride, int outputBufferSize,
+                                  bool runtimeThresholds):
         batchNum_(batchNum),
         inputNum_(inputNum),
         classNum_(classNum),
@@ -558,10 +565,29 @@ struct MLUYolov3DetectionOutputOpParam {
         nms_thresh_(nms_thresh),
         inputWs_(inputWs),
         inputHs_(inputHs),
-        biases_(biases) {}
+        biases_(biases),
+        anchorNums_(anchorNums),
+        tempDstStride_(tempDstStride),
+        outputBufferSize_(outputBufferSize),
+        runtimeThresholds_(runtimeThresholds) {}
 
 };
 
+struct MLUNmsDetectionOpParam {
+  int batchNum_;
+  int boxNum_;
+  int maxOutputSize_;
+  float iouThreshold_;
+  float scoreThreshold_;
+  MLUNmsDetectionOpParam(int batchNum, int boxNum, int maxOutputSize,
+                         float iouThreshold, float scoreThreshold):
+        batchNum_(batchNum),
+        boxNum_(boxNum),
+        maxOutputSize_(maxOutputSize),
+        iouThreshold_(iouThreshold),
+        scoreThreshold_(scoreThreshold) {}
+};
+
 
 #define MLU_OP_CTOR_STATUS_CHECK(...)    \
   do {                                   \
@@ -689,6 +715,7 @@ DECLARE_OP_CLASS(MLUDepthToSpace);
 DECLARE_OP_CLASS(MLUBertSquad);
 DECLARE_OP_CLASS(MLULeakyRelu);
 DECLARE_OP_CLASS(MLUYolov3DetectionOutput);
+DECLARE_OP_CLASS(MLUNmsDetection);
 //DECLARE_OP_CLASS(MLUPowerDifference);
 }  // namespace ops
 }  // namespace mlu
@@ -109,9 +109,7 @@ class MLUStream : public internal::StreamInterface {
   }
 
   Status Yolov3DetectionOutput(OpKernelContext* ctx,
-                        Tensor* tensor_input0,
-                        Tensor* tensor_input1,
-                        Tensor* tensor_input2,
+                        std::vector<Tensor*> inputs,
                         int batchNum,
                         int inputNum,
                         int classNum,
@@ -124,6 +122,10 @@ class MLUStream : public internal::StreamInterface {
                         int* inputWs,
                         int* inputHs,
                         float* biases,
+                        int* anchorNums,
+                        int tempDstStride,
+                        int outputBufferSize,
+                        Tensor* thresholds,
                         Tensor* output1,
                         Tensor* output2){
     ops::MLUYolov3DetectionOutputOpParam op_param(
@@ -138,11 +140,18 @@ class MLUStream : public internal::StreamInterface {
                         nms_thresh,
                         inputWs,
                         inputHs,
-                        biases);
+                        biases,
+                        anchorNums,
+                        tempDstStride,
+                        outputBufferSize,
+                        thresholds != nullptr);
+    if (thresholds != nullptr) {
+      inputs.push_back(thresholds);
+    }
     // TODO:补齐下面函数操作
     return CommonOpImpl<ops::MLUYolov3DetectionOutput>(
       ctx, 
-      {tensor_input0, tensor_input1, tensor_input2}, 
+      inputs, 
       {output1, output2}, 
       static_cast<void*>(&op_param)
     );
@@ -672,6 +681,16 @@ class MLUStream : public internal::StreamInterface {
         {input1, input2}, {output_data, output_index}, nullptr);
   }
 
+  Status NmsDetection(OpKernelContext* ctx,
+      Tensor* boxes, Tensor* scores, int batchNum, int boxNum,
+      int maxOutputSize, float iouThreshold, float scoreThreshold,
+      Tensor* detections, Tensor* valid_outputs, Tensor* buffer) {
+    ops::MLUNmsDetectionOpParam op_param(batchNum, boxNum, maxOutputSize,
+        iouThreshold, scoreThreshold);
+    return CommonOpImpl<ops::MLUNmsDetection>(ctx, {boxes, scores},
+        {detections, valid_outputs, buffer}, static_cast<void*>(&op_param));
+  }
+
   Status Sqrt(OpKernelContext* ctx,
       Tensor *input, Tensor *output) {
     return CommonOpImpl<ops::MLUSqrt>(ctx, {input}, {output},
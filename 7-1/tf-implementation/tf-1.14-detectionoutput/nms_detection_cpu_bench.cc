@@ -0,0 +1,244 @@
+/*Copyright 2018 Cambricon*/
+// NmsDetection CPU 实现 (nms_detection_op_cpu.h) 与 TensorFlow NonMaxSuppressionV3
+// CPU kernel 的对比, 不依赖 TensorFlow 与 MLU:
+//   V3: 照抄 tensorflow/core/kernels/non_max_suppression_op.cc 中的
+//       DoNonMaxSuppressionOp 与 IOU, 每张图一次, 输出下标后再 gather 出框;
+//   NmsDetection: NmsDetectionOp 每个分片调用的同一函数, 直接输出 (score, box).
+// 两者都在单线程上逐张图运行, 先检查选出的框相同, 再给出每张图的耗时.
+// 另给出 NmsDetection 按 batch 分到多个线程时的耗时, 对应 NmsDetectionOp 的 Shard.
+//
+// 编译运行:
+//   g++ -std=c++11 -O2 -I . -o nms_detection_cpu_bench nms_detection_cpu_bench.cc
+//       -lpthread
+//   ./nms_detection_cpu_bench [threads=hardware_concurrency]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "nms_detection_op_cpu.h"
+
+using tensorflow::nms_detection::NmsDetectionCpu;
+using tensorflow::nms_detection::Scratch;
+
+// NonMaxSuppressionV3 的 IOU, boxes 为 [num_boxes, 4]
+static inline float IOU(const float* boxes, int i, int j) {
+  const float* bi = boxes + i * 4;
+  const float* bj = boxes + j * 4;
+  const float ymin_i = std::min<float>(bi[0], bi[2]);
+  const float xmin_i = std::min<float>(bi[1], bi[3]);
+  const float ymax_i = std::max<float>(bi[0], bi[2]);
+  const float xmax_i = std::max<float>(bi[1], bi[3]);
+  const float ymin_j = std::min<float>(bj[0], bj[2]);
+  const float xmin_j = std::min<float>(bj[1], bj[3]);
+  const float ymax_j = std::max<float>(bj[0], bj[2]);
+  const float xmax_j = std::max<float>(bj[1], bj[3]);
+  const float area_i = (ymax_i - ymin_i) * (xmax_i - xmin_i);
+  const float area_j = (ymax_j - ymin_j) * (xmax_j - xmin_j);
+  if (area_i <= 0 || area_j <= 0) return 0.0;
+  const float intersection_ymin = std::max<float>(ymin_i, ymin_j);
+  const float intersection_xmin = std::max<float>(xmin_i, xmin_j);
+  const float intersection_ymax = std::min<float>(ymax_i, ymax_j);
+  const float intersection_xmax = std::min<float>(xmax_i, xmax_j);
+  const float intersection_area =
+      std::max<float>(intersection_ymax - intersection_ymin, 0.0) *
+      std::max<float>(intersection_xmax - intersection_xmin, 0.0);
+  return intersection_area / (area_i + area_j - intersection_area);
+}
+
+// NonMaxSuppressionV3 的 DoNonMaxSuppressionOp, 返回选中框的下标
+static void NonMaxSuppressionV3(const float* boxes, const float* scores,
+                                int num_boxes, int output_size,
+                                float iou_threshold, float score_threshold,
+                                std::vector<int>* selected) {
+  std::vector<float> scores_data(num_boxes);
+  std::copy_n(scores, num_boxes, scores_data.begin());
+
+  struct Candidate {
+    int box_index;
+    float score;
+  };
+  auto cmp = [](const Candidate bs_i, const Candidate bs_j) {
+    return ((bs_i.score == bs_j.score) && (bs_i.box_index > bs_j.box_index)) ||
+           bs_i.score < bs_j.score;
+  };
+  std::priority_queue<Candidate, std::deque<Candidate>, decltype(cmp)>
+      candidate_priority_queue(cmp);
+  for (int i = 0; i < static_cast<int>(scores_data.size()); ++i) {
+    if (scores_data[i] > score_threshold) {
+      candidate_priority_queue.emplace(Candidate({i, scores_data[i]}));
+    }
+  }
+
+  auto suppress_check_fn = [&](int i, int j) {
+    return IOU(boxes, i, j) > iou_threshold;
+  };
+  selected->clear();
+  Candidate next_candidate;
+  while (static_cast<int>(selected->size()) < output_size &&
+         !candidate_priority_queue.empty()) {
+    next_candidate = candidate_priority_queue.top();
+    candidate_priority_queue.pop();
+    bool should_select = true;
+    for (int j = static_cast<int>(selected->size()) - 1; j >= 0; --j) {
+      if (suppress_check_fn(next_candidate.box_index, (*selected)[j])) {
+        should_select = false;
+        break;
+      }
+    }
+    if (should_select) {
+      selected->push_back(next_candidate.box_index);
+    }
+  }
+}
+
+struct Case {
+  int batch, num_boxes, max_output_size;
+  float iou_threshold, score_threshold;
+  bool ties;  // score 取 1/64 的倍数, 检查相同 score 按下标先后选择
+};
+
+// 手工构造的边界情况, 检查与 V3 选出的框相同且框数为 expect:
+//   iou_threshold 为 0 时只抑制有重叠的框, 不相交的框全部保留;
+//   IoU 恰好等于 iou_threshold 的框保留 (V3 只在 IoU > iou_threshold 时抑制).
+static int CheckEdgeCases() {
+  struct Edge {
+    const char* name;
+    float iou_threshold;
+    std::vector<float> boxes, scores;
+    int expect;
+  } edges[] = {
+      {"iou 0, disjoint boxes kept", 0.0f,
+       {0, 0, 1, 1, 2, 2, 3, 3, 0.5f, 0.5f, 1.5f, 1.5f, 4, 4, 5, 5},
+       {0.9f, 0.8f, 0.7f, 0.6f}, 3},
+      // 第 2 个框在第 1 个框内, 面积为其一半, IoU = 0.5; 第 3 个框 IoU = 0.9
+      {"IoU == iou_threshold kept", 0.5f,
+       {0, 0, 2, 1, 0, 0, 1, 1, 0, 0, 2, 0.9f},
+       {0.9f, 0.8f, 0.7f}, 2},
+  };
+  int bad = 0;
+  for (const Edge& e : edges) {
+    int num_boxes = e.scores.size();
+    std::vector<int> selected;
+    NonMaxSuppressionV3(e.boxes.data(), e.scores.data(), num_boxes, num_boxes,
+                        e.iou_threshold, 0.0f, &selected);
+    std::vector<float> v3_out(num_boxes * 5, 0.0f);
+    for (size_t j = 0; j < selected.size(); j++) {
+      v3_out[j * 5] = e.scores[selected[j]];
+      std::copy_n(&e.boxes[selected[j] * 4], 4, &v3_out[j * 5 + 1]);
+    }
+    std::vector<float> det(num_boxes * 5);
+    Scratch scratch;
+    int valid = NmsDetectionCpu(e.boxes.data(), e.scores.data(), num_boxes, num_boxes,
+                                e.iou_threshold, 0.0f, det.data(), &scratch);
+    bool ok = det == v3_out && valid == e.expect &&
+              static_cast<int>(selected.size()) == e.expect;
+    bad += !ok;
+    printf("%s: V3 kept %d, NmsDetection kept %d %s\n", e.name,
+           static_cast<int>(selected.size()), valid, ok ? "ok" : "MISMATCH");
+  }
+  return bad;
+}
+
+template <typename F>
+static double BestMs(int reps, F f) {
+  double best = 1e30;
+  for (int r = 0; r < reps; r++) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  int threads = argc > 1 ? atoi(argv[1]) : std::thread::hardware_concurrency();
+  threads = std::max(threads, 1);
+  // SSD 300 (1917 个 prior), EAST 与 YOLOv3 416 (10647) 量级, 两种 score 阈值
+  std::vector<Case> cases = {
+      {8, 1917, 100, 0.5f, 0.01f, false},  {8, 1917, 100, 0.5f, 0.3f, false},
+      {8, 10647, 200, 0.45f, 0.01f, false}, {8, 10647, 200, 0.45f, 0.3f, false},
+      {8, 30000, 1000, 0.5f, 0.01f, false}, {8, 30000, 1000, 0.5f, 0.5f, false},
+      {8, 10647, 200, 0.45f, 0.01f, true},  {8, 1917, 100, 0.0f, 0.3f, false},
+  };
+  printf("threads %d\n", threads);
+  int bad = CheckEdgeCases();
+  for (const Case& c : cases) {
+    std::mt19937 g(c.num_boxes + c.max_output_size);
+    std::uniform_real_distribution<float> pos(0, 1), size(0.02f, 0.3f), conf(0, 1);
+    std::vector<float> boxes((size_t)c.batch * c.num_boxes * 4);
+    std::vector<float> scores((size_t)c.batch * c.num_boxes);
+    for (size_t i = 0; i < scores.size(); i++) {
+      float y = pos(g), x = pos(g);
+      boxes[i * 4] = y;
+      boxes[i * 4 + 1] = x;
+      boxes[i * 4 + 2] = y + size(g);
+      boxes[i * 4 + 3] = x + size(g);
+      scores[i] = c.ties ? static_cast<int>(conf(g) * 64) / 64.0f : conf(g);
+    }
+
+    // V3: 每张图一次, 之后按下标 gather 出 (score, box), 与 NmsDetection 的输出对齐
+    std::vector<std::vector<int>> selected(c.batch);
+    std::vector<float> v3_out((size_t)c.batch * c.max_output_size * 5);
+    double v3_ms = BestMs(5, [&] {
+      for (int b = 0; b < c.batch; b++) {
+        const float* box = &boxes[(size_t)b * c.num_boxes * 4];
+        const float* score = &scores[(size_t)b * c.num_boxes];
+        NonMaxSuppressionV3(box, score, c.num_boxes, c.max_output_size,
+                            c.iou_threshold, c.score_threshold, &selected[b]);
+        float* out = &v3_out[(size_t)b * c.max_output_size * 5];
+        std::fill(out, out + c.max_output_size * 5, 0.0f);
+        for (size_t j = 0; j < selected[b].size(); j++) {
+          out[j * 5] = score[selected[b][j]];
+          std::copy_n(box + selected[b][j] * 4, 4, out + j * 5 + 1);
+        }
+      }
+    });
+
+    std::vector<float> det((size_t)c.batch * c.max_output_size * 5);
+    std::vector<int> valid(c.batch);
+    auto run = [&](int start, int limit) {
+      Scratch scratch;
+      for (int b = start; b < limit; b++) {
+        valid[b] = NmsDetectionCpu(&boxes[(size_t)b * c.num_boxes * 4],
+                                   &scores[(size_t)b * c.num_boxes], c.num_boxes,
+                                   c.max_output_size, c.iou_threshold,
+                                   c.score_threshold,
+                                   &det[(size_t)b * c.max_output_size * 5], &scratch);
+      }
+    };
+    double nms_ms = BestMs(5, [&] { run(0, c.batch); });
+
+    bool same = det == v3_out;
+    for (int b = 0; b < c.batch; b++) {
+      same = same && valid[b] == static_cast<int>(selected[b].size());
+    }
+
+    double shard_ms = BestMs(5, [&] {
+      std::vector<std::thread> workers;
+      int per = (c.batch + threads - 1) / threads;
+      for (int start = 0; start < c.batch; start += per) {
+        workers.emplace_back(run, start, std::min(start + per, c.batch));
+      }
+      for (std::thread& t : workers) t.join();
+    });
+    same = same && det == v3_out;
+    bad += !same;
+
+    printf("n %5d max_out %4d iou %.2f score %.2f%s kept %4d | V3 %8.3f ms/img | "
+           "NmsDetection %8.3f ms/img (x%.2f), %d threads %8.3f ms/batch %s\n",
+           c.num_boxes, c.max_output_size, c.iou_threshold, c.score_threshold,
+           c.ties ? " ties" : "     ", valid[0], v3_ms / c.batch, nms_ms / c.batch, v3_ms / nms_ms, threads,
+           shard_ms, same ? "ok" : "MISMATCH");
+  }
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
@@ -0,0 +1,112 @@
+/* Copyright 2015 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/nms_detection_op_cpu.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if CAMBRICON_MLU
+#include "tensorflow/core/kernels/nms_detection_op_mlu.h"
+#endif  // CAMBRICON_MLU
+
+namespace tensorflow {
+#if CAMBRICON_MLU
+#define REGISTER_MLU(T)                 \
+  REGISTER_KERNEL_BUILDER(              \
+         Name("NmsDetection")           \
+         .Device(DEVICE_MLU)            \
+         .TypeConstraint<T>("T"),       \
+         MLUNmsDetectionOp<T>);
+  TF_CALL_MLU_FLOAT_TYPES(REGISTER_MLU);
+#undef REGISTER_MLU
+#endif  // CAMBRICON_MLU
+
+// CPU 实现, 与 cnmlCpuComputePluginNmsOpForward 语义一致, 按 batch 分片,
+// 每张图见 nms_detection_op_cpu.h
+template <typename T>
+class NmsDetectionOp : public OpKernel {
+ public:
+  explicit NmsDetectionOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("max_output_size", &max_output_size_));
+    OP_REQUIRES_OK(context, context->GetAttr("iou_threshold", &iou_threshold_));
+    OP_REQUIRES_OK(context, context->GetAttr("score_threshold", &score_threshold_));
+    OP_REQUIRES(context, iou_threshold_ >= 0 && iou_threshold_ <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1], got ",
+                                        iou_threshold_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& boxes = context->input(0);
+    const Tensor& scores = context->input(1);
+    OP_REQUIRES(context, boxes.dims() == 3 && boxes.dim_size(2) == 4,
+                errors::InvalidArgument("boxes must be [batch, num_boxes, 4], got ",
+                                        boxes.shape().DebugString()));
+    OP_REQUIRES(context, scores.dims() == 2 &&
+                             scores.dim_size(0) == boxes.dim_size(0) &&
+                             scores.dim_size(1) == boxes.dim_size(1),
+                errors::InvalidArgument("scores must be [batch, num_boxes], got ",
+                                        scores.shape().DebugString()));
+    const int64 batch = boxes.dim_size(0);
+    const int64 num_boxes = boxes.dim_size(1);
+
+    Tensor* detections = nullptr;
+    Tensor* valid_outputs = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({batch, max_output_size_, 5}), &detections));
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                1, TensorShape({batch}), &valid_outputs));
+
+    const T* box_data = boxes.flat<T>().data();
+    const T* score_data = scores.flat<T>().data();
+    T* det_data = detections->flat<T>().data();
+    int32* valid_data = valid_outputs->flat<int32>().data();
+    const int max_output_size = max_output_size_;
+    const float iou_threshold = iou_threshold_;
+    const float score_threshold = score_threshold_;
+
+    auto work = [=](int64 start, int64 limit) {
+      nms_detection::Scratch scratch;
+      for (int64 b = start; b < limit; ++b) {
+        valid_data[b] = nms_detection::NmsDetectionCpu(
+            box_data + b * num_boxes * 4, score_data + b * num_boxes, num_boxes,
+            max_output_size, iou_threshold, score_threshold,
+            det_data + b * max_output_size * 5, &scratch);
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch,
+          /*cost_per_unit=*/num_boxes * max_output_size, work);
+  }
+
+ private:
+  int max_output_size_;
+  float iou_threshold_;
+  float score_threshold_;
+};
+
+#define REGISTER_CPU(T)                 \
+  REGISTER_KERNEL_BUILDER(              \
+         Name("NmsDetection")           \
+         .Device(DEVICE_CPU)            \
+         .TypeConstraint<T>("T"),       \
+         NmsDetectionOp<T>);
+REGISTER_CPU(float);
+REGISTER_CPU(Eigen::half);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
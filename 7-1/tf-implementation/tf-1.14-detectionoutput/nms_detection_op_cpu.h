@@ -0,0 +1,91 @@
+// tensorflow/core/kernels/nms_detection_op_cpu.h
+
+// Copyright [2018] <Cambricon>
+// NmsDetection 单张图的 CPU 实现, 不依赖 TensorFlow, 供 NmsDetectionOp 与
+// nms_detection_cpu_bench.cc 共用. 语义与 cnmlCpuComputePluginNmsOpForward 一致.
+#ifndef TENSORFLOW_CORE_KERNELS_NMS_DETECTION_OP_CPU_H_
+#define TENSORFLOW_CORE_KERNELS_NMS_DETECTION_OP_CPU_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace tensorflow {
+namespace nms_detection {
+
+// 每个线程一份, 在多张图之间复用
+struct Scratch {
+  std::vector<float> score;
+  std::vector<int> order;
+  std::vector<int> kept;
+  std::vector<float> kept_box;  // 已选框的 x1, y1, x2, y2, 面积
+};
+
+// score > score_threshold 的框按 score 降序贪心选择 (score 相同时下标小的在前),
+// 与已选框 IoU > iou_threshold 的框被抑制 (与 V3 相同), 最多保留 max_output_size 个框.
+// out 为 [max_output_size, 5] 的 (score, box), 不足的部分填 0, 返回保留的框数.
+// 候选框建堆后逐个弹出, 选满即停, 不对全部候选排序; 框坐标在弹出时才转换.
+template <typename T>
+int NmsDetectionCpu(const T* box_data, const T* score_data, int64_t num_boxes,
+                    int max_output_size, float iou_threshold,
+                    float score_threshold, T* out, Scratch* scratch) {
+  std::vector<float>& score = scratch->score;
+  std::vector<int>& order = scratch->order;
+  std::vector<int>& kept = scratch->kept;
+  std::vector<float>& kept_box = scratch->kept_box;
+  score.resize(num_boxes);
+  order.clear();
+  for (int64_t i = 0; i < num_boxes; ++i) {
+    score[i] = static_cast<float>(score_data[i]);
+    if (score[i] > score_threshold) {
+      order.push_back(i);
+    }
+  }
+  // 堆顶为 score 最大, 相同时下标最小的框
+  auto later = [&score](int x, int y) {
+    return score[x] < score[y] || (score[x] == score[y] && x > y);
+  };
+  std::make_heap(order.begin(), order.end(), later);
+
+  kept.clear();
+  kept_box.clear();
+  for (auto end = order.end(); end != order.begin() &&
+                               static_cast<int>(kept.size()) < max_output_size;) {
+    std::pop_heap(order.begin(), end, later);
+    --end;
+    const T* b = box_data + *end * 4;
+    const float n[4] = {static_cast<float>(b[0]), static_cast<float>(b[1]),
+                        static_cast<float>(b[2]), static_cast<float>(b[3])};
+    const float area_n = (n[2] - n[0]) * (n[3] - n[1]);
+    // 重叠的框 score 相近, 从最近选中的框往前比较, 更早遇到抑制
+    bool keep = true;
+    for (int64_t j = static_cast<int64_t>(kept.size()) - 1; j >= 0 && keep; --j) {
+      const float* m = &kept_box[j * 5];
+      const float inter_a =
+          std::max(std::min(m[2], n[2]) - std::max(m[0], n[0]), 0.0f);
+      const float inter_b =
+          std::max(std::min(m[3], n[3]) - std::max(m[1], n[1]), 0.0f);
+      const float area_i = inter_a * inter_b;
+      const float area_u = area_n + m[4] - area_i;
+      keep = area_i <= area_u * iou_threshold;
+    }
+    if (keep) {
+      kept.push_back(*end);
+      kept_box.insert(kept_box.end(), {n[0], n[1], n[2], n[3], area_n});
+    }
+  }
+
+  std::fill(out, out + max_output_size * 5, static_cast<T>(0));
+  for (size_t j = 0; j < kept.size(); ++j) {
+    out[j * 5] = score_data[kept[j]];
+    std::copy(box_data + kept[j] * 4, box_data + (kept[j] + 1) * 4,
+              out + j * 5 + 1);
+  }
+  return static_cast<int>(kept.size());
+}
+
+}  // namespace nms_detection
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_NMS_DETECTION_OP_CPU_H_
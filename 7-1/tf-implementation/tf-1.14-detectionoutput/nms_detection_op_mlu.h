@@ -0,0 +1,80 @@
+// tensorflow/core/kernels/nms_detection_op_mlu.h
+
+// Copyright [2018] <Cambricon>
+#ifndef TENSORFLOW_CORE_KERNELS_NMS_DETECTION_OP_MLU_H_
+#define TENSORFLOW_CORE_KERNELS_NMS_DETECTION_OP_MLU_H_
+#ifdef CAMBRICON_MLU
+#include "tensorflow/core/framework/mlu_op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/logging.h"
+
+#include "tensorflow/stream_executor/mlu/mlu_stream.h"
+
+namespace tensorflow {
+template <typename T>
+class MLUNmsDetectionOp : public MLUOpKernel {
+ public:
+  explicit MLUNmsDetectionOp(OpKernelConstruction* context)
+      : MLUOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("max_output_size", &max_output_size_));
+    OP_REQUIRES_OK(context, context->GetAttr("iou_threshold", &iou_threshold_));
+    OP_REQUIRES_OK(context, context->GetAttr("score_threshold", &score_threshold_));
+    OP_REQUIRES(context, iou_threshold_ >= 0 && iou_threshold_ <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1], got ",
+                                        iou_threshold_));
+  }
+
+  void ComputeOnMLU(OpKernelContext* context) override {
+    se::mlu::MLUStream* stream = static_cast<se::mlu::MLUStream*>(
+        context->op_device_context()->stream()->implementation());
+
+    Tensor* boxes = const_cast<Tensor*>(&context->input(0));
+    Tensor* scores = const_cast<Tensor*>(&context->input(1));
+    OP_REQUIRES(context, boxes->dims() == 3 && boxes->dim_size(2) == 4,
+                errors::InvalidArgument("boxes must be [batch, num_boxes, 4], got ",
+                                        boxes->shape().DebugString()));
+    OP_REQUIRES(context, scores->dims() == 2 &&
+                             scores->dim_size(0) == boxes->dim_size(0) &&
+                             scores->dim_size(1) == boxes->dim_size(1),
+                errors::InvalidArgument("scores must be [batch, num_boxes], got ",
+                                        scores->shape().DebugString()));
+    const int batch = boxes->dim_size(0);
+    const int num_boxes = boxes->dim_size(1);
+
+    Tensor* detections = nullptr;
+    Tensor* valid_outputs = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({batch, max_output_size_, 5}), &detections));
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                1, TensorShape({batch}), &valid_outputs));
+    if (batch == 0 || num_boxes == 0) {
+      return;
+    }
+
+    // nms_detection 会把已选框的 score 清零, 输入先转置到该 buffer 中,
+    // 每张图 [score, x1, y1, x2, y2] 5 行, 行间距为 num_boxes 向上对齐到 64
+    const int box_stride = (num_boxes + 63) / 64 * 64;
+    Tensor buffer;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DataTypeToEnum<T>::v(),
+                                TensorShape({batch, 5, box_stride}), &buffer));
+
+    OP_REQUIRES_OK(context,
+                   stream->NmsDetection(context, boxes, scores, batch, num_boxes,
+                                        max_output_size_, iou_threshold_,
+                                        score_threshold_, detections,
+                                        valid_outputs, &buffer));
+  }
+
+ private:
+  int max_output_size_;
+  float iou_threshold_;
+  float score_threshold_;
+};
+}  // namespace tensorflow
+#endif  // CAMBRICON_MLU
+#endif  // TENSORFLOW_CORE_KERNELS_NMS_DETECTION_OP_MLU_H_
@@ -0,0 +1,63 @@
+// tensorflow/stream_executor/mlu/mlu_api/ops/nmsdetection.cc
+
+#if CAMBRICON_MLU
+#include "tensorflow/stream_executor/mlu/mlu_api/lib_ops/mlu_lib_ops.h"
+#include "tensorflow/stream_executor/mlu/mlu_api/ops/mlu_ops.h"
+
+namespace stream_executor {
+namespace mlu {
+namespace ops {
+
+
+Status MLUNmsDetection::CreateMLUOp(std::vector<MLUTensor*> &inputs, \
+    std::vector<MLUTensor*> &outputs, void *param) {
+    TF_PARAMS_CHECK(inputs.size() > 1, "Missing input");
+    TF_PARAMS_CHECK(outputs.size() > 2, "Missing output");
+    MLUBaseOp *op_ptr = nullptr;
+    MLUNmsDetectionOpParam *op_param = (MLUNmsDetectionOpParam*)param;
+
+    cnmlPluginNmsOpParam_t mlu_param;
+    cnmlCoreVersion_t core_version = CNML_MLU270;
+    TF_PARAMS_CHECK(cnmlCreatePluginNmsOpParam(
+        &mlu_param,
+        op_param->batchNum_, op_param->boxNum_, op_param->maxOutputSize_,
+        op_param->iouThreshold_, op_param->scoreThreshold_,
+        core_version) == CNML_STATUS_SUCCESS,
+        "Invalid batchNum / boxNum / maxOutputSize");
+
+    // boxes, scores | detections, valid_outputs, buffer
+    std::vector<MLUTensor*> input_tensors = {inputs.at(0), inputs.at(1)};
+    std::vector<MLUTensor*> output_tensors = {outputs.at(0), outputs.at(1), outputs.at(2)};
+    Status status = lib::CreateNmsDetectionOp(
+        &op_ptr, input_tensors.data(), output_tensors.data(), mlu_param);
+    cnmlDestroyPluginNmsOpParam(&mlu_param);
+    TF_STATUS_CHECK(status);
+
+    base_ops_.push_back(op_ptr);
+
+    return Status::OK();
+}
+
+Status MLUNmsDetection::Compute(const std::vector<void *> &inputs,
+    const std::vector<void *> &outputs, cnrtQueue_t queue) {
+    int num_input = inputs.size();
+    int num_output = outputs.size();
+    assert(num_input == 2);
+    assert(num_output == 3);
+    TF_STATUS_CHECK(lib::ComputeNmsDetectionOp(
+        base_ops_.at(0), queue,
+        const_cast<void**>(inputs.data()),
+        num_input,
+        const_cast<void**>(outputs.data()),
+        num_output
+    ));
+
+    // 只下发到 queue, 输出拷回 host 时由 stream 同步, 不在此处 cnrtSyncQueue
+
+    return Status::OK();
+}
+
+}  // namespace ops
+}  // namespace mlu
+}  // namespace stream_executor
+#endif  // CAMBRICON_MLU
@@ -4,6 +4,7 @@
 #ifndef TENSORFLOW_CORE_KERNELS_YOLOV3_DETECTION_OUTPUT_OP_MLU_H_
 #define TENSORFLOW_CORE_KERNELS_YOLOV3_DETECTION_OUTPUT_OP_MLU_H_
 #ifdef CAMBRICON_MLU
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include "tensorflow/core/framework/mlu_op_kernel.h"
@@ -34,6 +35,31 @@ class MLUYolov3DetectionOutputOp: public MLUOpKernel{
             OP_REQUIRES_OK(context,context->GetAttr("inputWs",&inputWs_));
             OP_REQUIRES_OK(context,context->GetAttr("inputHs",&inputHs_));
             OP_REQUIRES_OK(context,context->GetAttr("biases",&biases_));
+            OP_REQUIRES_OK(context,context->GetAttr("anchorNums",&anchorNums_));
+            OP_REQUIRES_OK(context,context->GetAttr("tempDstStride",&tempDstStride_));
+            OP_REQUIRES_OK(context,context->GetAttr("outputBufferSize",&outputBufferSize_));
+            OP_REQUIRES_OK(context,context->GetAttr("num_thresholds",&num_thresholds_));
+            // head 表: 每个 head 的 H, W 与 anchor 数
+            OP_REQUIRES(context, static_cast<int>(inputHs_.size()) == inputNum_ &&
+                            static_cast<int>(inputWs_.size()) == inputNum_,
+                        errors::InvalidArgument("inputHs and inputWs must have inputNum = ",
+                                                inputNum_, " elements"));
+            OP_REQUIRES(context, anchorNums_.empty() ||
+                            static_cast<int>(anchorNums_.size()) == inputNum_,
+                        errors::InvalidArgument("anchorNums must be empty or have inputNum = ",
+                                                inputNum_, " elements"));
+            if (anchorNums_.empty()) {
+              anchorNums_.assign(inputNum_, maskGroupNum_);
+            }
+            OP_REQUIRES(context, num_thresholds_ <= 1,
+                        errors::InvalidArgument("num_thresholds must be 0 or 1, got ",
+                                                num_thresholds_));
+            OP_REQUIRES(context, tempDstStride_ >= 128 && tempDstStride_ % 64 == 0,
+                        errors::InvalidArgument("tempDstStride must be a multiple of 64 and at least 128, got ",
+                                                tempDstStride_));
+            OP_REQUIRES(context, outputBufferSize_ > 0,
+                        errors::InvalidArgument("outputBufferSize must be positive, got ",
+                                                outputBufferSize_));
         }
 
         void ComputeOnMLU(OpKernelContext* context) override {
@@ -43,35 +69,42 @@ class MLUYolov3DetectionOutputOp: public MLUOpKernel{
           se::mlu::MLUStream* stream = static_cast<se::mlu::MLUStream*>(
               context->op_device_context()->stream()->implementation());
 
-          Tensor* input0 = const_cast<Tensor*>(&context->input(0));     // YOLOv3的特征图输出
-          Tensor* input1 = const_cast<Tensor*>(&context->input(1));
-          Tensor* input2 = const_cast<Tensor*>(&context->input(2));
+          // YOLOv3的特征图输出, 每个 head 一个
+          std::vector<Tensor*> inputs(inputNum_);
+          int buffer_size = 0;
+          for (int i = 0; i < inputNum_; i++) {
+            inputs[i] = const_cast<Tensor*>(&context->input(i));
+            int64 channels = (classNum_ + 5) * anchorNums_[i];
+            int64 hw = inputHs_[i] * inputWs_[i];
+            OP_REQUIRES(context, inputs[i]->NumElements() == batchNum_ * channels * hw,
+                        errors::InvalidArgument("input ", i, " must hold ", batchNum_, " x ",
+                                                channels, " x ", inputHs_[i], " x ",
+                                                inputWs_[i], " elements, got ",
+                                                inputs[i]->shape().DebugString()));
+            buffer_size += channels * hw;
+          }
+          // 可选的阈值输入 [confidence_thresh, nms_thresh], 每次执行时读取,
+          // 修改阈值不需要重新创建和编译算子
+          Tensor* thresholds = nullptr;
+          if (num_thresholds_ == 1) {
+            thresholds = const_cast<Tensor*>(&context->input(inputNum_));
+            OP_REQUIRES(context, thresholds->NumElements() == 2,
+                        errors::InvalidArgument("thresholds must hold [confidence_thresh, nms_thresh], got ",
+                                                thresholds->shape().DebugString()));
+          }
           string op_parameter = context->op_kernel().type_string();
           // MLU_OP_CHECK_UNSUPPORTED(mlustream_exec, op_parameter, context);
-          // TODO:参数检查与处理
-          int c_arr_data[3] = {255, 255, 255};
-          std::vector<int> input0_shape(4, 1);
-          std::vector<int> input1_shape(4, 1);
-          std::vector<int> input2_shape(4, 1);
-          input0_shape[0] = batchNum_;
-          input0_shape[1] = c_arr_data[0];
-          input0_shape[2] = inputHs_[0];
-          input0_shape[3] = inputWs_[0];
 
-          input1_shape[0] = batchNum_;
-          input1_shape[1] = c_arr_data[1];
-          input1_shape[2] = inputHs_[1];
-          input1_shape[3] = inputWs_[1];
-          
-          input2_shape[0] = batchNum_;
-          input2_shape[1] = c_arr_data[2];
-          input2_shape[2] = inputHs_[2];
-          input2_shape[3] = inputWs_[2];
-          
           // TODO:输出形状推断及输出内存分配
-          int buffer_size = 255 * (inputHs_[0] * inputWs_[0] +
-                                   inputHs_[1] * inputWs_[1] +
-                                   inputHs_[2] * inputWs_[2]);
+          // candidates spill to the buffer when the scratch does not fit in SRAM,
+          // reserve (classNum + 5) rows of tempDstStride for the candidates and
+          // 7 rows of the cluster's candidate count for the NMS results of each
+          // core the op is compiled for (taskDim == GetCoreNum())
+          const int core_num = stream->GetCoreNum();
+          const int rows_per_core = classNum_ + 5 + 7 * std::min(core_num, 4);
+          buffer_size = std::max(buffer_size,
+                                 (rows_per_core * tempDstStride_ * core_num + batchNum_ - 1) /
+                                     batchNum_);
           std::vector<int> buffer_shape = {batchNum_, buffer_size, 1, 1};
           std::vector<int> output_shape(4, 1);
           output_shape[0] = batchNum_;
@@ -88,9 +121,11 @@ class MLUYolov3DetectionOutputOp: public MLUOpKernel{
             OP_REQUIRES_OK(
                 context, 
                 stream->Yolov3DetectionOutput(
-                    context, input0, input1, input2, batchNum_, inputNum_, classNum_, 
+                    context, inputs, batchNum_, inputNum_, classNum_, 
                     maskGroupNum_, maxBoxNum_, netw_, neth_, confidence_thresh_, nms_thresh_, 
-                    inputWs_.data(), inputHs_.data(), biases_.data(), output, buffer
+                    inputWs_.data(), inputHs_.data(), biases_.data(),
+                    anchorNums_.data(),
+                    tempDstStride_, outputBufferSize_, thresholds, output, buffer
                 ));
           } else {
             // mlustream_exec->insert_unsupported_op(context, op_parameter);
@@ -109,6 +144,10 @@ class MLUYolov3DetectionOutputOp: public MLUOpKernel{
     std::vector<int> inputWs_;
     std::vector<int> inputHs_;
     std::vector<float> biases_;
+    std::vector<int> anchorNums_;
+    int tempDstStride_;
+    int outputBufferSize_;
+    int num_thresholds_;
 };
 }
 #endif
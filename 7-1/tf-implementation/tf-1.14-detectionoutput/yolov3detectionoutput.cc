@@ -15,9 +15,6 @@ Status MLUYolov3DetectionOutput::CreateMLUOp(std::vector<MLUTensor*> &inputs, \
     TF_PARAMS_CHECK(inputs.size() > 0, "Missing input");
     TF_PARAMS_CHECK(outputs.size() > 0, "Missing output");
     MLUBaseOp *op_ptr = nullptr;
-    MLUTensor *input0 = inputs.at(0);
-    MLUTensor *input1 = inputs.at(1);
-    MLUTensor *input2 = inputs.at(2);
     MLUTensor *output = outputs.at(0);
     MLUTensor *buffer = outputs.at(1);
 
@@ -33,24 +30,49 @@ Status MLUYolov3DetectionOutput::CreateMLUOp(std::vector<MLUTensor*> &inputs, \
     int *inputWs = ((MLUYolov3DetectionOutputOpParam*)param)->inputWs_;
     int *inputHs = ((MLUYolov3DetectionOutputOpParam*)param)->inputHs_;
     float *biases = ((MLUYolov3DetectionOutputOpParam*)param)->biases_;
+    int *anchorNums = ((MLUYolov3DetectionOutputOpParam*)param)->anchorNums_;
+    int tempDstStride = ((MLUYolov3DetectionOutputOpParam*)param)->tempDstStride_;
+    int outputBufferSize = ((MLUYolov3DetectionOutputOpParam*)param)->outputBufferSize_;
+    bool runtimeThresholds = ((MLUYolov3DetectionOutputOpParam*)param)->runtimeThresholds_;
 
     cnmlPluginYolov3DetectionOutputOpParam_t mlu_param;
     // const int num_anchors = 3;
     cnmlCoreVersion_t core_version = CNML_MLU270;
 
+    // 每个 head 一个输入, 其后是可选的阈值输入
+    TF_PARAMS_CHECK(inputs.size() >= static_cast<size_t>(inputNum),
+                    "Missing input of a head");
+
     // 调用 cnmlCreatePluginYolov3DetectionOutputOpParam
-    cnmlCreatePluginYolov3DetectionOutputOpParam(
+    TF_PARAMS_CHECK(cnmlCreatePluginYolov3DetectionOutputOpParam(
         &mlu_param, 
         batchNum, inputNum, classNum, 
         maskGroupNum, maxBoxNum, 
-        // num_anchors, maxBoxNum, 
         netw, neth, 
         confidence_thresh, nms_thresh, 
         core_version,
         inputWs, inputHs, biases
-    );
+    ) == CNML_STATUS_SUCCESS, "Invalid Yolov3DetectionOutput param");
+    // 每个 head 的 anchor 数
+    if (anchorNums != nullptr) {
+      TF_PARAMS_CHECK(cnmlSetPluginYolov3DetectionOutputOpAnchors(
+          mlu_param, anchorNums, biases) == CNML_STATUS_SUCCESS,
+          "Invalid anchorNums / biases");
+    }
+    TF_PARAMS_CHECK(cnmlSetPluginYolov3DetectionOutputOpBufferSize(
+        mlu_param, tempDstStride, outputBufferSize) == CNML_STATUS_SUCCESS,
+        "Invalid tempDstStride / outputBufferSize");
+    TF_PARAMS_CHECK(cnmlSetPluginYolov3DetectionOutputOpRuntimeThresholds(
+        mlu_param, runtimeThresholds) == CNML_STATUS_SUCCESS,
+        "Invalid runtimeThresholds");
 
-    std::vector<MLUTensor*> input_tensors = {input0, input1, input2};
+    std::vector<MLUTensor*> input_tensors(inputs.begin(), inputs.begin() + inputNum);
+    if (runtimeThresholds) {
+      // 阈值作为输入, 算子编译后可用任意阈值执行
+      TF_PARAMS_CHECK(inputs.size() > static_cast<size_t>(inputNum),
+                      "Missing thresholds input");
+      input_tensors.push_back(inputs.at(inputNum));
+    }
     std::vector<MLUTensor*> output_tensors = {output, buffer};
     // 调用 CreateYolov3DetectionOutputOp
     TF_STATUS_CHECK(lib::CreateYolov3DetectionOutputOp(
@@ -66,7 +88,8 @@ Status MLUYolov3DetectionOutput::Compute(const std::vector<void *> &inputs,
     //TODO: 补齐compute函数实现
     int num_input = inputs.size();
     int num_output = outputs.size();
-    assert(num_input == 3);
+    // 每个 head 一个输入, 可能还有阈值输入
+    assert(num_input >= 1);
     assert(num_output == 2);
     TF_STATUS_CHECK(lib::ComputeYolov3DetectionOutputOp(
         base_ops_.at(0), queue,
@@ -76,8 +99,7 @@ Status MLUYolov3DetectionOutput::Compute(const std::vector<void *> &inputs,
         num_output
     ));
 
-    // delete sync queue after delay copy
-    cnrtSyncQueue(queue);
+    // 只下发到 queue, 输出拷回 host 时由 stream 同步, 不在此处 cnrtSyncQueue
 
     return Status::OK();
 }
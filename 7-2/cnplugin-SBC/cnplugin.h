@@ -1474,6 +1474,8 @@ cnmlStatus_t cnmlCreatePluginSBCOp(
     int batch_num_);
 
 
+/* outputs[0] may be the same address as inputs[0]; SBC then runs in place
+   and the caller only needs one GDRAM buffer per frame. */
 cnmlStatus_t cnmlComputePluginSBCOpForward(
     cnmlBaseOp_t op,
     void **inputs,
@@ -1487,6 +1489,138 @@ cnmlStatus_t cnmlComputePluginSBCOpForward(
 /* ------------------------------- */
 
 
+/* ================================= */
+/* cnmlPluginCycleOp operation start */
+/* ================================= */
+
+/* out[i] = in[i] (op) vec[i % len], generalizing SBC (cycle sub with the
+   per-channel mean). CNML_CYCLE_MULADD takes 2 * len values: scale[len]
+   followed by bias[len], and computes in * scale + bias. */
+typedef enum {
+    CNML_CYCLE_ADD = 0,
+    CNML_CYCLE_SUB = 1,
+    CNML_CYCLE_MUL = 2,
+    CNML_CYCLE_MULADD = 3
+} cnmlPluginCycleOpMode_t;
+
+struct cnmlPluginCycleOpParam
+{
+    cnmlPluginCycleOpMode_t mode;
+    int len;
+    int mask_len;
+    int count;
+    float *vec;
+    void *cast_vec;
+    cnmlTensor_t vec_tensor;
+};
+/*! ``cnmlPluginCycleOpParam_t`` is a pointer to a structure (cnmlPluginCycleOpParam)
+    holding the description of a CycleOp operation param.
+*/
+typedef cnmlPluginCycleOpParam *cnmlPluginCycleOpParam_t;
+
+
+/* count is the number of elements per invocation. Returns
+   CNML_STATUS_INVALIDPARAM for an unknown mode or when lcm(len, 64) exceeds
+   the on-chip mask. */
+cnmlStatus_t cnmlCreatePluginCycleOpParam(
+    cnmlPluginCycleOpParam_t *param,
+    cnmlPluginCycleOpMode_t mode,
+    const float *vec,
+    int len,
+    int count);
+
+
+cnmlStatus_t cnmlDestroyPluginCycleOpParam(
+    cnmlPluginCycleOpParam_t *param);
+
+
+cnmlStatus_t cnmlCreatePluginCycleOp(
+    cnmlBaseOp_t *op,
+    cnmlPluginCycleOpParam_t param,
+    cnmlTensor_t *cycle_input_tensors,
+    cnmlTensor_t *cycle_output_tensors);
+
+
+/* outputs[0] may be the same address as inputs[0]. */
+cnmlStatus_t cnmlComputePluginCycleOpForward(
+    cnmlBaseOp_t op,
+    void **inputs,
+    int input_num,
+    void **outputs,
+    int output_num,
+    cnrtQueue_t queue);
+
+
+cnmlStatus_t cnmlCpuComputePluginCycleOpForward(
+    cnmlPluginCycleOpParam_t param,
+    const float *input,
+    float *output);
+
+/* ------------------------------- */
+/* cnmlPluginCycleOp operation end */
+/* ------------------------------- */
+
+
+/* ======================================= */
+/* cnmlPluginLocalityNmsOp operation start */
+/* ======================================= */
+
+/* Locality-aware NMS of EAST on the host. Boxes given in raster order of the
+   score map are merged into the previous one while their IoU exceeds
+   iou_threshold (vertices averaged with score weights, scores summed), then
+   a standard NMS with quadrilateral IoU runs on the merged boxes. There is
+   no MLU kernel, only the CPU forward. */
+typedef enum {
+    CNML_LNMS_QUAD = 0,  /* x0, y0, x1, y1, x2, y2, x3, y3 */
+    CNML_LNMS_RBOX = 1   /* x, y, d_top, d_right, d_bottom, d_left, angle */
+} cnmlPluginLocalityNmsInput_t;
+
+struct cnmlPluginLocalityNmsOpParam
+{
+    cnmlPluginLocalityNmsInput_t input_type;
+    int box_num;
+    int max_output_num;
+    float iou_threshold;
+    void *engine;
+};
+/*! ``cnmlPluginLocalityNmsOpParam_t`` is a pointer to a structure
+    (cnmlPluginLocalityNmsOpParam) holding the description of a LocalityNms
+    operation param.
+*/
+typedef cnmlPluginLocalityNmsOpParam *cnmlPluginLocalityNmsOpParam_t;
+
+
+/* box_num is the largest number of input boxes per call, scratch for it is
+   allocated here. max_output_num <= 0 keeps every box left by the NMS. */
+cnmlStatus_t cnmlCreatePluginLocalityNmsOpParam(
+    cnmlPluginLocalityNmsOpParam_t *param,
+    cnmlPluginLocalityNmsInput_t input_type,
+    int box_num,
+    int max_output_num,
+    float iou_threshold);
+
+
+cnmlStatus_t cnmlDestroyPluginLocalityNmsOpParam(
+    cnmlPluginLocalityNmsOpParam_t *param);
+
+
+/* input holds box_num rows of 8 (QUAD) or 7 (RBOX) numbers, scores box_num
+   numbers, box_num <= param->box_num. output receives *output_num rows of
+   [x0, y0, x1, y1, x2, y2, x3, y3, score] in descending score order and must
+   hold min(box_num, max_output_num) rows. */
+cnmlStatus_t cnmlCpuComputePluginLocalityNmsOpForward(
+    cnmlPluginLocalityNmsOpParam_t param,
+    const float *input,
+    const float *scores,
+    int box_num,
+    float *output,
+    int *output_num);
+
+/* ------------------------------------- */
+/* cnmlPluginLocalityNmsOp operation end */
+/* ------------------------------------- */
+
+
 
 
 
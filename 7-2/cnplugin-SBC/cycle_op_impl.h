@@ -0,0 +1,73 @@
+/*************************************************************************
+ * Copyright (C) [2020] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// cycle op 族共用的 BANG 实现: 多核拆分、NRAM 分块与 cycle 运算.
+// SBCKernel 与 CycleOpKernel 都通过 cycleOpCompute 完成计算.
+
+#ifndef __CYCLE_OP_IMPL_H__
+#define __CYCLE_OP_IMPL_H__
+
+#include "mlu.h"
+#include "macro.h"
+
+// mask[0, len) 已就绪, 循环展开到 mask_len
+__mlu_func__ void cycleOpExpandMask(half* mask, int len, int mask_len) {
+    for (int i = len; i < mask_len; i++) {
+        mask[i] = mask[i - len];
+    }
+}
+
+// out = in (op) mask, mask 以 mask_len 为周期沿数据循环.
+// 每个 core 负责连续的一段, 段起点与 NRAM 分块起点均为 mask_len 的整数倍,
+// 因此各块内 mask 相位始终从 0 开始. 每块先整体读入再写回相同偏移,
+// 允许 input == output.
+template <int MODE>
+__mlu_func__ void cycleOpCompute(half* input, half* output, half* nram_data,
+                                 half* nram_mask, half* nram_mask2,
+                                 int mask_len, int count) {
+    const int deal_num = CYCLE_NRAM_SIZE / mask_len * mask_len;
+    const int core_avg = (count + taskDim - 1) / taskDim;
+    const int core_num = (core_avg + mask_len - 1) / mask_len * mask_len;
+    const int begin = taskId * core_num;
+    const int end = begin + core_num < count ? begin + core_num : count;
+
+    for (int offset = begin; offset < end; offset += deal_num) {
+        int num = end - offset < deal_num ? end - offset : deal_num;
+        // 尾块按 mask_len 向上对齐计算, 只拷回有效的 num 个
+        int num_pad = (num + mask_len - 1) / mask_len * mask_len;
+        __memcpy(nram_data, input + offset, num * sizeof(half), GDRAM2NRAM);
+        if (MODE == CYCLE_ADD) {
+            __bang_cycle_add(nram_data, nram_data, nram_mask, num_pad, mask_len);
+        } else if (MODE == CYCLE_SUB) {
+            __bang_cycle_sub(nram_data, nram_data, nram_mask, num_pad, mask_len);
+        } else if (MODE == CYCLE_MUL) {
+            __bang_cycle_mul(nram_data, nram_data, nram_mask, num_pad, mask_len);
+        } else {
+            __bang_cycle_mul(nram_data, nram_data, nram_mask, num_pad, mask_len);
+            __bang_cycle_add(nram_data, nram_data, nram_mask2, num_pad, mask_len);
+        }
+        __memcpy(output + offset, nram_data, num * sizeof(half), NRAM2GDRAM);
+    }
+}
+
+#endif  // __CYCLE_OP_IMPL_H__
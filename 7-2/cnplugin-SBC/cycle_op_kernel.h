@@ -0,0 +1,11 @@
+#ifndef __CYCLE_OP_KERNEL_H__
+#define __CYCLE_OP_KERNEL_H__
+
+extern "C" {
+    // __mlu_entry__ void CycleOpKernel(half* input_data_, half* output_data_,
+    //     half* vec_, int mode_, int len_, int mask_len_, int count_);
+    void CycleOpKernel(half* input_data_, half* output_data_, half* vec_,
+                       int mode_, int len_, int mask_len_, int count_);
+}
+
+#endif  // __CYCLE_OP_KERNEL_H__
@@ -0,0 +1,358 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// LocalityNms (locality_nms_impl.h) 与按 lanms 逐步写出的朴素实现的对比测试:
+//   - 朴素实现的 IoU 以 double 计算, 多边形面积按相对原点的有向三角形分解,
+//     三角形两两相交求和, 对凹四边形同样成立; 不用外接矩形上界, 标准 NMS 不分网格;
+//   - 合并时的加权平均与实现写法相同, 输出应逐位相同.
+// 覆盖
+//   1. RBOX 输入: 若干旋转矩形内的像素按光栅顺序给出带噪声的几何;
+//   2. QUAD 输入: 同样的框, 顶点再加噪声;
+//   3. 凹四边形: 与正方形及另一个凹四边形的 IoU 在阈值两侧时, 合并与抑制的结果;
+//   4. 退化四边形 (顶点重合或共线): 面积为 0, 不与任何框合并或互相抑制, 输出无 NaN.
+//
+// 编译运行: make locality_nms_test && ./locality_nms_test
+
+#include <math.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "locality_nms_impl.h"
+
+struct RefQuad {
+  float x[4], y[4];
+  float score;
+};
+
+// 凸多边形 s 被凸多边形 c (逆时针) 裁剪后的面积
+static double refClipArea(std::vector<double> sx, std::vector<double> sy,
+                          const double* cx, const double* cy, int cn) {
+  for (int e = 0; e < cn && !sx.empty(); e++) {
+    const int f = (e + 1) % cn;
+    std::vector<double> qx, qy;
+    const int n = (int)sx.size();
+    for (int i = 0; i < n; i++) {
+      const int j = (i + 1) % n;
+      const double di = (cx[f] - cx[e]) * (sy[i] - cy[e]) - (cy[f] - cy[e]) * (sx[i] - cx[e]);
+      const double dj = (cx[f] - cx[e]) * (sy[j] - cy[e]) - (cy[f] - cy[e]) * (sx[j] - cx[e]);
+      if (di >= 0) {
+        qx.push_back(sx[i]);
+        qy.push_back(sy[i]);
+      }
+      if ((di > 0 && dj < 0) || (di < 0 && dj > 0)) {
+        const double t = di / (di - dj);
+        qx.push_back(sx[i] + t * (sx[j] - sx[i]));
+        qy.push_back(sy[i] + t * (sy[j] - sy[i]));
+      }
+    }
+    sx.swap(qx);
+    sy.swap(qy);
+  }
+  double twice = 0;
+  for (size_t i = 0; i < sx.size(); i++) {
+    const size_t j = (i + 1) % sx.size();
+    twice += sx[i] * sy[j] - sx[j] * sy[i];
+  }
+  return fabs(twice) * 0.5;
+}
+
+static double refTwiceArea(const RefQuad& q) {
+  double twice = 0;
+  for (int i = 0; i < 4; i++) {
+    const int j = (i + 1) % 4;
+    twice += (double)q.x[i] * q.y[j] - (double)q.x[j] * q.y[i];
+  }
+  return twice;
+}
+
+// 把四边形写成原点与各边组成的有向三角形之和, 逆时针为正. 返回三角形个数
+static int refFan(const RefQuad& q, double tx[4][3], double ty[4][3], double sign[4]) {
+  const double orient = refTwiceArea(q) > 0 ? 1 : -1;
+  int n = 0;
+  for (int i = 0; i < 4; i++) {
+    const int j = (i + 1) % 4;
+    const double twice = (double)q.x[i] * q.y[j] - (double)q.x[j] * q.y[i];
+    if (twice == 0) continue;
+    // 三角形本身按逆时针存放
+    tx[n][0] = 0;
+    ty[n][0] = 0;
+    const int a = twice > 0 ? i : j, b = twice > 0 ? j : i;
+    tx[n][1] = q.x[a];
+    ty[n][1] = q.y[a];
+    tx[n][2] = q.x[b];
+    ty[n][2] = q.y[b];
+    sign[n] = (twice > 0 ? 1 : -1) * orient;
+    n++;
+  }
+  return n;
+}
+
+static double refIou(const RefQuad& a, const RefQuad& b) {
+  const double area_a = fabs(refTwiceArea(a)) * 0.5;
+  const double area_b = fabs(refTwiceArea(b)) * 0.5;
+  if (area_a == 0 || area_b == 0) return 0;
+  double ax[4][3], ay[4][3], as[4], bx[4][3], by[4][3], bs[4];
+  const int an = refFan(a, ax, ay, as);
+  const int bn = refFan(b, bx, by, bs);
+  double inter = 0;
+  for (int i = 0; i < an; i++) {
+    for (int j = 0; j < bn; j++) {
+      inter += as[i] * bs[j] *
+               refClipArea(std::vector<double>(ax[i], ax[i] + 3),
+                           std::vector<double>(ay[i], ay[i] + 3), bx[j], by[j], 3);
+    }
+  }
+  inter = std::max(inter, 0.0);
+  return inter / (area_a + area_b - inter);
+}
+
+// lanms merge: 顶点循环移位到距离平方和最小后按 score 加权平均
+static void refMerge(RefQuad* m, const RefQuad& q) {
+  int best = 0;
+  float best_dist = 0;
+  for (int r = 0; r < 4; r++) {
+    float dist = 0;
+    for (int k = 0; k < 4; k++) {
+      const float dx = m->x[k] - q.x[(k + r) % 4], dy = m->y[k] - q.y[(k + r) % 4];
+      dist += dx * dx + dy * dy;
+    }
+    if (r == 0 || dist < best_dist) {
+      best_dist = dist;
+      best = r;
+    }
+  }
+  const float wa = m->score, wb = q.score, score = wa + wb;
+  const float inv = 1.0f / std::max(score, 1e-8f);
+  for (int k = 0; k < 4; k++) {
+    m->x[k] = (m->x[k] * wa + q.x[(k + best) % 4] * wb) * inv;
+    m->y[k] = (m->y[k] * wa + q.y[(k + best) % 4] * wb) * inv;
+  }
+  m->score = score;
+}
+
+static std::vector<float> refLanms(const std::vector<RefQuad>& input, float thr, int max_output) {
+  std::vector<RefQuad> merged;
+  for (const RefQuad& q : input) {
+    if (!merged.empty() && refIou(q, merged.back()) > thr) {
+      refMerge(&merged.back(), q);
+    } else {
+      merged.push_back(q);
+    }
+  }
+  std::stable_sort(merged.begin(), merged.end(),
+                   [](const RefQuad& a, const RefQuad& b) { return a.score > b.score; });
+  std::vector<RefQuad> keep;
+  for (const RefQuad& q : merged) {
+    if ((int)keep.size() >= max_output) break;
+    bool suppressed = false;
+    for (const RefQuad& k : keep) {
+      suppressed = suppressed || refIou(k, q) > thr;
+    }
+    if (!suppressed) keep.push_back(q);
+  }
+  std::vector<float> out;
+  for (const RefQuad& q : keep) {
+    for (int k = 0; k < 4; k++) {
+      out.push_back(q.x[k]);
+      out.push_back(q.y[k]);
+    }
+    out.push_back(q.score);
+  }
+  return out;
+}
+
+// 以 QUAD 输入运行 LocalityNms 与朴素实现, 输出逐位相同时返回保留的框数, 否则返回 -1
+static int compare(const char* name, const std::vector<RefQuad>& quads, float thr,
+                   int max_output = 1 << 30) {
+  std::vector<float> input, scores;
+  for (const RefQuad& q : quads) {
+    for (int k = 0; k < 4; k++) {
+      input.push_back(q.x[k]);
+      input.push_back(q.y[k]);
+    }
+    scores.push_back(q.score);
+  }
+  const int num = (int)quads.size();
+  std::vector<float> output((size_t)std::max(num, 1) * LNMS_OUTPUT_COLS);
+  LocalityNms engine;
+  const int kept = engine.run(input.data(), scores.data(), num, LNMS_INPUT_QUAD, thr,
+                              max_output, output.data());
+  output.resize((size_t)kept * LNMS_OUTPUT_COLS);
+  const std::vector<float> ref = refLanms(quads, thr, max_output);
+  bool nan = false;
+  for (float v : output) nan = nan || v != v;
+  const bool same = output == ref;
+  printf("%-44s thr %.2f: %4d boxes -> %4d, ref %4d %s\n", name, thr, num, kept,
+         (int)ref.size() / LNMS_OUTPUT_COLS, same && !nan ? "ok" : (nan ? "NaN" : "MISMATCH"));
+  return same && !nan ? kept : -1;
+}
+
+static RefQuad makeQuad(std::initializer_list<float> xy, float score) {
+  RefQuad q;
+  const float* p = xy.begin();
+  for (int k = 0; k < 4; k++) {
+    q.x[k] = p[2 * k];
+    q.y[k] = p[2 * k + 1];
+  }
+  q.score = score;
+  return q;
+}
+
+struct Rect {
+  float x, y, w, h, angle;  // lnmsRboxToQuad 中不随像素变化的顶点 (angle >= 0 时为 3 号, 否则为 2 号)
+};
+
+// 按光栅顺序生成落在各矩形内的像素的 RBOX 几何, 每个像素取第一个包含它的矩形
+static void makeRbox(std::mt19937& g, int image, std::vector<float>* geo,
+                     std::vector<float>* scores) {
+  std::uniform_real_distribution<float> u(0, 1);
+  std::vector<Rect> rects;
+  for (int i = 0; i < 24; i++) {
+    Rect r;
+    r.x = u(g) * image;
+    r.y = u(g) * image;
+    r.w = 8 + u(g) * 40;
+    r.h = 4 + u(g) * 12;
+    r.angle = (u(g) - 0.5f) * 1.5f;
+    rects.push_back(r);
+  }
+  for (int py = 0; py < image; py++) {
+    for (int px = 0; px < image; px++) {
+      for (const Rect& r : rects) {
+        const float c = cosf(r.angle), s = sinf(r.angle);
+        const float dx = px - r.x, dy = py - r.y;
+        float d[4];  // d_top, d_right, d_bottom, d_left
+        if (r.angle >= 0) {
+          d[3] = c * dx - s * dy;
+          d[2] = -(s * dx + c * dy);
+          d[1] = r.w - d[3];
+          d[0] = r.h - d[2];
+        } else {
+          d[1] = -(c * dx + s * dy);
+          d[2] = s * dx - c * dy;
+          d[3] = r.w - d[1];
+          d[0] = r.h - d[2];
+        }
+        if (d[0] < 0 || d[1] < 0 || d[2] < 0 || d[3] < 0) continue;
+        geo->push_back(px);
+        geo->push_back(py);
+        for (int k = 0; k < 4; k++) geo->push_back(d[k] + (u(g) - 0.5f) * 0.6f);
+        const float angle = r.angle + (u(g) - 0.5f) * 0.02f;
+        geo->push_back(r.angle >= 0 ? std::max(angle, 0.0f) : std::min(angle, -1e-3f));
+        scores->push_back(0.6f + 0.4f * u(g));
+        break;
+      }
+    }
+  }
+}
+
+static bool checkRbox(float thr) {
+  std::mt19937 g(7);
+  std::vector<float> geo, scores;
+  makeRbox(g, 160, &geo, &scores);
+  const int num = (int)scores.size();
+  std::vector<RefQuad> quads(num);
+  for (int i = 0; i < num; i++) {
+    LnmsQuad q;
+    lnmsRboxToQuad(&geo[(size_t)i * 7], &q);
+    std::copy(q.x, q.x + 4, quads[i].x);
+    std::copy(q.y, q.y + 4, quads[i].y);
+    quads[i].score = scores[i];
+  }
+  std::vector<float> output((size_t)num * LNMS_OUTPUT_COLS);
+  LocalityNms engine;
+  const int kept = engine.run(geo.data(), scores.data(), num, LNMS_INPUT_RBOX, thr, num,
+                              output.data());
+  output.resize((size_t)kept * LNMS_OUTPUT_COLS);
+  const bool same = output == refLanms(quads, thr, num);
+  printf("%-44s thr %.2f: %4d boxes -> %4d %s\n", "RBOX", thr, num, kept,
+         same ? "ok" : "MISMATCH");
+  // 框之间有重叠, 合并与抑制都应发生
+  return same && kept > 1 && kept < num;
+}
+
+static bool checkQuad(float thr) {
+  std::mt19937 g(11);
+  std::uniform_real_distribution<float> u(-1, 1);
+  std::vector<float> geo, scores;
+  makeRbox(g, 160, &geo, &scores);
+  const int num = (int)scores.size();
+  std::vector<RefQuad> quads(num);
+  for (int i = 0; i < num; i++) {
+    LnmsQuad q;
+    lnmsRboxToQuad(&geo[(size_t)i * 7], &q);
+    for (int k = 0; k < 4; k++) {
+      quads[i].x[k] = q.x[k] + u(g) * 1.5f;
+      quads[i].y[k] = q.y[k] + u(g) * 1.5f;
+    }
+    quads[i].score = scores[i];
+  }
+  const int kept = compare("QUAD", quads, thr);
+  const int limited = compare("QUAD, max_output 5", quads, thr, 5);
+  return kept > 1 && kept < num && limited == std::min(kept, 5);
+}
+
+int main() {
+  int bad = 0;
+  for (float thr : {0.1f, 0.3f, 0.5f}) {
+    bad += !checkRbox(thr);
+    bad += !checkQuad(thr);
+  }
+
+  // 正方形与凹四边形 (3 号顶点为凹顶点): 凹四边形面积 40, 在正方形内, IoU = 0.4
+  const RefQuad square = makeQuad({0, 0, 10, 0, 10, 10, 0, 10}, 0.9f);
+  const RefQuad dart = makeQuad({0, 0, 10, 0, 10, 10, 6, 4}, 0.8f);
+  // 凹顶点为 0 号、顺时针的凹四边形, 面积 15, 在 dart 内, IoU = 0.375
+  const RefQuad dart2 = makeQuad({6, 4, 10, 10, 10, 5, 0, 0}, 0.7f);
+  const std::vector<RefQuad> concave[] = {{square, dart}, {dart, square}, {dart, dart2}};
+  const char* concave_name[] = {"concave: square, dart", "concave: dart, square",
+                                "concave: dart, dart2"};
+  const float concave_iou[] = {0.4f, 0.4f, 0.375f};
+  for (int c = 0; c < 3; c++) {
+    // 阈值低于 IoU 时两个框合并为一个, 高于 IoU 时都保留;
+    // 反序输入使合并阶段不相邻, 只经过标准 NMS
+    std::vector<RefQuad> apart = concave[c];
+    apart.insert(apart.begin() + 1, makeQuad({50, 50, 60, 50, 60, 60, 50, 60}, 0.5f));
+    const float below = concave_iou[c] - 0.05f, above = concave_iou[c] + 0.05f;
+    bad += compare(concave_name[c], concave[c], below) != 1;
+    bad += compare(concave_name[c], concave[c], above) != 2;
+    bad += compare(concave_name[c], apart, below) != 2;
+    bad += compare(concave_name[c], apart, above) != 3;
+  }
+
+  // 退化四边形: 顶点重合、共线, 以及与正常框重叠的共线框
+  const std::vector<RefQuad> degenerate = {
+      makeQuad({5, 5, 5, 5, 5, 5, 5, 5}, 0.9f),   makeQuad({5, 5, 5, 5, 5, 5, 5, 5}, 0.8f),
+      makeQuad({0, 0, 4, 4, 8, 8, 2, 2}, 0.7f),   makeQuad({0, 5, 10, 5, 10, 5, 0, 5}, 0.6f),
+      square,
+      makeQuad({0, 5, 10, 5, 10, 5, 0, 5}, 0.95f), makeQuad({1, 1, 1, 1, 9, 9, 9, 9}, 0.85f)};
+  for (float thr : {0.0f, 0.5f}) {
+    bad += compare("degenerate", degenerate, thr) != (int)degenerate.size();
+  }
+
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
@@ -0,0 +1,83 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// host 测试用的 mlu.h: 在 CPU 上模拟 SBCKernel / CycleOpKernel 用到的 BANG
+// 内建函数, 使 .mlu 源文件可直接由 g++ 编译. 每个线程模拟一个 core,
+// taskId/taskDim 为 thread_local, 由 emuLaunch 设置.
+
+#ifndef __HOST_TEST_MLU_H__
+#define __HOST_TEST_MLU_H__
+
+#include <string.h>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#define __mlu_func__ inline
+#define __mlu_entry__
+#define __nram__
+
+typedef _Float16 half;
+
+enum mluMemcpyDirection_t { GDRAM2NRAM, NRAM2GDRAM, NRAM2NRAM, GDRAM2GDRAM };
+
+thread_local int taskId = 0;
+thread_local int taskDim = 1;
+
+inline void __memcpy(void* dst, const void* src, int bytes,
+                     mluMemcpyDirection_t dir) {
+  (void)dir;
+  memcpy(dst, src, bytes);
+}
+
+// dst[i] = a[i] (op) b[i % m], 与 MLU 一样以 half 精度舍入
+inline void __bang_cycle_add(half* dst, const half* a, const half* b, int n,
+                             int m) {
+  for (int i = 0; i < n; i++) dst[i] = (half)((float)a[i] + (float)b[i % m]);
+}
+
+inline void __bang_cycle_sub(half* dst, const half* a, const half* b, int n,
+                             int m) {
+  for (int i = 0; i < n; i++) dst[i] = (half)((float)a[i] - (float)b[i % m]);
+}
+
+inline void __bang_cycle_mul(half* dst, const half* a, const half* b, int n,
+                             int m) {
+  for (int i = 0; i < n; i++) dst[i] = (half)((float)a[i] * (float)b[i % m]);
+}
+
+// 以 dim 个线程同时运行 kernel, 对应 cnrtInvokeKernel 的 UNION 任务
+inline void emuLaunch(int dim, std::function<void()> kernel) {
+  std::vector<std::thread> cores;
+  for (int t = 0; t < dim; t++) {
+    cores.emplace_back([=] {
+      taskId = t;
+      taskDim = dim;
+      kernel();
+    });
+  }
+  for (std::thread& core : cores) core.join();
+}
+
+#endif  // __HOST_TEST_MLU_H__
@@ -0,0 +1,87 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// SBC 原地模式的测试: 在 host 上按多个 core 并行运行 spilt_sub_concat_kernel.mlu
+// 中的 SBCKernel (BANG 内建函数由 host_test/mlu.h 模拟), 分别以
+//   独立输出: input 与 output 各一块 GDRAM;
+//   原地:     output == input, 只有一块 GDRAM;
+// 两种方式运行, 检查
+//   1. 原地结果与独立输出逐位相同, 也与 TF CPU kernel 的 SBCRange 相同;
+//   2. 独立输出时 input 不被修改.
+// 覆盖不同 batch 与 core 数 (各 core 分段边界不同). 是否原地由 TF 的
+// forward_input_or_allocate_output 决定, 不在这里测试.
+//
+// 编译运行: make sbc_inplace_test && ./sbc_inplace_test
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+#include <vector>
+
+#include "mlu.h"
+#include "spilt_sub_concat_kernel.mlu"
+#include "sbc_cpu_impl.h"
+
+static bool same(const half* a, const half* b, size_t count) {
+  return memcmp(a, b, count * sizeof(half)) == 0;
+}
+
+static int check(int batch, int cores) {
+  const size_t count = (size_t)batch * DATA_COUNT;
+  std::mt19937 g(batch * 100 + cores);
+  std::uniform_int_distribution<int> u8(0, 255);
+  std::vector<half> frame(count);
+  for (size_t i = 0; i < count; i++) frame[i] = (half)(float)u8(g);
+  std::vector<half> ref(count);
+  SBCRangeHalf(frame.data(), ref.data(), 0, count);
+
+  // 独立输出
+  std::vector<half> in(frame), out(count);
+  half* dev_in = in.data();
+  half* dev_out = out.data();
+  emuLaunch(cores, [=] { SBCKernel(dev_in, dev_out, batch); });
+  bool input_kept = same(dev_in, frame.data(), count);
+
+  // 原地
+  std::vector<half> inplace(frame);
+  half* dev = inplace.data();
+  emuLaunch(cores, [=] { SBCKernel(dev, dev, batch); });
+
+  bool ok = input_kept && same(out.data(), ref.data(), count) &&
+            same(inplace.data(), out.data(), count);
+  printf("batch %d, %2d cores: input kept %d, results %s\n", batch, cores,
+         input_kept, ok ? "ok" : "FAIL");
+  return !ok;
+}
+
+int main() {
+  int bad = 0;
+  for (int batch : {1, 4}) {
+    for (int cores : {NUM_MULTICORE, 4, 7}) {
+      bad += check(batch, cores);
+    }
+  }
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
@@ -0,0 +1,457 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// EAST 的 locality-aware NMS (lanms) 的 host 实现, 只依赖 C++11 标准库.
+// cnmlCpuComputePluginLocalityNmsOpForward 与 TF 的 LocalityAwareNms CPU kernel
+// 共用这里的 LocalityNms.
+//
+// 1. 局部合并: 候选框按 score map 的光栅顺序输入, 相邻像素预测的框高度重叠.
+//    依次与上一个 (已合并的) 框比较, IoU > iou_threshold 时按 score 加权
+//    平均四个顶点, score 相加; 否则开始一个新框.
+// 2. 标准 NMS: 合并后的框按 score 降序, 与已保留的框 IoU > iou_threshold 的被抑制.
+//
+// 与 lanms 的区别: 坐标保持 float (lanms 经 clipper 截断为整数), 多边形 IoU 用
+// Sutherland-Hodgman 裁剪计算. 凹四边形 (QUAD 回归的顶点可能出现) 沿对角线拆为
+// 两个三角形分别裁剪; 不支持自相交的四边形.
+// 加速手段:
+//   - 先用外接矩形和面积给出 IoU 上界, 上界不超过阈值时不做裁剪;
+//   - 裁剪时一次计算多边形全部顶点到裁剪边的有向距离, 支持 SSE 时 4 个一组;
+//   - 标准 NMS 中已保留的框按外接矩形登记到均匀网格, 每个候选框只与
+//     所在网格内的框比较.
+
+#ifndef __LOCALITY_NMS_IMPL_H__
+#define __LOCALITY_NMS_IMPL_H__
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define LNMS_USE_SSE 1
+#else
+#define LNMS_USE_SSE 0
+#endif
+
+// 输入格式, 与 cnmlPluginLocalityNmsInput_t 取值一致
+#define LNMS_INPUT_QUAD 0   // x0, y0, x1, y1, x2, y2, x3, y3
+#define LNMS_INPUT_RBOX 1   // x, y, d_top, d_right, d_bottom, d_left, angle
+#define LNMS_OUTPUT_COLS 9  // x0, y0, x1, y1, x2, y2, x3, y3, score
+
+// 两个凸多边形 (四边形或凹四边形拆出的三角形) 的交最多 8 个顶点,
+// 留出 SSE 一次读 4 个的余量
+#define LNMS_MAX_VERTEX 12
+// 标准 NMS 网格每一维的格子数上限
+#define LNMS_GRID_MAX 256
+
+struct LnmsQuad {
+  float x[4];
+  float y[4];
+  float score;
+  float min_x, min_y, max_x, max_y;
+  float area;
+  int reflex;  // 凹四边形的凹顶点, 凸四边形 (及退化、自相交的四边形) 为 -1
+};
+
+// 由顶点计算外接矩形、面积和凹顶点
+inline void lnmsUpdateBound(LnmsQuad* q) {
+  q->min_x = std::min(std::min(q->x[0], q->x[1]), std::min(q->x[2], q->x[3]));
+  q->max_x = std::max(std::max(q->x[0], q->x[1]), std::max(q->x[2], q->x[3]));
+  q->min_y = std::min(std::min(q->y[0], q->y[1]), std::min(q->y[2], q->y[3]));
+  q->max_y = std::max(std::max(q->y[0], q->y[1]), std::max(q->y[2], q->y[3]));
+  float twice = (q->x[0] * q->y[1] - q->x[1] * q->y[0]) +
+                (q->x[1] * q->y[2] - q->x[2] * q->y[1]) +
+                (q->x[2] * q->y[3] - q->x[3] * q->y[2]) +
+                (q->x[3] * q->y[0] - q->x[0] * q->y[3]);
+  q->area = std::fabs(twice) * 0.5f;
+  // 转向与整体方向相反的顶点为凹顶点, 恰有一个时为凹四边形; 两个时自相交
+  int reflex_num = 0;
+  q->reflex = -1;
+  for (int k = 0; k < 4; k++) {
+    const int i = (k + 3) & 3, j = (k + 1) & 3;
+    const float turn = (q->x[k] - q->x[i]) * (q->y[j] - q->y[k]) -
+                       (q->y[k] - q->y[i]) * (q->x[j] - q->x[k]);
+    if (turn * twice < 0) {
+      reflex_num++;
+      q->reflex = k;
+    }
+  }
+  if (reflex_num != 1) {
+    q->reflex = -1;
+  }
+}
+
+// EAST 的 RBOX 几何 (像素坐标 x, y 到四条边的距离及旋转角) 转为四个顶点,
+// 与 EAST restore_rectangle_rbox 的顶点顺序一致
+inline void lnmsRboxToQuad(const float* g, LnmsQuad* q) {
+  const float d0 = g[2], d1 = g[3], d2 = g[4], d3 = g[5], angle = g[6];
+  const float c = std::cos(angle), s = std::sin(angle);
+  float px[5], py[5];
+  float rx[5], ry[5];
+  if (angle >= 0) {
+    const float w = d1 + d3, h = d0 + d2;
+    px[0] = 0; py[0] = -h;
+    px[1] = w; py[1] = -h;
+    px[2] = w; py[2] = 0;
+    px[3] = 0; py[3] = 0;
+    px[4] = d3; py[4] = -d2;
+    for (int k = 0; k < 5; k++) {
+      rx[k] = c * px[k] + s * py[k];
+      ry[k] = -s * px[k] + c * py[k];
+    }
+  } else {
+    const float w = d1 + d3, h = d0 + d2;
+    px[0] = -w; py[0] = -h;
+    px[1] = 0; py[1] = -h;
+    px[2] = 0; py[2] = 0;
+    px[3] = -w; py[3] = 0;
+    px[4] = -d1; py[4] = -d2;
+    for (int k = 0; k < 5; k++) {
+      rx[k] = c * px[k] - s * py[k];
+      ry[k] = s * px[k] + c * py[k];
+    }
+  }
+  // 第 5 个点是像素自身在旋转框中的位置, 由它把框平移到像素坐标
+  const float ox = g[0] - rx[4], oy = g[1] - ry[4];
+  for (int k = 0; k < 4; k++) {
+    q->x[k] = rx[k] + ox;
+    q->y[k] = ry[k] + oy;
+  }
+}
+
+// d[i] = sign * cross(b - a, p[i] - a), i < n; 裁剪边左侧 (sign 为正时) 为内部
+inline void lnmsEdgeSide(float* d, const float* px, const float* py, int n,
+                         float ax, float ay, float ex, float ey, float sign) {
+#if LNMS_USE_SSE
+  const __m128 vax = _mm_set1_ps(ax), vay = _mm_set1_ps(ay);
+  const __m128 vex = _mm_set1_ps(ex * sign), vey = _mm_set1_ps(ey * sign);
+  for (int i = 0; i < n; i += 4) {
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(px + i), vax);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(py + i), vay);
+    _mm_storeu_ps(d + i, _mm_sub_ps(_mm_mul_ps(vex, dy), _mm_mul_ps(vey, dx)));
+  }
+#else
+  for (int i = 0; i < n; i++) {
+    d[i] = sign * (ex * (py[i] - ay) - ey * (px[i] - ax));
+  }
+#endif
+}
+
+// 凸多边形 s (sn 个顶点) 与凸多边形 c (cn 个顶点, 有向面积的符号为 sign) 的交的面积.
+// 以 s 为被裁剪多边形, 依次用 c 的各边裁剪
+inline float lnmsConvexClipArea(const float* sx, const float* sy, int sn,
+                                const float* cx, const float* cy, int cn, float sign) {
+  // 读取未写入的 SSE 通道时不能是 NaN 之类的值, 先清零
+  float bufx[2][LNMS_MAX_VERTEX] = {{0}};
+  float bufy[2][LNMS_MAX_VERTEX] = {{0}};
+  float d[LNMS_MAX_VERTEX];
+  float* px = bufx[0];
+  float* py = bufy[0];
+  for (int k = 0; k < sn; k++) {
+    px[k] = sx[k];
+    py[k] = sy[k];
+  }
+  int n = sn;
+  for (int e = 0; e < cn && n > 0; e++) {
+    const int f = e + 1 == cn ? 0 : e + 1;
+    const float ax = cx[e], ay = cy[e];
+    const float ex = cx[f] - ax, ey = cy[f] - ay;
+    lnmsEdgeSide(d, px, py, n, ax, ay, ex, ey, sign);
+    float* qx = bufx[(e + 1) & 1];
+    float* qy = bufy[(e + 1) & 1];
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+      const int j = i + 1 == n ? 0 : i + 1;
+      if (d[i] >= 0) {
+        qx[m] = px[i];
+        qy[m] = py[i];
+        m++;
+      }
+      if ((d[i] > 0 && d[j] < 0) || (d[i] < 0 && d[j] > 0)) {
+        const float t = d[i] / (d[i] - d[j]);
+        qx[m] = px[i] + t * (px[j] - px[i]);
+        qy[m] = py[i] + t * (py[j] - py[i]);
+        m++;
+      }
+    }
+    px = qx;
+    py = qy;
+    n = m;
+  }
+  if (n < 3) {
+    return 0;
+  }
+  float twice = 0;
+  for (int i = 0; i < n; i++) {
+    const int j = i + 1 == n ? 0 : i + 1;
+    twice += px[i] * py[j] - px[j] * py[i];
+  }
+  return std::fabs(twice) * 0.5f;
+}
+
+// 把四边形拆为凸的部分, 返回部分数. 凸四边形为自身; 凹四边形沿凹顶点出发的
+// 对角线拆为两个三角形, 两者方向与原四边形相同
+inline int lnmsConvexParts(const LnmsQuad& q, float px[2][4], float py[2][4], int pn[2]) {
+  if (q.reflex < 0) {
+    for (int k = 0; k < 4; k++) {
+      px[0][k] = q.x[k];
+      py[0][k] = q.y[k];
+    }
+    pn[0] = 4;
+    return 1;
+  }
+  const int r = q.reflex;
+  const int tri[2][3] = {{r, (r + 1) & 3, (r + 2) & 3}, {r, (r + 2) & 3, (r + 3) & 3}};
+  for (int p = 0; p < 2; p++) {
+    for (int k = 0; k < 3; k++) {
+      px[p][k] = q.x[tri[p][k]];
+      py[p][k] = q.y[tri[p][k]];
+    }
+    pn[p] = 3;
+  }
+  return 2;
+}
+
+// 两个四边形的交的面积. 都为凸时直接裁剪, 否则对两者的凸部分两两裁剪后求和
+inline float lnmsIntersectArea(const LnmsQuad& a, const LnmsQuad& b) {
+  float twice_b = (b.x[0] * b.y[1] - b.x[1] * b.y[0]) +
+                  (b.x[1] * b.y[2] - b.x[2] * b.y[1]) +
+                  (b.x[2] * b.y[3] - b.x[3] * b.y[2]) +
+                  (b.x[3] * b.y[0] - b.x[0] * b.y[3]);
+  if (twice_b == 0) {
+    return 0;
+  }
+  const float sign = twice_b > 0 ? 1.0f : -1.0f;
+  if (a.reflex < 0 && b.reflex < 0) {
+    return lnmsConvexClipArea(a.x, a.y, 4, b.x, b.y, 4, sign);
+  }
+  float ax[2][4], ay[2][4], bx[2][4], by[2][4];
+  int an[2], bn[2];
+  const int a_parts = lnmsConvexParts(a, ax, ay, an);
+  const int b_parts = lnmsConvexParts(b, bx, by, bn);
+  float inter = 0;
+  for (int i = 0; i < a_parts; i++) {
+    for (int j = 0; j < b_parts; j++) {
+      inter += lnmsConvexClipArea(ax[i], ay[i], an[i], bx[j], by[j], bn[j], sign);
+    }
+  }
+  return inter;
+}
+
+// IoU(a, b) > threshold. 交的面积不超过外接矩形交的面积及两者中较小的面积,
+// 由此得到的 IoU 上界不超过阈值时直接返回
+inline bool lnmsIouAbove(const LnmsQuad& a, const LnmsQuad& b, float threshold) {
+  const float iw = std::min(a.max_x, b.max_x) - std::max(a.min_x, b.min_x);
+  const float ih = std::min(a.max_y, b.max_y) - std::max(a.min_y, b.min_y);
+  if (iw <= 0 || ih <= 0) {
+    return false;
+  }
+  const float sum = a.area + b.area;
+  const float bound = std::min(iw * ih, std::min(a.area, b.area));
+  if (bound <= threshold * (sum - bound)) {
+    return false;
+  }
+  const float inter = lnmsIntersectArea(a, b);
+  const float uni = sum - inter;
+  return uni > 0 && inter > threshold * uni;
+}
+
+// merged = merged 与 q 按 score 加权平均. q 的顶点先循环移位到与 merged
+// 距离平方和最小的对应关系, 同 lanms normalize_poly
+inline void lnmsMerge(LnmsQuad* merged, const LnmsQuad& q) {
+  int best_shift = 0;
+  float best_dist = 0;
+  for (int r = 0; r < 4; r++) {
+    float dist = 0;
+    for (int k = 0; k < 4; k++) {
+      const float dx = merged->x[k] - q.x[(k + r) & 3];
+      const float dy = merged->y[k] - q.y[(k + r) & 3];
+      dist += dx * dx + dy * dy;
+    }
+    if (r == 0 || dist < best_dist) {
+      best_dist = dist;
+      best_shift = r;
+    }
+  }
+  const float wa = merged->score, wb = q.score;
+  const float score = wa + wb;
+  const float inv = 1.0f / std::max(score, 1e-8f);
+  for (int k = 0; k < 4; k++) {
+    merged->x[k] = (merged->x[k] * wa + q.x[(k + best_shift) & 3] * wb) * inv;
+    merged->y[k] = (merged->y[k] * wa + q.y[(k + best_shift) & 3] * wb) * inv;
+  }
+  merged->score = score;
+  lnmsUpdateBound(merged);
+}
+
+// 持有各阶段的临时空间, 同一个对象重复调用 run 时不再分配内存
+class LocalityNms {
+ public:
+  void reserve(int box_num) {
+    quads_.reserve(box_num);
+    order_.reserve(box_num);
+    keep_.reserve(box_num);
+    seen_.reserve(box_num);
+  }
+
+  // input: box_num 行, QUAD 每行 8 个数, RBOX 每行 7 个数, 按 score map 光栅顺序;
+  // output: 最多 max_output 行 [x0, y0, ..., x3, y3, score], score 降序.
+  // 返回输出的框数.
+  int run(const float* input, const float* scores, int box_num, int input_type,
+          float iou_threshold, int max_output, float* output) {
+    localityMerge(input, scores, box_num, input_type, iou_threshold);
+    standardNms(iou_threshold, max_output);
+    for (size_t i = 0; i < keep_.size(); i++) {
+      const LnmsQuad& q = quads_[keep_[i]];
+      float* out = output + i * LNMS_OUTPUT_COLS;
+      for (int k = 0; k < 4; k++) {
+        out[2 * k] = q.x[k];
+        out[2 * k + 1] = q.y[k];
+      }
+      out[8] = q.score;
+    }
+    return (int)keep_.size();
+  }
+
+ private:
+  void localityMerge(const float* input, const float* scores, int box_num,
+                     int input_type, float iou_threshold) {
+    const int cols = input_type == LNMS_INPUT_RBOX ? 7 : 8;
+    quads_.clear();
+    LnmsQuad q;
+    for (int i = 0; i < box_num; i++) {
+      const float* g = input + (size_t)i * cols;
+      if (input_type == LNMS_INPUT_RBOX) {
+        lnmsRboxToQuad(g, &q);
+      } else {
+        for (int k = 0; k < 4; k++) {
+          q.x[k] = g[2 * k];
+          q.y[k] = g[2 * k + 1];
+        }
+      }
+      q.score = scores[i];
+      lnmsUpdateBound(&q);
+      if (!quads_.empty() && lnmsIouAbove(q, quads_.back(), iou_threshold)) {
+        lnmsMerge(&quads_.back(), q);
+      } else {
+        quads_.push_back(q);
+      }
+    }
+  }
+
+  void standardNms(float iou_threshold, int max_output) {
+    const int num = (int)quads_.size();
+    keep_.clear();
+    if (num == 0) {
+      return;
+    }
+    order_.resize(num);
+    for (int i = 0; i < num; i++) {
+      order_[i] = i;
+    }
+    const std::vector<LnmsQuad>& quads = quads_;
+    std::stable_sort(order_.begin(), order_.end(), [&quads](int a, int b) {
+      return quads[a].score > quads[b].score;
+    });
+
+    // 格子边长取外接矩形长边的平均值, 每个框大约落在 1~4 个格子中
+    float min_x = quads_[0].min_x, min_y = quads_[0].min_y;
+    float max_x = quads_[0].max_x, max_y = quads_[0].max_y;
+    double side = 0;
+    for (int i = 0; i < num; i++) {
+      const LnmsQuad& q = quads_[i];
+      min_x = std::min(min_x, q.min_x);
+      min_y = std::min(min_y, q.min_y);
+      max_x = std::max(max_x, q.max_x);
+      max_y = std::max(max_y, q.max_y);
+      side += std::max(q.max_x - q.min_x, q.max_y - q.min_y);
+    }
+    float cell = std::max((float)(side / num),
+                          std::max(max_x - min_x, max_y - min_y) / LNMS_GRID_MAX);
+    cell = std::max(cell, 1e-6f);
+    grid_x0_ = min_x;
+    grid_y0_ = min_y;
+    grid_inv_ = 1.0f / cell;
+    grid_w_ = std::min((int)((max_x - min_x) * grid_inv_) + 1, LNMS_GRID_MAX);
+    grid_h_ = std::min((int)((max_y - min_y) * grid_inv_) + 1, LNMS_GRID_MAX);
+    if (cells_.size() < (size_t)grid_w_ * grid_h_) {
+      cells_.resize((size_t)grid_w_ * grid_h_);
+    }
+    for (int c = 0; c < grid_w_ * grid_h_; c++) {
+      cells_[c].clear();
+    }
+    // seen_[k] 记录已保留的第 k 个框最近一次与哪个候选框比较过, 避免重复比较
+    seen_.assign(num, -1);
+
+    for (int r = 0; r < num && (int)keep_.size() < max_output; r++) {
+      const int cur = order_[r];
+      const LnmsQuad& q = quads_[cur];
+      int cx0, cy0, cx1, cy1;
+      cellRange(q, &cx0, &cy0, &cx1, &cy1);
+      bool suppressed = false;
+      for (int cy = cy0; cy <= cy1 && !suppressed; cy++) {
+        for (int cx = cx0; cx <= cx1 && !suppressed; cx++) {
+          const std::vector<int>& cell_keep = cells_[cy * grid_w_ + cx];
+          for (size_t k = 0; k < cell_keep.size(); k++) {
+            const int kept = cell_keep[k];
+            if (seen_[kept] == r) {
+              continue;
+            }
+            seen_[kept] = r;
+            if (lnmsIouAbove(quads_[keep_[kept]], q, iou_threshold)) {
+              suppressed = true;
+              break;
+            }
+          }
+        }
+      }
+      if (suppressed) {
+        continue;
+      }
+      const int kept = (int)keep_.size();
+      keep_.push_back(cur);
+      for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+          cells_[cy * grid_w_ + cx].push_back(kept);
+        }
+      }
+    }
+  }
+
+  void cellRange(const LnmsQuad& q, int* cx0, int* cy0, int* cx1, int* cy1) const {
+    *cx0 = std::max(0, std::min(grid_w_ - 1, (int)((q.min_x - grid_x0_) * grid_inv_)));
+    *cy0 = std::max(0, std::min(grid_h_ - 1, (int)((q.min_y - grid_y0_) * grid_inv_)));
+    *cx1 = std::max(0, std::min(grid_w_ - 1, (int)((q.max_x - grid_x0_) * grid_inv_)));
+    *cy1 = std::max(0, std::min(grid_h_ - 1, (int)((q.max_y - grid_y0_) * grid_inv_)));
+  }
+
+  std::vector<LnmsQuad> quads_;            // 局部合并后的框
+  std::vector<int> order_;                 // quads_ 按 score 降序的下标
+  std::vector<int> keep_;                  // 保留的框在 quads_ 中的下标
+  std::vector<int> seen_;
+  std::vector<std::vector<int> > cells_;   // 每个格子中已保留的框在 keep_ 中的序号
+  float grid_x0_ = 0, grid_y0_ = 0, grid_inv_ = 1;
+  int grid_w_ = 1, grid_h_ = 1;
+};
+
+#endif  // __LOCALITY_NMS_IMPL_H__
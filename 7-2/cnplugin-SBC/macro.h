@@ -24,6 +24,7 @@
 #define USE_NRAM 0
 #define USE_SVINST 0
 #define USE_MULTICORE 0
+#define USE_INPLACE 0
 #define NUM_MULTICORE 16
 
 #define CHANNELS 3
@@ -43,3 +44,14 @@
 
 
 
+
+// cycle op 族 (cycle add/sub/mul/muladd) 公共配置, host 与 kernel 共用
+#define CYCLE_ADD 0
+#define CYCLE_SUB 1
+#define CYCLE_MUL 2
+#define CYCLE_MULADD 3
+
+// 每个 core 单次搬入 NRAM 的元素个数 (half)
+#define CYCLE_NRAM_SIZE (1024 * 128)
+// 展开后的 mask 长度上限, mask 长度为 len 与 ALIGN_SIZE 的最小公倍数
+#define CYCLE_MASK_SIZE 1024
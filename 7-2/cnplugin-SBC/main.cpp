@@ -91,7 +91,14 @@ int main() {
 
     //float2half
     CNRT_CHECK(cnrtMalloc((void**)&data_mlu, data_count * sizeof(half)));
+#if USE_INPLACE
+    // 原地模式: 输出复用输入 buffer
+    out_data = data_mlu;
+    printf("GDRAM usage: %lu bytes (in-place)\n", data_count * sizeof(half));
+#else
     CNRT_CHECK(cnrtMalloc((void**)&out_data, data_count * sizeof(half)));
+    printf("GDRAM usage: %lu bytes\n", 2 * data_count * sizeof(half));
+#endif
 
     cnrtMemcpyFloatToHalf(data_mlu, data, data_count);
 
@@ -136,7 +143,9 @@ int main() {
 
     //free
     CNRT_CHECK(cnrtFree(data_mlu));
+#if !USE_INPLACE
     CNRT_CHECK(cnrtFree(out_data));
+#endif
     CNRT_CHECK(cnrtDestroyQueue(pQueue));
     CNRT_CHECK(cnrtDestroyKernelParamsBuffer(params));
     cnrtDestroyNotifier(&Notifier_start);
@@ -0,0 +1,203 @@
+/*************************************************************************
+ * Copyright (C) [2018] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// SBC 流式测试程序: 多帧同时在途, 分布在多个 queue 上, 使一帧的 H2D、
+// 另一帧的 kernel 与再一帧的 D2H 相互重叠. 每帧在 queue 上放置 4 个
+// notifier, 用于回收 slot 以及统计各阶段耗时.
+//
+// 用法: ./pipeline [帧数=64] [在途帧数=4] [queue 数=2]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
+
+#include "pipeline_backend.h"
+
+using namespace std;
+
+enum Stage { STAGE_H2D = 0, STAGE_KERNEL, STAGE_D2H, STAGE_TOTAL, STAGE_NUM };
+
+static const char* kStageName[STAGE_NUM] = {"H2D", "kernel", "D2H", "frame"};
+
+struct Slot {
+    half* host_in;
+    half* host_out;
+    half* dev_in;
+    half* dev_out;
+    PipeQueue queue;
+    PipeNotifier notifier[4];
+    bool busy;
+    double submit_ms;
+};
+
+static double nowMs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+static float percentile(vector<float> v, float p) {
+    if (v.empty()) return 0.0;
+    sort(v.begin(), v.end());
+    size_t idx = (size_t)(p * (v.size() - 1) + 0.5);
+    return v[idx];
+}
+
+// 等待 slot 上的帧完成, 记录各阶段耗时并与参考结果比对
+static float reap(Slot& slot, const half* ref, int data_count,
+                  vector<float>* stats) {
+    pipeWaitNotifier(slot.notifier[3]);
+    double done_ms = nowMs();
+    stats[STAGE_H2D].push_back(
+        pipeNotifierDuration(slot.notifier[0], slot.notifier[1]));
+    stats[STAGE_KERNEL].push_back(
+        pipeNotifierDuration(slot.notifier[1], slot.notifier[2]));
+    stats[STAGE_D2H].push_back(
+        pipeNotifierDuration(slot.notifier[2], slot.notifier[3]));
+    stats[STAGE_TOTAL].push_back(done_ms - slot.submit_ms);
+    slot.busy = false;
+
+    float max_err = 0.0;
+    for (int i = 0; i < data_count; i++) {
+        float err = fabs(pipeHalfToFloat(slot.host_out[i]) -
+                         pipeHalfToFloat(ref[i]));
+        max_err = max(max_err, err);
+    }
+    return max_err;
+}
+
+int main(int argc, char** argv) {
+    const int frames = argc > 1 ? atoi(argv[1]) : 64;
+    const int in_flight = argc > 2 ? atoi(argv[2]) : 4;
+    const int queue_num = argc > 3 ? atoi(argv[3]) : 2;
+    if (frames <= 0 || in_flight <= 0 || queue_num <= 0) {
+        printf("usage: %s [frames] [in_flight] [queues]\n", argv[0]);
+        return -1;
+    }
+
+    const int data_count = DATA_COUNT * BATCH_SIZE;
+    const size_t bytes = data_count * sizeof(half);
+
+    // 读取一帧数据并转换为 half, 缺少 data.txt 时使用合成数据
+    vector<half> frame(data_count);
+    FILE* f_data = fopen("data.txt", "r");
+    for (int i = 0; i < data_count; i++) {
+        float v = (float)(i % 256);
+        if (f_data != NULL && fscanf(f_data, "%f\n", &v) != 1) {
+            printf("Read data.txt fail!\n");
+            return -1;
+        }
+        frame[i] = pipeFloatToHalf(v);
+    }
+    if (f_data != NULL) fclose(f_data);
+
+    // host 端参考结果
+    const float mean[CHANNELS] = {123.68f, 116.78f, 103.94f};
+    vector<half> ref(data_count);
+    for (int i = 0; i < data_count; i++) {
+        float m = pipeHalfToFloat(pipeFloatToHalf(mean[i % CHANNELS]));
+        ref[i] = pipeFloatToHalf(pipeHalfToFloat(frame[i]) - m);
+    }
+
+    pipeInit();
+    vector<PipeQueue> queues(queue_num);
+    for (int i = 0; i < queue_num; i++) queues[i] = pipeCreateQueue();
+
+    vector<Slot> slots(in_flight);
+    for (int i = 0; i < in_flight; i++) {
+        Slot& s = slots[i];
+        s.host_in = (half*)pipeMallocHost(bytes);
+        s.host_out = (half*)pipeMallocHost(bytes);
+        s.dev_in = (half*)pipeMallocDev(bytes);
+#if USE_INPLACE
+        s.dev_out = s.dev_in;
+#else
+        s.dev_out = (half*)pipeMallocDev(bytes);
+#endif
+        s.queue = queues[i % queue_num];
+        for (int k = 0; k < 4; k++) s.notifier[k] = pipeCreateNotifier();
+        s.busy = false;
+    }
+
+    vector<float> stats[STAGE_NUM];
+    float max_err = 0.0;
+
+    double start_ms = nowMs();
+    for (int f = 0; f < frames; f++) {
+        Slot& s = slots[f % in_flight];
+        if (s.busy) {
+            max_err = max(max_err, reap(s, ref.data(), data_count, stats));
+        }
+
+        // host 端准备下一帧 (此处为拷贝到锁页内存)
+        memcpy(s.host_in, frame.data(), bytes);
+
+        s.submit_ms = nowMs();
+        pipePlaceNotifier(s.notifier[0], s.queue);
+        pipeMemcpyH2D(s.dev_in, s.host_in, bytes, s.queue);
+        pipePlaceNotifier(s.notifier[1], s.queue);
+        pipeInvokeSBC(s.dev_in, s.dev_out, BATCH_SIZE, s.queue);
+        pipePlaceNotifier(s.notifier[2], s.queue);
+        pipeMemcpyD2H(s.host_out, s.dev_out, bytes, s.queue);
+        pipePlaceNotifier(s.notifier[3], s.queue);
+        s.busy = true;
+    }
+    for (int f = frames; f < frames + in_flight; f++) {
+        Slot& s = slots[f % in_flight];
+        if (s.busy) {
+            max_err = max(max_err, reap(s, ref.data(), data_count, stats));
+        }
+    }
+    double elapsed_ms = nowMs() - start_ms;
+
+    printf("frames: %d, in flight: %d, queues: %d\n",
+           frames, in_flight, queue_num);
+    printf("throughput: %.2f frames/s (%.3f ms total)\n",
+           frames * 1000.0 / elapsed_ms, elapsed_ms);
+    for (int k = 0; k < STAGE_NUM; k++) {
+        float sum = 0.0;
+        for (size_t i = 0; i < stats[k].size(); i++) sum += stats[k][i];
+        printf("%-6s latency: mean %.3f ms, p50 %.3f ms, p99 %.3f ms\n",
+               kStageName[k], sum / stats[k].size(),
+               percentile(stats[k], 0.5), percentile(stats[k], 0.99));
+    }
+    printf("max abs error: %f\n", max_err);
+
+    for (int i = 0; i < in_flight; i++) {
+        Slot& s = slots[i];
+        pipeFreeHost(s.host_in);
+        pipeFreeHost(s.host_out);
+        pipeFreeDev(s.dev_in);
+#if !USE_INPLACE
+        pipeFreeDev(s.dev_out);
+#endif
+        for (int k = 0; k < 4; k++) pipeDestroyNotifier(s.notifier[k]);
+    }
+    for (int i = 0; i < queue_num; i++) pipeDestroyQueue(queues[i]);
+    pipeDestroy();
+
+    return max_err == 0.0 ? 0 : -1;
+}
@@ -0,0 +1,330 @@
+/*************************************************************************
+ * Copyright (C) [2018] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// 流水线测试程序使用的设备抽象. 默认映射到 cnrt 的 queue / notifier /
+// 异步拷贝; 定义 PIPE_CPU_BACKEND 时改用 host 线程模拟的 queue, 无需
+// MLU 即可验证流水线的调度逻辑.
+
+#ifndef __PIPELINE_BACKEND_H
+#define __PIPELINE_BACKEND_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "macro.h"
+
+typedef unsigned short half;
+
+#if PIPE_CPU_BACKEND
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// host 模拟的 queue: 单个工作线程按 FIFO 顺序执行任务, 与 cnrtQueue 一致
+struct HostQueue {
+  std::mutex mu;
+  std::condition_variable cv;
+  std::deque<std::function<void()> > tasks;
+  bool stop = false;
+  std::thread worker;
+
+  HostQueue() { worker = std::thread([this] { Run(); }); }
+
+  ~HostQueue() {
+    {
+      std::lock_guard<std::mutex> lock(mu);
+      stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+  }
+
+  void Push(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mu);
+      tasks.push_back(std::move(task));
+    }
+    cv.notify_all();
+  }
+
+  void Run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [this] { return stop || !tasks.empty(); });
+        if (tasks.empty()) return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+};
+
+// host 模拟的 notifier: queue 执行到该位置时记录时间并置位
+struct HostNotifier {
+  std::mutex mu;
+  std::condition_variable cv;
+  bool done = true;
+  std::chrono::steady_clock::time_point stamp;
+};
+
+typedef HostQueue* PipeQueue;
+typedef HostNotifier* PipeNotifier;
+
+inline half pipeFloatToHalf(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  uint32_t sign = (x >> 16) & 0x8000;
+  int32_t exp = ((x >> 23) & 0xff) - 127 + 15;
+  uint32_t mant = x & 0x7fffff;
+  if (((x >> 23) & 0xff) == 0xff) {
+    return sign | 0x7c00 | (mant ? 0x200 : 0);
+  }
+  if (exp >= 31) return sign | 0x7c00;
+  if (exp <= 0) {
+    if (exp < -10) return sign;
+    mant |= 0x800000;
+    uint32_t shift = 14 - exp;
+    uint32_t h = mant >> shift;
+    uint32_t rem = mant & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (h & 1))) ++h;
+    return sign | h;
+  }
+  uint32_t h = (exp << 10) | (mant >> 13);
+  uint32_t rem = mant & 0x1fff;
+  if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) ++h;
+  return sign | h;
+}
+
+inline float pipeHalfToFloat(half h) {
+  uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  int32_t exp = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+  uint32_t x;
+  if (exp == 0) {
+    if (mant == 0) {
+      x = sign;
+    } else {
+      exp = 1;
+      while (!(mant & 0x400)) {
+        mant <<= 1;
+        --exp;
+      }
+      mant &= 0x3ff;
+      x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+    }
+  } else if (exp == 31) {
+    x = sign | 0x7f800000 | (mant << 13);
+  } else {
+    x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+  }
+  float f;
+  memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+inline void pipeInit() {}
+inline void pipeDestroy() {}
+
+inline PipeQueue pipeCreateQueue() { return new HostQueue(); }
+inline void pipeDestroyQueue(PipeQueue queue) { delete queue; }
+
+inline PipeNotifier pipeCreateNotifier() { return new HostNotifier(); }
+inline void pipeDestroyNotifier(PipeNotifier notifier) { delete notifier; }
+
+inline void* pipeMallocHost(size_t size) { return malloc(size); }
+inline void pipeFreeHost(void* ptr) { free(ptr); }
+inline void* pipeMallocDev(size_t size) { return malloc(size); }
+inline void pipeFreeDev(void* ptr) { free(ptr); }
+
+inline void pipeMemcpyH2D(void* dst, const void* src, size_t size,
+                          PipeQueue queue) {
+  queue->Push([=] { memcpy(dst, src, size); });
+}
+
+inline void pipeMemcpyD2H(void* dst, const void* src, size_t size,
+                          PipeQueue queue) {
+  queue->Push([=] { memcpy(dst, src, size); });
+}
+
+// 与 SBCKernel 相同的 cycle_sub 语义, 允许 input == output
+inline void pipeInvokeSBC(half* input, half* output, int batch_num,
+                          PipeQueue queue) {
+  queue->Push([=] {
+    const float mean[CHANNELS] = {123.68f, 116.78f, 103.94f};
+    float mean_half[CHANNELS];
+    for (int c = 0; c < CHANNELS; ++c) {
+      mean_half[c] = pipeHalfToFloat(pipeFloatToHalf(mean[c]));
+    }
+    const long count = (long)batch_num * DATA_COUNT;
+    for (long i = 0; i < count; ++i) {
+      output[i] = pipeFloatToHalf(pipeHalfToFloat(input[i]) -
+                                  mean_half[i % CHANNELS]);
+    }
+  });
+}
+
+inline void pipePlaceNotifier(PipeNotifier notifier, PipeQueue queue) {
+  {
+    std::lock_guard<std::mutex> lock(notifier->mu);
+    notifier->done = false;
+  }
+  queue->Push([notifier] {
+    std::lock_guard<std::mutex> lock(notifier->mu);
+    notifier->stamp = std::chrono::steady_clock::now();
+    notifier->done = true;
+    notifier->cv.notify_all();
+  });
+}
+
+inline void pipeWaitNotifier(PipeNotifier notifier) {
+  std::unique_lock<std::mutex> lock(notifier->mu);
+  notifier->cv.wait(lock, [notifier] { return notifier->done; });
+}
+
+// 两个 notifier 之间的耗时, 单位 ms
+inline float pipeNotifierDuration(PipeNotifier start, PipeNotifier end) {
+  return std::chrono::duration<float, std::milli>(end->stamp - start->stamp)
+      .count();
+}
+
+#else  // PIPE_CPU_BACKEND
+
+#include "cnrt.h"
+
+extern "C" {
+    void SBCKernel(half* input_data_, half* output_data_, int batch_num_);
+}
+
+typedef cnrtQueue_t PipeQueue;
+typedef cnrtNotifier_t PipeNotifier;
+
+inline half pipeFloatToHalf(float f) {
+  half h;
+  cnrtConvertFloatToHalf(&h, f);
+  return h;
+}
+
+inline float pipeHalfToFloat(half h) {
+  float f;
+  cnrtConvertHalfToFloat(&f, h);
+  return f;
+}
+
+inline void pipeInit() {
+  cnrtInit(0);
+  cnrtDev_t dev;
+  cnrtGetDeviceHandle(&dev, 0);
+  cnrtSetCurrentDevice(dev);
+}
+
+inline void pipeDestroy() { cnrtDestroy(); }
+
+inline PipeQueue pipeCreateQueue() {
+  cnrtQueue_t queue;
+  CNRT_CHECK(cnrtCreateQueue(&queue));
+  return queue;
+}
+
+inline void pipeDestroyQueue(PipeQueue queue) {
+  CNRT_CHECK(cnrtDestroyQueue(queue));
+}
+
+inline PipeNotifier pipeCreateNotifier() {
+  cnrtNotifier_t notifier;
+  CNRT_CHECK(cnrtCreateNotifier(&notifier));
+  return notifier;
+}
+
+inline void pipeDestroyNotifier(PipeNotifier notifier) {
+  cnrtDestroyNotifier(&notifier);
+}
+
+// 锁页内存, 异步拷贝才能与 kernel 重叠
+inline void* pipeMallocHost(size_t size) {
+  void* ptr = nullptr;
+  CNRT_CHECK(cnrtMallocHost(&ptr, size, CNRT_MEMTYPE_LOCKED));
+  return ptr;
+}
+
+inline void pipeFreeHost(void* ptr) { CNRT_CHECK(cnrtFreeHost(ptr)); }
+
+inline void* pipeMallocDev(size_t size) {
+  void* ptr = nullptr;
+  CNRT_CHECK(cnrtMalloc(&ptr, size));
+  return ptr;
+}
+
+inline void pipeFreeDev(void* ptr) { CNRT_CHECK(cnrtFree(ptr)); }
+
+inline void pipeMemcpyH2D(void* dst, const void* src, size_t size,
+                          PipeQueue queue) {
+  CNRT_CHECK(cnrtMemcpyAsync(dst, const_cast<void*>(src), size, queue,
+                             CNRT_MEM_TRANS_DIR_HOST2DEV));
+}
+
+inline void pipeMemcpyD2H(void* dst, const void* src, size_t size,
+                          PipeQueue queue) {
+  CNRT_CHECK(cnrtMemcpyAsync(dst, const_cast<void*>(src), size, queue,
+                             CNRT_MEM_TRANS_DIR_DEV2HOST));
+}
+
+inline void pipeInvokeSBC(half* input, half* output, int batch_num,
+                          PipeQueue queue) {
+  cnrtDim3_t dim = {NUM_MULTICORE, 1, 1};
+  cnrtKernelParamsBuffer_t params;
+  cnrtGetKernelParamsBuffer(&params);
+  cnrtKernelParamsBufferAddParam(params, &input, sizeof(half*));
+  cnrtKernelParamsBufferAddParam(params, &output, sizeof(half*));
+  cnrtKernelParamsBufferAddParam(params, &batch_num, sizeof(int));
+  CNRT_CHECK(cnrtInvokeKernel_V2((void*)&SBCKernel, dim, params,
+                                 CNRT_FUNC_TYPE_UNION4, queue));
+  CNRT_CHECK(cnrtDestroyKernelParamsBuffer(params));
+}
+
+inline void pipePlaceNotifier(PipeNotifier notifier, PipeQueue queue) {
+  CNRT_CHECK(cnrtPlaceNotifier(notifier, queue));
+}
+
+inline void pipeWaitNotifier(PipeNotifier notifier) {
+  CNRT_CHECK(cnrtWaitNotifier(notifier));
+}
+
+// 两个 notifier 之间的硬件耗时, 单位 ms
+inline float pipeNotifierDuration(PipeNotifier start, PipeNotifier end) {
+  float us = 0.0;
+  CNRT_CHECK(cnrtNotifierDuration(start, end, &us));
+  return us / 1000.0;
+}
+
+#endif  // PIPE_CPU_BACKEND
+
+#endif /*__PIPELINE_BACKEND_H*/
@@ -0,0 +1,193 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+#include "cnplugin.h"
+#include "macro.h"
+#include "cycle_op_kernel.h"
+
+typedef uint16_t half;
+
+static int gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+cnmlStatus_t cnmlCreatePluginCycleOpParam(
+    cnmlPluginCycleOpParam_t *param,
+    cnmlPluginCycleOpMode_t mode,
+    const float *vec,
+    int len,
+    int count
+){
+    if (param == nullptr || vec == nullptr || len <= 0 || count <= 0) {
+        return CNML_STATUS_INVALIDPARAM;
+    }
+    if (mode != CNML_CYCLE_ADD && mode != CNML_CYCLE_SUB &&
+        mode != CNML_CYCLE_MUL && mode != CNML_CYCLE_MULADD) {
+        return CNML_STATUS_INVALIDPARAM;
+    }
+    // mask 需同时是 len 与 64 的整数倍, 受 NRAM 中 mask 空间限制
+    int mask_len = len / gcd(len, ALIGN_SIZE) * ALIGN_SIZE;
+    if (mask_len > CYCLE_MASK_SIZE) {
+        return CNML_STATUS_INVALIDPARAM;
+    }
+
+    int vec_num = mode == CNML_CYCLE_MULADD ? 2 * len : len;
+    int vec_pad = (vec_num + ALIGN_SIZE - 1) / ALIGN_SIZE * ALIGN_SIZE;
+
+    *param = new cnmlPluginCycleOpParam();
+    (*param)->mode = mode;
+    (*param)->len = len;
+    (*param)->mask_len = mask_len;
+    (*param)->count = count;
+
+    (*param)->vec = (float *)malloc(sizeof(float) * vec_pad);
+    memset((*param)->vec, 0, sizeof(float) * vec_pad);
+    memcpy((*param)->vec, vec, sizeof(float) * vec_num);
+
+    //If MluTensor's datatype != CpuTensor's datatype, need to cast data.
+    (*param)->cast_vec = malloc(sizeof(int16_t) * vec_pad);
+    cnrtCastDataType((*param)->vec, CNRT_FLOAT32, (*param)->cast_vec,
+                     CNRT_FLOAT16, vec_pad, nullptr);
+
+    cnmlCreateTensor(
+        &(*param)->vec_tensor,
+        CNML_CONST, CNML_DATA_FLOAT16,
+        1, vec_pad, 1, 1);
+    cnmlBindConstData_V2((*param)->vec_tensor, (*param)->cast_vec, false);
+
+    return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlDestroyPluginCycleOpParam(
+    cnmlPluginCycleOpParam_t *param
+    ){
+    cnmlDestroyTensor(&(*param)->vec_tensor);
+    free((*param)->vec);
+    free((*param)->cast_vec);
+    delete (*param);
+    *param = nullptr;
+
+    return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlCreatePluginCycleOp(
+    cnmlBaseOp_t *op,
+    cnmlPluginCycleOpParam_t param,
+    cnmlTensor_t *cycle_input_tensors,
+    cnmlTensor_t *cycle_output_tensors
+    ){
+
+    void** InterfacePtr;
+    InterfacePtr = reinterpret_cast<void**>(&CycleOpKernel);
+
+    int mode = param->mode;
+    int len = param->len;
+    int mask_len = param->mask_len;
+    int count = param->count;
+
+    cnrtKernelParamsBuffer_t params;
+    cnrtGetKernelParamsBuffer(&params);
+
+    cnrtKernelParamsBufferMarkInput(params);
+    cnrtKernelParamsBufferMarkOutput(params);
+    cnrtKernelParamsBufferMarkStatic(params);  // vec
+    cnrtKernelParamsBufferAddParam(params, &mode, sizeof(int));
+    cnrtKernelParamsBufferAddParam(params, &len, sizeof(int));
+    cnrtKernelParamsBufferAddParam(params, &mask_len, sizeof(int));
+    cnrtKernelParamsBufferAddParam(params, &count, sizeof(int));
+
+    cnmlCreatePluginOp(
+        op,
+        "CycleOp",
+        InterfacePtr,
+        params,
+        cycle_input_tensors,
+        1,
+        cycle_output_tensors,
+        1,
+        &param->vec_tensor,
+        1
+    );
+
+    cnrtDestroyKernelParamsBuffer(params);
+    return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlComputePluginCycleOpForward(
+    cnmlBaseOp_t op,
+    void **inputs,
+    int input_num,
+    void **outputs,
+    int output_num,
+    cnrtQueue_t queue
+    ){
+
+    cnmlComputePluginOpForward_V4(
+        op,
+        nullptr,
+        inputs,
+        input_num,
+        nullptr,
+        outputs,
+        output_num,
+        queue,
+        nullptr
+    );
+
+    return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlCpuComputePluginCycleOpForward(
+    cnmlPluginCycleOpParam_t param,
+    const float *input,
+    float *output
+    ){
+    const float *vec = param->vec;
+    const int len = param->len;
+    for (int i = 0; i < param->count; i++) {
+        int c = i % len;
+        switch (param->mode) {
+        case CNML_CYCLE_ADD:
+            output[i] = input[i] + vec[c];
+            break;
+        case CNML_CYCLE_SUB:
+            output[i] = input[i] - vec[c];
+            break;
+        case CNML_CYCLE_MUL:
+            output[i] = input[i] * vec[c];
+            break;
+        case CNML_CYCLE_MULADD:
+            output[i] = input[i] * vec[c] + vec[len + c];
+            break;
+        default:
+            return CNML_STATUS_INVALIDPARAM;
+        }
+    }
+
+    return CNML_STATUS_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+#include "cnplugin.h"
+#include "locality_nms_impl.h"
+
+cnmlStatus_t cnmlCreatePluginLocalityNmsOpParam(
+    cnmlPluginLocalityNmsOpParam_t *param,
+    cnmlPluginLocalityNmsInput_t input_type,
+    int box_num,
+    int max_output_num,
+    float iou_threshold
+){
+    if (param == nullptr || box_num <= 0 ||
+        (input_type != CNML_LNMS_QUAD && input_type != CNML_LNMS_RBOX) ||
+        !(iou_threshold >= 0 && iou_threshold <= 1)) {
+        return CNML_STATUS_INVALIDPARAM;
+    }
+    *param = new cnmlPluginLocalityNmsOpParam();
+    (*param)->input_type = input_type;
+    (*param)->box_num = box_num;
+    (*param)->max_output_num =
+        max_output_num <= 0 || max_output_num > box_num ? box_num : max_output_num;
+    (*param)->iou_threshold = iou_threshold;
+
+    LocalityNms *engine = new LocalityNms();
+    engine->reserve(box_num);
+    (*param)->engine = engine;
+
+    return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlDestroyPluginLocalityNmsOpParam(
+    cnmlPluginLocalityNmsOpParam_t *param
+    ){
+    if (param == nullptr || *param == nullptr) {
+        return CNML_STATUS_INVALIDPARAM;
+    }
+    delete static_cast<LocalityNms *>((*param)->engine);
+    delete (*param);
+    *param = nullptr;
+
+    return CNML_STATUS_SUCCESS;
+}
+
+cnmlStatus_t cnmlCpuComputePluginLocalityNmsOpForward(
+    cnmlPluginLocalityNmsOpParam_t param,
+    const float *input,
+    const float *scores,
+    int box_num,
+    float *output,
+    int *output_num
+    ){
+    if (param == nullptr || output_num == nullptr || box_num < 0 ||
+        box_num > param->box_num ||
+        (box_num > 0 && (input == nullptr || scores == nullptr || output == nullptr))) {
+        return CNML_STATUS_INVALIDPARAM;
+    }
+    LocalityNms *engine = static_cast<LocalityNms *>(param->engine);
+    *output_num = engine->run(input, scores, box_num, param->input_type,
+                              param->iou_threshold, param->max_output_num, output);
+
+    return CNML_STATUS_SUCCESS;
+}
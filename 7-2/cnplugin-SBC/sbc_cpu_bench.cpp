@@ -0,0 +1,147 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// SBC CPU 实现 (sbc_cpu_impl.h) 的基准测试, 不依赖 MLU 与 TensorFlow.
+// 输入默认为 HEIGHT x WIDTH x CHANNELS (672x1280x3), float 与 half 各跑一遍:
+//   split/sub/concat: 与 TF 图中 split -> sub -> concat 相同, 每步写一个新 buffer;
+//   scalar:           逐元素 in[i] - mean[i % 3];
+//   SBCRange:         AVX2 按 24 个元素一个 block, 单线程与按 block 分到多个线程
+//                     (对应 SBCOp 中的 Shard).
+// 所有实现的输出必须逐位相同.
+//
+// 编译运行: make sbc_cpu_bench && ./sbc_cpu_bench [threads] [height width]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "macro.h"
+#include "sbc_cpu_impl.h"
+
+typedef _Float16 half;
+
+inline void SBCRange(const half* in, half* out, int64_t begin, int64_t end) {
+  SBCRangeHalf(in, out, begin, end);
+}
+
+template <typename T>
+inline T SubMean(T x, int c) {
+  return T(static_cast<float>(x) - static_cast<float>(T(kSBCMeans[c])));
+}
+
+// tf.split(axis=-1) -> tf.subtract -> tf.concat(axis=-1)
+template <typename T>
+void SplitSubConcat(const T* in, T* out, int64_t pixels) {
+  std::vector<std::vector<T> > planes(kSBCChannels, std::vector<T>(pixels));
+  for (int c = 0; c < kSBCChannels; ++c) {
+    for (int64_t p = 0; p < pixels; ++p) planes[c][p] = in[p * kSBCChannels + c];
+  }
+  std::vector<std::vector<T> > diffs(kSBCChannels, std::vector<T>(pixels));
+  for (int c = 0; c < kSBCChannels; ++c) {
+    for (int64_t p = 0; p < pixels; ++p) diffs[c][p] = SubMean(planes[c][p], c);
+  }
+  for (int c = 0; c < kSBCChannels; ++c) {
+    for (int64_t p = 0; p < pixels; ++p) out[p * kSBCChannels + c] = diffs[c][p];
+  }
+}
+
+template <typename T>
+void Scalar(const T* in, T* out, int64_t total) {
+  for (int64_t i = 0; i < total; ++i) out[i] = SubMean(in[i], i % kSBCChannels);
+}
+
+template <typename T>
+void Sharded(const T* in, T* out, int64_t total, int threads) {
+  const int64_t blocks = (total + kSBCBlock - 1) / kSBCBlock;
+  const int64_t per = (blocks + threads - 1) / threads;
+  std::vector<std::thread> workers;
+  for (int64_t start = 0; start < blocks; start += per) {
+    int64_t limit = std::min(start + per, blocks);
+    workers.emplace_back([=] {
+      SBCRange(in, out, start * kSBCBlock, std::min(limit * kSBCBlock, total));
+    });
+  }
+  for (std::thread& t : workers) t.join();
+}
+
+template <typename F>
+double BestMs(F f) {
+  double best = 1e30;
+  for (int r = 0; r < 10; ++r) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+  }
+  return best;
+}
+
+template <typename T>
+int Run(const char* name, int threads, int height, int width) {
+  const int64_t pixels = (int64_t)height * width;
+  const int64_t total = pixels * kSBCChannels;
+  std::mt19937 g(1);
+  std::uniform_int_distribution<int> u8(0, 255);
+  std::vector<T> in(total);
+  for (int64_t i = 0; i < total; ++i) in[i] = T(static_cast<float>(u8(g)));
+  std::vector<T> ref(total), out(total);
+
+  double split_ms = BestMs([&] { SplitSubConcat(in.data(), ref.data(), pixels); });
+  double scalar_ms = BestMs([&] { Scalar(in.data(), out.data(), total); });
+  int bad = out != ref;
+  double simd_ms = BestMs([&] { SBCRange(in.data(), out.data(), 0, total); });
+  bad += out != ref;
+  double shard_ms = BestMs([&] { Sharded(in.data(), out.data(), total, threads); });
+  bad += out != ref;
+  // 原地: SBCOp 转发输入时 in == out
+  std::vector<T> inplace = in;
+  SBCRange(inplace.data(), inplace.data(), 0, total);
+  bad += inplace != ref;
+
+  printf("%-5s %dx%dx%d: split/sub/concat %7.3f ms, scalar %7.3f ms, "
+         "SBCRange %7.3f ms (x%.1f), %d threads %7.3f ms %s\n",
+         name, height, width, kSBCChannels, split_ms, scalar_ms, simd_ms,
+         split_ms / simd_ms, threads, shard_ms, bad ? "MISMATCH" : "ok");
+  return bad;
+}
+
+int main(int argc, char** argv) {
+  int threads = argc > 1 ? atoi(argv[1]) : std::thread::hardware_concurrency();
+  threads = std::max(threads, 1);
+  int height = argc > 3 ? atoi(argv[2]) : HEIGHT;
+  int width = argc > 3 ? atoi(argv[3]) : WIDTH;
+#if defined(__AVX2__) && defined(__F16C__)
+  printf("AVX2 + F16C\n");
+#else
+  printf("no AVX2/F16C, SBCRange uses the scalar loop\n");
+#endif
+  int bad = Run<float>("float", threads, height, width) +
+            Run<half>("half", threads, height, width);
+  printf("%s\n", bad ? "FAIL" : "PASS");
+  return bad != 0;
+}
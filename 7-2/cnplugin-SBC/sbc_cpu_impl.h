@@ -0,0 +1,102 @@
+/*************************************************************************
+ * Copyright (C) [2019] by Cambricon, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *************************************************************************/
+
+// SBC (按通道减均值) 的 host 实现, 只依赖 C++11 标准库.
+// TF 的 SBC CPU kernel 与 sbc_cpu_bench.cpp 共用这里的 SBCRange.
+//
+// 输入最后一维为 3 个通道, 展平后第 i 个元素减去 kSBCMeans[i % 3]. 以 24 个元素
+// (3 通道周期与 8 路 AVX 的最小公倍数) 为一个 block, 每个 block 内通道相位从 0
+// 开始, 三个 mask 向量固定不变. 对每个元素先读后写, 允许 in == out.
+
+#ifndef __SBC_CPU_IMPL_H__
+#define __SBC_CPU_IMPL_H__
+
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// 与 SBCKernel 中 tmp0 的 cycle_sub mask 保持一致 (B, G, R 均值)
+constexpr int kSBCChannels = 3;
+constexpr float kSBCMeans[kSBCChannels] = {123.68f, 116.78f, 103.94f};
+
+// 3 通道周期与 8 路 SIMD 的最小公倍数, 每个 block 内通道相位从 0 开始
+constexpr int64_t kSBCBlock = 24;
+
+// 按 block 处理 [begin, end) 区间, begin 为 kSBCBlock 的整数倍
+inline void SBCRange(const float* in, float* out, int64_t begin, int64_t end) {
+  int64_t i = begin;
+#if defined(__AVX2__)
+  alignas(32) float mask[kSBCBlock];
+  for (int k = 0; k < kSBCBlock; ++k) mask[k] = kSBCMeans[k % kSBCChannels];
+  const __m256 m0 = _mm256_load_ps(mask);
+  const __m256 m1 = _mm256_load_ps(mask + 8);
+  const __m256 m2 = _mm256_load_ps(mask + 16);
+  for (; i + kSBCBlock <= end; i += kSBCBlock) {
+    _mm256_storeu_ps(out + i,
+        _mm256_sub_ps(_mm256_loadu_ps(in + i), m0));
+    _mm256_storeu_ps(out + i + 8,
+        _mm256_sub_ps(_mm256_loadu_ps(in + i + 8), m1));
+    _mm256_storeu_ps(out + i + 16,
+        _mm256_sub_ps(_mm256_loadu_ps(in + i + 16), m2));
+  }
+#endif
+  for (; i < end; ++i) {
+    out[i] = in[i] - kSBCMeans[i % kSBCChannels];
+  }
+}
+
+// half 先以 float 相减再舍入回 half, 与 MLU 上 __bang_cycle_sub 的结果一致.
+// Half 为 IEEE binary16 (Eigen::half, _Float16 等), 可与 float 互相转换.
+template <typename Half>
+inline void SBCRangeHalf(const Half* in, Half* out, int64_t begin,
+                         int64_t end) {
+  static_assert(sizeof(Half) == 2, "Half must be IEEE binary16");
+  float means[kSBCChannels];
+  for (int k = 0; k < kSBCChannels; ++k) {
+    means[k] = static_cast<float>(Half(kSBCMeans[k]));
+  }
+  int64_t i = begin;
+#if defined(__AVX2__) && defined(__F16C__)
+  alignas(32) float mask[kSBCBlock];
+  for (int k = 0; k < kSBCBlock; ++k) mask[k] = means[k % kSBCChannels];
+  const __m256 m[3] = {_mm256_load_ps(mask), _mm256_load_ps(mask + 8),
+                       _mm256_load_ps(mask + 16)};
+  for (; i + kSBCBlock <= end; i += kSBCBlock) {
+    for (int k = 0; k < 3; ++k) {
+      const __m128i* src = reinterpret_cast<const __m128i*>(in + i + k * 8);
+      __m128i* dst = reinterpret_cast<__m128i*>(out + i + k * 8);
+      __m256 v = _mm256_cvtph_ps(_mm_loadu_si128(src));
+      v = _mm256_sub_ps(v, m[k]);
+      _mm_storeu_si128(dst,
+          _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+  }
+#endif
+  for (; i < end; ++i) {
+    out[i] = Half(static_cast<float>(in[i]) - means[i % kSBCChannels]);
+  }
+}
+
+#endif  // __SBC_CPU_IMPL_H__
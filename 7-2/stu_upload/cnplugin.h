@@ -5676,6 +5676,8 @@ cnmlStatus_t cnmlCreatePluginSBCOp(
     int batch_num_);
 
 
+/* outputs[0] may be the same address as inputs[0]; SBC then runs in place
+   and the caller only needs one GDRAM buffer per frame. */
 cnmlStatus_t cnmlComputePluginSBCOpForward(
     cnmlBaseOp_t op,
     void **inputs,
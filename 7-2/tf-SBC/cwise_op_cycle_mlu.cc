@@ -0,0 +1,91 @@
+
+#include "tensorflow/core/kernels/cwise_op_cycle_mlu.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+#if CAMBRICON_MLU
+#define REGISTER_MLU(T)                                           \
+  REGISTER_KERNEL_BUILDER(Name("CycleOp")                         \
+                          .Device(DEVICE_MLU)                     \
+                          .TypeConstraint<T>("T"),                \
+                          MLUCycleOp<T>);
+  TF_CALL_MLU_FLOAT_TYPES(REGISTER_MLU);
+#undef REGISTER_MLU
+#endif
+
+// CPU 实现, 与 cnmlCpuComputePluginCycleOpForward 语义一致
+template <typename T>
+class CycleOp : public OpKernel {
+ public:
+  explicit CycleOp(OpKernelConstruction* context) : OpKernel(context) {
+    std::string mode;
+    OP_REQUIRES_OK(context, context->GetAttr("mode", &mode));
+    OP_REQUIRES_OK(context, context->GetAttr("vec", &vec_));
+    muladd_ = mode == "muladd";
+    sign_ = mode == "sub" ? -1.0f : 1.0f;
+    mul_ = mode == "mul" || muladd_;
+    len_ = muladd_ ? vec_.size() / 2 : vec_.size();
+    OP_REQUIRES(context, len_ > 0 && (!muladd_ || vec_.size() % 2 == 0),
+                errors::InvalidArgument("CycleOp: invalid vec size ",
+                                        vec_.size(), " for mode ", mode));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+
+    const T* in = input.flat<T>().data();
+    T* out = output->flat<T>().data();
+    const float* vec = vec_.data();
+    const int64 len = len_;
+    const bool mul = mul_;
+    const bool muladd = muladd_;
+    const float sign = sign_;
+
+    auto work = [=](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        const int64 c = i % len;
+        const float x = static_cast<float>(in[i]);
+        float y;
+        if (muladd) {
+          y = x * vec[c] + vec[len + c];
+        } else if (mul) {
+          y = x * vec[c];
+        } else {
+          y = x + sign * vec[c];
+        }
+        out[i] = static_cast<T>(y);
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          input.NumElements(), /*cost_per_unit=*/4, work);
+  }
+
+ private:
+  std::vector<float> vec_;
+  int64 len_;
+  bool mul_;
+  bool muladd_;
+  float sign_;
+};
+
+#define REGISTER_CPU(T)                                           \
+  REGISTER_KERNEL_BUILDER(Name("CycleOp")                         \
+                          .Device(DEVICE_CPU)                     \
+                          .TypeConstraint<T>("T"),                \
+                          CycleOp<T>);
+REGISTER_CPU(float);
+REGISTER_CPU(Eigen::half);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
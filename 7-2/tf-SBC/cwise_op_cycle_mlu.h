@@ -0,0 +1,60 @@
+#ifndef TENSORFLOW_CORE_KERNELS_CWISE_OP_CYCLE_MLU_H_
+#define TENSORFLOW_CORE_KERNELS_CWISE_OP_CYCLE_MLU_H_
+#if CAMBRICON_MLU
+#include <string>
+#include <vector>
+#include "tensorflow/core/kernels/cwise_ops_common.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/mlu_op_kernel.h"
+#include "tensorflow/stream_executor/mlu/mlu_stream.h"
+
+namespace tensorflow {
+
+// 与 cnmlPluginCycleOpMode_t 取值一致
+inline int CycleModeFromString(const string& mode) {
+  if (mode == "add") return 0;
+  if (mode == "sub") return 1;
+  if (mode == "mul") return 2;
+  return 3;  // muladd
+}
+
+template <typename T>
+class MLUCycleOp : public MLUOpKernel {
+ public:
+  explicit MLUCycleOp(OpKernelConstruction* ctx) :
+          MLUOpKernel(ctx) {
+    string mode;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("mode", &mode));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("vec", &vec_));
+    mode_ = CycleModeFromString(mode);
+    OP_REQUIRES(ctx, !vec_.empty() && (mode != "muladd" || vec_.size() % 2 == 0),
+                errors::InvalidArgument("CycleOp: invalid vec size ",
+                                        vec_.size(), " for mode ", mode));
+  }
+
+  void ComputeOnMLU(OpKernelContext* ctx) override {
+    se::mlu::MLUStream* stream = static_cast<se::mlu::MLUStream*>(
+        ctx->op_device_context()->stream()->implementation());
+
+    TensorShape shape = TensorShape(ctx->input(0).shape());
+
+    // 逐元素运算, 与 SBC 相同地优先复用输入 buffer
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, shape, &output));
+    Tensor input = ctx->input(0);
+
+    OP_REQUIRES_OK(ctx, stream->CycleOp(ctx, &input, output, mode_, vec_));
+  }
+
+ private:
+  int mode_;
+  std::vector<float> vec_;
+};
+
+}  // namespace tensorflow
+
+
+#endif  // CAMBRICON_MLU
+#endif  // TENSORFLOW_CORE_KERNELS_CWISE_OP_CYCLE_MLU_H_
@@ -1,6 +1,13 @@
 
 #include "tensorflow/core/kernels/cwise_op_sbc_mlu.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/sbc_cpu_impl.h"
+#include "tensorflow/core/util/work_sharder.h"
+
 //TODO:补全算子注册
 namespace tensorflow {
 #if CAMBRICON_MLU
@@ -12,9 +19,61 @@ namespace tensorflow {
   TF_CALL_MLU_FLOAT_TYPES(REGISTER_MLU);
 #undef REGISTER_MLU
 #endif
-  // #if CAMBRICON_MLUSBC
 
-  // namespace tensorflow
+namespace {
 
-//REGISTER_KERNEL_BUILDER(Name("SBC").Device(DEVICE_CPU), SBCOp<float>);
+// SBCRange 见 sbc_cpu_impl.h, 这里补上 Eigen::half 的重载
+using ::SBCRange;
+
+inline void SBCRange(const Eigen::half* in, Eigen::half* out, int64 begin,
+                     int64 end) {
+  SBCRangeHalf(in, out, begin, end);
 }
+
+}  // namespace
+
+template <typename T>
+class SBCOp : public OpKernel {
+ public:
+  explicit SBCOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    OP_REQUIRES(context, input.dims() >= 1 &&
+                input.dim_size(input.dims() - 1) == kSBCChannels,
+                errors::InvalidArgument("SBC expects the last dim to be ",
+                                        kSBCChannels, ", got ",
+                                        input.shape().DebugString()));
+
+    // 输入可转发时原地计算, SBCRange 对每个元素先读后写, 允许 in == out
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+
+    const T* in = input.flat<T>().data();
+    T* out = output->flat<T>().data();
+    const int64 total = input.NumElements();
+    const int64 blocks = (total + kSBCBlock - 1) / kSBCBlock;
+
+    // 以 block 为单位拆分到 Eigen 线程池, 保证每段起点的通道相位为 0
+    auto work = [in, out, total](int64 start, int64 limit) {
+      SBCRange(in, out, start * kSBCBlock,
+               std::min(limit * kSBCBlock, total));
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, blocks,
+          /*cost_per_unit=*/kSBCBlock * 2, work);
+  }
+};
+
+#define REGISTER_CPU(T)                                           \
+  REGISTER_KERNEL_BUILDER(Name("SBC")                             \
+                          .Device(DEVICE_CPU)                     \
+                          .TypeConstraint<T>("T"),                \
+                          SBCOp<T>);
+REGISTER_CPU(float);
+REGISTER_CPU(Eigen::half);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
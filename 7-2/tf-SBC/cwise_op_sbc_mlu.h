@@ -23,7 +23,6 @@ class MLUSBCOp : public MLUOpKernel {
     //auto* mlustream_exec = ctx->op_device_context()->mlu_stream()->parent();
     se::mlu::MLUStream* stream = static_cast<se::mlu::MLUStream*>(
         ctx->op_device_context()->stream()->implementation());
-    Tensor input = ctx->input(0);
 
     // TODO: 参数检查与处理
     const Tensor& a = ctx->input(0);
@@ -32,11 +31,15 @@ class MLUSBCOp : public MLUOpKernel {
     // string op_parameter = ctx->op_kernel().type_string() + "/" + input.shape().DebugString();
     // MLU_OP_CHECK_UNSUPPORTED(mlustream_exec, op_parameter, ctx);
 
-    TensorShape shape = TensorShape(input.shape());
+    TensorShape shape = TensorShape(a.shape());
 
     //TODO:输出形状推断及输出内存分配
+    // SBC 为逐元素运算, 输入 buffer 可被转发时直接原地写回, 省去一份 GDRAM
     Tensor* output;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, shape, &output));
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, shape, &output));
+    // 转发要求输入 buffer 引用计数为 1, 因此在转发之后再持有 input 的拷贝
+    Tensor input = ctx->input(0);
 
     // 调用MLUStream层接口完成算子计算
     OP_REQUIRES_OK(ctx, stream->SBC(ctx, &input, output, batch_size));
@@ -0,0 +1,77 @@
+/*Copyright 2018 Cambricon*/
+#if CAMBRICON_MLU
+
+#include "tensorflow/stream_executor/mlu/mlu_api/lib_ops/mlu_lib_ops.h"
+#include "tensorflow/stream_executor/mlu/mlu_api/ops/mlu_ops.h"
+#include "tensorflow/stream_executor/mlu/mlu_api/tf_mlu_intf.h"
+
+namespace stream_executor {
+namespace mlu {
+namespace ops {
+
+
+Status MLUCycle::CreateMLUOp(std::vector<MLUTensor *> &inputs,
+                             std::vector<MLUTensor *> &outputs, void *param) {
+  TF_PARAMS_CHECK(inputs.size() > 0, "Missing input");
+  TF_PARAMS_CHECK(outputs.size() > 0, "Missing output");
+
+  MLUBaseOp *op_ptr = nullptr;
+  MLUTensor *input = inputs.at(0);
+  MLUTensor *output = outputs.at(0);
+
+  MLUCycleOpParam *op_param = static_cast<MLUCycleOpParam *>(param);
+  cnmlPluginCycleOpMode_t mode =
+      static_cast<cnmlPluginCycleOpMode_t>(op_param->mode_);
+  int vec_num = op_param->vec_.size();
+  int len = mode == CNML_CYCLE_MULADD ? vec_num / 2 : vec_num;
+
+  lib::MLUTensorUtil output_util(output);
+  int count = 1;
+  for (int i = 0; i < output_util.dims(); ++i) {
+    count *= output_util.dim_size(i);
+  }
+
+  MLULOG(3) << "CreateCycleOp, mode: " << op_param->mode_
+            << ", len: " << len
+            << ", input: " << lib::MLUTensorUtil(input).DebugString()
+            << ", output: " << lib::MLUTensorUtil(output).DebugString();
+
+  // param 中的 vec_tensor 以 cnmlBindConstData_V2(..., false) 绑定, 数据归 param
+  // 所有, op 编译时才读取, 因此 param 保留到析构, 见 ~MLUCycle
+  TF_PARAMS_CHECK(cnmlCreatePluginCycleOpParam(&mlu_param_, mode,
+      op_param->vec_.data(), len, count) == CNML_STATUS_SUCCESS,
+      "Unsupported CycleOp mode or vec length");
+
+  TF_STATUS_CHECK(lib::CreateCycleOp(&op_ptr, input, output, mlu_param_));
+
+  base_ops_.push_back(op_ptr);
+
+  return Status::OK();
+}
+
+MLUCycle::~MLUCycle() {
+  // 先销毁引用 const tensor 的 op, 再释放 param
+  for (MLUBaseOp *&op : base_ops_) {
+    cnmlDestroyBaseOp(&op);
+  }
+  base_ops_.clear();
+  if (mlu_param_ != nullptr) {
+    cnmlDestroyPluginCycleOpParam(&mlu_param_);
+  }
+}
+
+Status MLUCycle::Compute(const std::vector<void *> &inputs,
+                         const std::vector<void *> &outputs, cnrtQueue_t queue) {
+  void *input = inputs.at(0);
+  void *output = outputs.at(0);
+
+  TF_STATUS_CHECK(lib::ComputeCycleOp(base_ops_.at(0), input, output, queue));
+
+  return Status::OK();
+}
+
+}  // namespace ops
+}  // namespace mlu
+}  // namespace stream_executor
+
+#endif  // CAMBRICON_MLU
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <string>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/locality_nms_impl.h"
+
+namespace tensorflow {
+
+// CPU 实现, 与 cnmlCpuComputePluginLocalityNmsOpForward 语义一致.
+// 输出框数在计算后才知道, 先写入临时 tensor 再拷贝到输出. 临时空间与 LocalityNms
+// 都在每次调用时创建, 并发的 step 互不等待.
+class LocalityAwareNmsOp : public OpKernel {
+ public:
+  explicit LocalityAwareNmsOp(OpKernelConstruction* context) : OpKernel(context) {
+    std::string input_type;
+    OP_REQUIRES_OK(context, context->GetAttr("input_type", &input_type));
+    OP_REQUIRES_OK(context, context->GetAttr("iou_threshold", &iou_threshold_));
+    OP_REQUIRES_OK(context, context->GetAttr("max_output_size", &max_output_size_));
+    OP_REQUIRES(context, iou_threshold_ >= 0 && iou_threshold_ <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1], got ",
+                                        iou_threshold_));
+    input_type_ = input_type == "rbox" ? LNMS_INPUT_RBOX : LNMS_INPUT_QUAD;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& geometry = context->input(0);
+    const Tensor& scores = context->input(1);
+    const int cols = input_type_ == LNMS_INPUT_RBOX ? 7 : 8;
+    OP_REQUIRES(context, geometry.dims() == 2 && geometry.dim_size(1) == cols,
+                errors::InvalidArgument("geometry must be [num_boxes, ", cols,
+                                        "], got ", geometry.shape().DebugString()));
+    OP_REQUIRES(context, scores.dims() == 1 &&
+                             scores.dim_size(0) == geometry.dim_size(0),
+                errors::InvalidArgument("scores must be [num_boxes], got ",
+                                        scores.shape().DebugString()));
+    const int num_boxes = geometry.dim_size(0);
+    const int max_output = max_output_size_ > 0
+                               ? std::min(max_output_size_, num_boxes)
+                               : num_boxes;
+
+    Tensor buffer;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DT_FLOAT, TensorShape({max_output, LNMS_OUTPUT_COLS}),
+                                &buffer));
+    float* buffer_data = buffer.flat<float>().data();
+    LocalityNms engine;
+    engine.reserve(num_boxes);
+    const int num_kept = engine.run(geometry.flat<float>().data(),
+                                    scores.flat<float>().data(), num_boxes,
+                                    input_type_, iou_threshold_, max_output,
+                                    buffer_data);
+
+    Tensor* detections = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({num_kept, LNMS_OUTPUT_COLS}),
+                                &detections));
+    std::copy(buffer_data, buffer_data + num_kept * LNMS_OUTPUT_COLS,
+              detections->flat<float>().data());
+  }
+
+ private:
+  int input_type_;
+  float iou_threshold_;
+  int max_output_size_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("LocalityAwareNms").Device(DEVICE_CPU),
+                        LocalityAwareNmsOp);
+
+}  // namespace tensorflow
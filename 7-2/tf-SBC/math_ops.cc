@@ -2266,12 +2266,46 @@ REGISTER_OP("PowerDifference")
       return Status::OK();
     });
 */
-#if CAMBRICON_MLU
 //TODO:完成注册
+// SBC 同时注册了 CPU 与 MLU kernel, 因此 op 定义不再受 CAMBRICON_MLU 限制
 REGISTER_OP("SBC")
     .Input("input: T")
     .Output("output: T")
-    .Attr("T: type")
+    .Attr("T: {half, float}")
     .SetShapeFn(shape_inference::UnchangedShape);
-#endif  // CAMBRICON_MLU
+
+// out = input (mode) vec, vec 沿数据循环; muladd 时 vec 为 scale 后接 bias
+REGISTER_OP("CycleOp")
+    .Input("input: T")
+    .Output("output: T")
+    .Attr("T: {half, float}")
+    .Attr("mode: {'add', 'sub', 'mul', 'muladd'}")
+    .Attr("vec: list(float)")
+    .SetShapeFn(shape_inference::UnchangedShape);
+
+// EAST 的 locality-aware NMS, 只有 CPU kernel, 语义同 cnmlCpuComputePluginLocalityNmsOpForward.
+// geometry 按 score map 光栅顺序排列, quad 每行 8 个坐标, rbox 每行
+// [x, y, d_top, d_right, d_bottom, d_left, angle]; 输出每行 [x0, y0, ..., x3, y3, score]
+REGISTER_OP("LocalityAwareNms")
+    .Input("geometry: float")
+    .Input("scores: float")
+    .Output("detections: float")
+    .Attr("input_type: {'quad', 'rbox'} = 'quad'")
+    .Attr("iou_threshold: float = 0.2")
+    .Attr("max_output_size: int = 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle geometry;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &geometry));
+      ShapeHandle scores;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &scores));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(geometry, 0), c->Dim(scores, 0), &unused));
+      string input_type;
+      TF_RETURN_IF_ERROR(c->GetAttr("input_type", &input_type));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(geometry, 1),
+                                      input_type == "rbox" ? 7 : 8, &unused));
+      c->set_output(0, c->Matrix(c->UnknownDim(), 9));
+      return Status::OK();
+    });
 }  // namespace tensorflow
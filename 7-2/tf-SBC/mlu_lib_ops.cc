@@ -1961,6 +1961,25 @@ tensorflow::Status ComputeSBCOp(
 }
 //SBC
 
+tensorflow::Status CreateCycleOp(MLUBaseOp** op, MLUTensor* input,
+                                 MLUTensor* output,
+                                 cnmlPluginCycleOpParam_t param) {
+  MLUTensor* inputs_ptr[1] = {input};
+  MLUTensor* outputs_ptr[1] = {output};
+  CNML_RETURN_STATUS(cnmlCreatePluginCycleOp(op, param, inputs_ptr, outputs_ptr));
+}
+
+tensorflow::Status ComputeCycleOp(
+                    MLUBaseOp* op,
+                    void* input,
+                    void* output,
+                    MLUCnrtQueue* queue) {
+  void* inputs_ptr[1] = {input};
+  void* outputs_ptr[1] = {output};
+  CNML_RETURN_STATUS(cnmlComputePluginCycleOpForward(
+                                         op, inputs_ptr, 1, outputs_ptr, 1, queue));
+}
+
 }  // namespace lib
 }  // namespace mlu
 }  // namespace stream_executor
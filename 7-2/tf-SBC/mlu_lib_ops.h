@@ -944,6 +944,16 @@ tensorflow::Status ComputeSBCOp(
                     MLUCnrtQueue* queue);
 //SBC
 /******************************************************/
+tensorflow::Status CreateCycleOp(MLUBaseOp** op, MLUTensor* input,
+                                 MLUTensor* output,
+                                 cnmlPluginCycleOpParam_t param);
+
+tensorflow::Status ComputeCycleOp(
+                    MLUBaseOp* op,
+                    void* input,
+                    void* output,
+                    MLUCnrtQueue* queue);
+/******************************************************/
 
 }  // namespace lib
 }  // namespace mlu
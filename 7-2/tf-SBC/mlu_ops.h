@@ -526,6 +526,13 @@ struct MLULeakyReluOpParam {
   explicit MLULeakyReluOpParam(float alpha) : alpha(alpha) {}
 };
 
+struct MLUCycleOpParam {
+  int mode_;
+  const std::vector<float>& vec_;
+  MLUCycleOpParam(int mode, const std::vector<float>& vec)
+    : mode_(mode), vec_(vec) {}
+};
+
 
 #define MLU_OP_CTOR_STATUS_CHECK(...)    \
   do {                                   \
@@ -655,6 +662,28 @@ DECLARE_OP_CLASS(MLULeakyRelu);
 //DECLARE_OP_CLASS(MLUPowerDifference);
 //TODO:添加SBC
 DECLARE_OP_CLASS(MLUSBC);
+
+// CycleOp 的 param 持有 op 引用的 const tensor 及其绑定的数据, op 编译时仍会读取,
+// 因此由 MLUCycle 保存, 在 op 销毁之后再释放.
+class MLUCycle : public MLUBaseOpWrapper {
+ public:
+  MLUCycle(std::vector<MLUTensor *> &inputs, std::vector<MLUTensor *> &outputs,
+           void *param) : MLUBaseOpWrapper(inputs, outputs) {
+    MLU_OP_CTOR_STATUS_CHECK(CreateMLUOp(inputs, outputs, param));
+    success_ = true;
+  }
+  MLUCycle(std::vector<Tensor *> &inputs, std::vector<Tensor *> &outputs,
+           void *param, std::vector<MLUTensorType> mlu_tensors_type = {});
+  ~MLUCycle();
+  tensorflow::Status Compute(const std::vector<void *> &inputs,
+                 const std::vector<void *> &outputs,
+                 cnrtQueue_t queue) override;
+
+ private:
+  tensorflow::Status CreateMLUOp(std::vector<MLUTensor *> &inputs,
+                     std::vector<MLUTensor *> &outputs, void *param);
+  cnmlPluginCycleOpParam_t mlu_param_ = nullptr;
+};
 }  // namespace ops
 }  // namespace mlu
 }  // namespace stream_executor
@@ -1089,6 +1089,13 @@ class MLUStream : public internal::StreamInterface {
     return CommonOpImpl<ops::MLUSBC>(ctx, {input}, {output}, static_cast<void*>(&batch_size));
   }
 
+  Status CycleOp(OpKernelContext* ctx, Tensor* input, Tensor* output,
+                 int mode, const std::vector<float>& vec) {
+    ops::MLUCycleOpParam op_param(mode, vec);
+    return CommonOpImpl<ops::MLUCycle>(ctx, {input}, {output},
+        static_cast<void*>(&op_param));
+  }
+
  private:
   const unsigned long dev_;
   const int device_ordinal_;
@@ -39,10 +39,9 @@ Status MLUSBC::Compute(const std::vector<void *> &inputs,
   void *input = inputs.at(0);
   void *output = outputs.at(0);
 
+  // 只下发到 queue, 完成由 stream 上的后续同步/拷贝保证, 不再阻塞 host
   TF_STATUS_CHECK(lib::ComputeSBCOp(base_ops_.at(0), input, output, queue));
 
-  TF_CNRT_CHECK(cnrtSyncQueue(queue));
-
   return Status::OK();
 }
 